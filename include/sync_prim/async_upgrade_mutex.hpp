@@ -0,0 +1,479 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "sync_prim/upgrade_mutex.hpp"
+
+// C++20 coroutine awaitables are provided when the compiler supports them; the
+// continuation-passing API below works in C++17.
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define SYNC_PRIM_HAS_COROUTINES 1
+#endif
+#endif
+#ifndef SYNC_PRIM_HAS_COROUTINES
+#define SYNC_PRIM_HAS_COROUTINES 0
+#endif
+
+namespace sync_prim
+{
+
+  namespace detail
+  {
+    // What a queued async waiter wants. `convert` is an upgrade owner waiting
+    // to become exclusive.
+    enum class async_mode
+    {
+      exclusive,
+      shared,
+      upgrade,
+      convert
+    };
+  } // namespace detail
+
+  /**
+   * @class async_upgrade_mutex
+   * @brief Wraps any sync_prim mutex with asynchronous acquisition: a caller
+   * that cannot get the lock leaves a continuation behind instead of blocking.
+   *
+   *   mtx.async_lock_shared([&](sync_prim::shared_lock<async_upgrade_mutex<>> lock) { ... });
+   *
+   * With C++20 coroutines the same operations are awaitable:
+   *
+   *   auto lock = co_await mtx.async_lock_shared();
+   *
+   * If nobody is queued and the lock is free, the continuation runs (or the
+   * coroutine continues) synchronously, without queuing or suspending. Otherwise it is queued and
+   * resumed by whichever release makes it grantable: inline on the releasing
+   * thread, or through the executor given at construction. Queued waiters are
+   * served in arrival order; a waiting conversion goes first and holds back
+   * queued readers. The synchronous API and guards of the wrapped mutex work
+   * unchanged, and their callers are not queued, so they may overtake.
+   *
+   * Continuations must not throw: one resumed by a release runs inside an
+   * unlock call, which may be a guard destructor. The mutex must outlive every
+   * queued waiter.
+   */
+  template <typename Mutex = upgrade_mutex>
+  class async_upgrade_mutex
+  {
+  public:
+    using mutex_type = Mutex;
+    using task = std::function<void()>;
+    // Runs a resumed waiter. Empty means inline, on the releasing thread.
+    using executor_type = std::function<void(task)>;
+
+    explicit async_upgrade_mutex(executor_type executor = {}) : executor_(std::move(executor)) {}
+
+    async_upgrade_mutex(const async_upgrade_mutex &) = delete;
+    async_upgrade_mutex &operator=(const async_upgrade_mutex &) = delete;
+
+    // Exclusive locking
+    void lock() { mutex_.lock(); }
+    void unlock()
+    {
+      mutex_.unlock();
+      wake_async();
+    }
+
+    // Shared locking
+    void lock_shared() { mutex_.lock_shared(); }
+    void unlock_shared()
+    {
+      mutex_.unlock_shared();
+      wake_async();
+    }
+
+    // Upgradeable locking
+    void lock_upgrade() { mutex_.lock_upgrade(); }
+    void unlock_upgrade()
+    {
+      mutex_.unlock_upgrade();
+      wake_async();
+    }
+
+    // Non-blocking acquisition
+    bool try_lock() { return mutex_.try_lock(); }
+    bool try_lock_shared() { return mutex_.try_lock_shared(); }
+    bool try_lock_upgrade() { return mutex_.try_lock_upgrade(); }
+
+    // Timed acquisition
+    template <typename Rep, typename Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout) { return mutex_.try_lock_for(timeout); }
+    template <typename Clock, typename Duration>
+    bool try_lock_until(const std::chrono::time_point<Clock, Duration> &deadline) { return mutex_.try_lock_until(deadline); }
+    template <typename Rep, typename Period>
+    bool try_lock_shared_for(const std::chrono::duration<Rep, Period> &timeout) { return mutex_.try_lock_shared_for(timeout); }
+    template <typename Clock, typename Duration>
+    bool try_lock_shared_until(const std::chrono::time_point<Clock, Duration> &deadline) { return mutex_.try_lock_shared_until(deadline); }
+    template <typename Rep, typename Period>
+    bool try_lock_upgrade_for(const std::chrono::duration<Rep, Period> &timeout) { return mutex_.try_lock_upgrade_for(timeout); }
+    template <typename Clock, typename Duration>
+    bool try_lock_upgrade_until(const std::chrono::time_point<Clock, Duration> &deadline) { return mutex_.try_lock_upgrade_until(deadline); }
+
+    // Conditional escalation of a held shared lock
+    bool try_upgrade_from_shared() { return mutex_.try_upgrade_from_shared(); }
+
+    // --- Continuation API ---
+    // `fn` is called with a guard that owns the lock. It must be copyable.
+    template <typename F>
+    void async_lock(F &&fn);
+    template <typename F>
+    void async_lock_shared(F &&fn);
+    template <typename F>
+    void async_lock_upgrade(F &&fn);
+
+    // Converts `lock`'s upgrade lock to exclusive once the readers are gone,
+    // then calls `fn` with a unique_lock. `lock` is left empty.
+    template <typename F>
+    void async_upgrade(upgrade_lock<async_upgrade_mutex> &&lock, F &&fn);
+
+#if SYNC_PRIM_HAS_COROUTINES
+    // --- Coroutine API ---
+    template <template <typename> class Guard, detail::async_mode Mode>
+    class lock_awaiter;
+    class upgrade_awaiter;
+
+    lock_awaiter<unique_lock, detail::async_mode::exclusive> async_lock() noexcept { return {*this}; }
+    lock_awaiter<shared_lock, detail::async_mode::shared> async_lock_shared() noexcept { return {*this}; }
+    lock_awaiter<upgrade_lock, detail::async_mode::upgrade> async_lock_upgrade() noexcept { return {*this}; }
+    upgrade_awaiter async_upgrade(upgrade_lock<async_upgrade_mutex> &lock) noexcept { return upgrade_awaiter(*this, lock); }
+#endif
+
+    // Queued continuations, including a waiting conversion.
+    std::size_t async_waiters() const noexcept { return queued_.load(std::memory_order_relaxed); }
+
+    Mutex &native() noexcept { return mutex_; }
+
+  private:
+    template <typename>
+    friend class unique_lock;
+    template <typename>
+    friend class shared_lock;
+    template <typename>
+    friend class upgrade_lock;
+    template <typename>
+    friend class scoped_upgrade;
+
+    // --- Internal transition functions for lock guards ---
+    // Forwarded through the wrapped mutex's own guards, which adopt its locks.
+    void upgrade_to_unique();
+    bool try_upgrade_to_unique();
+    template <typename Clock, typename Duration>
+    bool try_upgrade_to_unique_until(const std::chrono::time_point<Clock, Duration> &deadline);
+    void unique_to_upgrade();
+    void unique_to_shared();
+    void scoped_upgrade_entry() { upgrade_to_unique(); }
+    void scoped_upgrade_exit() { unique_to_upgrade(); }
+    bool try_shared_to_unique();
+
+    struct waiter
+    {
+      detail::async_mode mode;
+      task resume;
+    };
+
+    // --- Queue helpers ---
+    bool try_acquire(detail::async_mode mode);
+    // The fast path: async callers do not overtake queued waiters.
+    bool try_acquire_unqueued(detail::async_mode mode) { return queued_.load(std::memory_order_relaxed) == 0 && try_acquire(mode); }
+    void enqueue(detail::async_mode mode, task resume);
+    void wake_async();
+    void dispatch();
+    void run(task &resume);
+
+    Mutex mutex_;
+    executor_type executor_;
+
+    // Guards waiters_ and converter_. Only taken on the slow path.
+    std::mutex queue_mutex_;
+    std::deque<waiter> waiters_;
+    task converter_;
+    std::atomic<std::size_t> queued_{0};
+  };
+
+  // --- async_upgrade_mutex Method Implementations ---
+
+  template <typename Mutex>
+  inline bool async_upgrade_mutex<Mutex>::try_acquire(detail::async_mode mode)
+  {
+    switch (mode)
+    {
+    case detail::async_mode::exclusive:
+      return mutex_.try_lock();
+    case detail::async_mode::shared:
+      return mutex_.try_lock_shared();
+    case detail::async_mode::upgrade:
+      return mutex_.try_lock_upgrade();
+    default:
+      return try_upgrade_to_unique();
+    }
+  }
+
+  template <typename Mutex>
+  inline void async_upgrade_mutex<Mutex>::enqueue(detail::async_mode mode, task resume)
+  {
+    {
+      std::lock_guard<std::mutex> guard(queue_mutex_);
+      if (mode == detail::async_mode::convert)
+        converter_ = std::move(resume);
+      else
+        waiters_.push_back(waiter{mode, std::move(resume)});
+      queued_.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Pairs with the fence in wake_async(): either a release that raced with
+    // the failed fast path sees this waiter, or dispatch() below sees the
+    // release.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    dispatch();
+  }
+
+  template <typename Mutex>
+  inline void async_upgrade_mutex<Mutex>::wake_async()
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (queued_.load(std::memory_order_relaxed) != 0)
+      dispatch();
+  }
+
+  template <typename Mutex>
+  inline void async_upgrade_mutex<Mutex>::dispatch()
+  {
+    std::vector<task> ready;
+    {
+      std::lock_guard<std::mutex> guard(queue_mutex_);
+      if (converter_)
+      {
+        // The upgrade owner blocks every queued writer and upgrader, and
+        // granting more readers would only delay it.
+        if (!try_upgrade_to_unique())
+          return;
+        ready.push_back(std::move(converter_));
+        converter_ = nullptr;
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+      }
+      while (!waiters_.empty() && try_acquire(waiters_.front().mode))
+      {
+        ready.push_back(std::move(waiters_.front().resume));
+        waiters_.pop_front();
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+      }
+    }
+    for (task &resume : ready)
+      run(resume);
+  }
+
+  template <typename Mutex>
+  inline void async_upgrade_mutex<Mutex>::run(task &resume)
+  {
+    if (executor_)
+      executor_(std::move(resume));
+    else
+      resume();
+  }
+
+  template <typename Mutex>
+  template <typename F>
+  inline void async_upgrade_mutex<Mutex>::async_lock(F &&fn)
+  {
+    if (try_acquire_unqueued(detail::async_mode::exclusive))
+    {
+      fn(unique_lock<async_upgrade_mutex>(*this, std::adopt_lock));
+      return;
+    }
+    enqueue(detail::async_mode::exclusive, [this, fn = std::forward<F>(fn)]() mutable
+            { fn(unique_lock<async_upgrade_mutex>(*this, std::adopt_lock)); });
+  }
+
+  template <typename Mutex>
+  template <typename F>
+  inline void async_upgrade_mutex<Mutex>::async_lock_shared(F &&fn)
+  {
+    if (try_acquire_unqueued(detail::async_mode::shared))
+    {
+      fn(shared_lock<async_upgrade_mutex>(*this, std::adopt_lock));
+      return;
+    }
+    enqueue(detail::async_mode::shared, [this, fn = std::forward<F>(fn)]() mutable
+            { fn(shared_lock<async_upgrade_mutex>(*this, std::adopt_lock)); });
+  }
+
+  template <typename Mutex>
+  template <typename F>
+  inline void async_upgrade_mutex<Mutex>::async_lock_upgrade(F &&fn)
+  {
+    if (try_acquire_unqueued(detail::async_mode::upgrade))
+    {
+      fn(upgrade_lock<async_upgrade_mutex>(*this, std::adopt_lock));
+      return;
+    }
+    enqueue(detail::async_mode::upgrade, [this, fn = std::forward<F>(fn)]() mutable
+            { fn(upgrade_lock<async_upgrade_mutex>(*this, std::adopt_lock)); });
+  }
+
+  template <typename Mutex>
+  template <typename F>
+  inline void async_upgrade_mutex<Mutex>::async_upgrade(upgrade_lock<async_upgrade_mutex> &&lock, F &&fn)
+  {
+    // The upgrade lock is now owned by the pending conversion.
+    lock.release();
+    if (try_upgrade_to_unique())
+    {
+      fn(unique_lock<async_upgrade_mutex>(*this, std::adopt_lock));
+      return;
+    }
+    enqueue(detail::async_mode::convert, [this, fn = std::forward<F>(fn)]() mutable
+            { fn(unique_lock<async_upgrade_mutex>(*this, std::adopt_lock)); });
+  }
+
+#if SYNC_PRIM_HAS_COROUTINES
+  /**
+   * @brief Awaitable acquisition in one mode. `co_await` yields a guard that
+   * owns the lock; await_ready() is the non-suspending fast path.
+   */
+  template <typename Mutex>
+  template <template <typename> class Guard, detail::async_mode Mode>
+  class async_upgrade_mutex<Mutex>::lock_awaiter
+  {
+  public:
+    lock_awaiter(async_upgrade_mutex &mtx) noexcept : mtx_(mtx) {}
+
+    bool await_ready() { return mtx_.try_acquire_unqueued(Mode); }
+    // May resume `handle` before returning, so the awaiter is not touched
+    // after enqueue().
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+      mtx_.enqueue(Mode, [handle]
+                   { handle.resume(); });
+    }
+    Guard<async_upgrade_mutex> await_resume() noexcept { return Guard<async_upgrade_mutex>(mtx_, std::adopt_lock); }
+
+  private:
+    async_upgrade_mutex &mtx_;
+  };
+
+  /**
+   * @brief Awaitable upgrade-to-exclusive conversion. The upgrade_lock is
+   * emptied when the awaiter is created; `co_await` yields a unique_lock.
+   */
+  template <typename Mutex>
+  class async_upgrade_mutex<Mutex>::upgrade_awaiter
+  {
+  public:
+    upgrade_awaiter(async_upgrade_mutex &mtx, upgrade_lock<async_upgrade_mutex> &lock) noexcept : mtx_(mtx) { lock.release(); }
+
+    bool await_ready() { return mtx_.try_upgrade_to_unique(); }
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+      mtx_.enqueue(detail::async_mode::convert, [handle]
+                   { handle.resume(); });
+    }
+    unique_lock<async_upgrade_mutex> await_resume() noexcept { return unique_lock<async_upgrade_mutex>(mtx_, std::adopt_lock); }
+
+  private:
+    async_upgrade_mutex &mtx_;
+  };
+#endif
+
+  template <typename Mutex>
+  inline void async_upgrade_mutex<Mutex>::upgrade_to_unique()
+  {
+    upgrade_lock<Mutex> u_lock(mutex_, std::adopt_lock);
+    unique_lock<Mutex> x_lock(std::move(u_lock));
+    x_lock.release();
+  }
+
+  template <typename Mutex>
+  inline bool async_upgrade_mutex<Mutex>::try_upgrade_to_unique()
+  {
+    upgrade_lock<Mutex> u_lock(mutex_, std::adopt_lock);
+    unique_lock<Mutex> x_lock(std::move(u_lock), std::try_to_lock);
+    if (!x_lock.owns_lock())
+    {
+      u_lock.release(); // Still upgradeable
+      return false;
+    }
+    x_lock.release();
+    return true;
+  }
+
+  template <typename Mutex>
+  template <typename Clock, typename Duration>
+  inline bool async_upgrade_mutex<Mutex>::try_upgrade_to_unique_until(const std::chrono::time_point<Clock, Duration> &deadline)
+  {
+    upgrade_lock<Mutex> u_lock(mutex_, std::adopt_lock);
+    unique_lock<Mutex> x_lock(std::move(u_lock), deadline);
+    if (!x_lock.owns_lock())
+    {
+      u_lock.release();
+      // An abandoned timed upgrade may have held queued readers back.
+      wake_async();
+      return false;
+    }
+    x_lock.release();
+    return true;
+  }
+
+  template <typename Mutex>
+  inline bool async_upgrade_mutex<Mutex>::try_shared_to_unique()
+  {
+    shared_lock<Mutex> s_lock(mutex_, std::adopt_lock);
+    unique_lock<Mutex> x_lock(std::move(s_lock), std::try_to_lock);
+    if (!x_lock.owns_lock())
+    {
+      s_lock.release(); // Still shared
+      return false;
+    }
+    x_lock.release();
+    return true;
+  }
+
+  template <typename Mutex>
+  inline void async_upgrade_mutex<Mutex>::unique_to_upgrade()
+  {
+    unique_lock<Mutex> x_lock(mutex_, std::adopt_lock);
+    upgrade_lock<Mutex> u_lock(std::move(x_lock));
+    u_lock.release();
+    wake_async();
+  }
+
+  template <typename Mutex>
+  inline void async_upgrade_mutex<Mutex>::unique_to_shared()
+  {
+    unique_lock<Mutex> x_lock(mutex_, std::adopt_lock);
+    shared_lock<Mutex> s_lock(std::move(x_lock));
+    s_lock.release();
+    wake_async();
+  }
+
+} // namespace sync_prim
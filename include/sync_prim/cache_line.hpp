@@ -0,0 +1,113 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Cache line size assumed when separating hot atomics from other data.
+ *
+ * Defaults to 64 bytes. Define it to 128 for targets with 128-byte lines or
+ * adjacent-line prefetching (e.g. Apple M-series, some Intel parts).
+ * std::hardware_destructive_interference_size is not used because its value
+ * can differ between translation units built with different tuning flags,
+ * which would silently change the layout of types in this header-only library.
+ */
+#ifndef SYNC_PRIM_CACHE_LINE_SIZE
+#define SYNC_PRIM_CACHE_LINE_SIZE 64
+#endif
+
+namespace sync_prim
+{
+
+  inline constexpr std::size_t cache_line_size = SYNC_PRIM_CACHE_LINE_SIZE;
+
+  static_assert((cache_line_size & (cache_line_size - 1)) == 0, "SYNC_PRIM_CACHE_LINE_SIZE must be a power of two");
+
+  namespace detail
+  {
+    /**
+     * @brief Alignment of a mutex's state word given its park backend.
+     *
+     * The park backend is the mutex's first base class. A stateless backend
+     * leaves the state word alone, so the whole mutex stays one word. A
+     * backend with wait structures moves the state word onto its own cache
+     * line, so sleeping and waking on the slow path never invalidates the line
+     * that the lock-free paths spin on.
+     */
+    template <typename Backend, typename Word = uint32_t>
+    inline constexpr std::size_t state_alignment =
+        std::is_empty_v<Backend> ? alignof(std::atomic<Word>) : cache_line_size;
+
+    /**
+     * @brief A small per-thread integer used to spread threads across padded
+     * slots (reader slots, statistics shards).
+     *
+     * Threads are numbered round-robin on first use. The hint is stable for the
+     * lifetime of the thread, so an unlock finds the same slot that the lock
+     * used even if the thread migrated between CPUs.
+     */
+    inline std::size_t reader_slot_hint() noexcept
+    {
+      static std::atomic<std::size_t> next_hint{0};
+      thread_local std::size_t hint = next_hint.fetch_add(1, std::memory_order_relaxed);
+      return hint;
+    }
+  } // namespace detail
+
+  /**
+   * @brief Holds a T on its own cache line.
+   *
+   * The wrapper starts on a line boundary and its size is rounded up to a whole
+   * number of lines, so neighbouring objects (e.g. in an array) never share a
+   * line with the value.
+   */
+  template <typename T>
+  class alignas(cache_line_size) cache_padded
+  {
+  public:
+    cache_padded() = default;
+
+    template <typename Arg, typename... Args,
+              typename = std::enable_if_t<!std::is_same_v<std::decay_t<Arg>, cache_padded>>>
+    explicit cache_padded(Arg &&arg, Args &&...args)
+        : value_(std::forward<Arg>(arg), std::forward<Args>(args)...) {}
+
+    T &get() noexcept { return value_; }
+    const T &get() const noexcept { return value_; }
+
+    T &operator*() noexcept { return value_; }
+    const T &operator*() const noexcept { return value_; }
+    T *operator->() noexcept { return &value_; }
+    const T *operator->() const noexcept { return &value_; }
+
+  private:
+    T value_;
+  };
+
+} // namespace sync_prim
@@ -0,0 +1,577 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "sync_prim/upgrade_mutex.hpp"
+
+namespace sync_prim
+{
+
+  /**
+   * @brief Category tag shared by all reader slot policies.
+   */
+  struct reader_slot_tag
+  {
+  };
+
+  // --- Reader Slot Policies ---
+  // A reader slot policy picks the slot a thread counts itself in. It provides
+  // `slot_hint()`, which must return the same value every time it is called on
+  // a given thread; the mutex reduces it modulo SlotCount.
+
+  /**
+   * @brief Spreads threads round-robin over the slots (the default).
+   */
+  struct thread_slots
+  {
+    using policy_category = reader_slot_tag;
+    static std::size_t slot_hint() noexcept { return detail::reader_slot_hint(); }
+  };
+
+  /**
+   * @class distributed_upgrade_mutex
+   * @brief A big-reader variant of upgrade_mutex for read-mostly workloads.
+   *
+   * Readers only touch one of SlotCount cache-line-padded counters, chosen by a
+   * per-thread hint, so concurrent readers on different threads do not share
+   * a cache line. Writers and the upgrader set a flag in a central state word
+   * that stops new readers, then sweep all slots until they drain.
+   *
+   * The API, lock guards and upgrade semantics match basic_upgrade_mutex,
+   * including the UPGRADE_PENDING_FLAG that blocks new readers while an
+   * upgrade_to_unique() drains existing ones. Unlike basic_upgrade_mutex, a
+   * plain lock() blocks new readers as soon as it owns the central word, so
+   * writers are preferred over readers. The trade-off is a costlier write
+   * path (an O(SlotCount) sweep) and SlotCount cache lines of storage.
+   *
+   * Policies are the same as for basic_upgrade_mutex (wait policy, park
+   * backend), plus a reader slot policy that maps threads to slots (defaults
+   * to `thread_slots`).
+   */
+  template <std::size_t SlotCount = 32, typename... Policies>
+  class distributed_upgrade_mutex
+      : private detail::select_policy_t<park_backend_tag, condvar_backend, Policies...>
+  {
+  public:
+    static_assert(SlotCount > 0, "distributed_upgrade_mutex needs at least one reader slot");
+
+    using wait_policy = detail::select_policy_t<wait_policy_tag, spin_then_park, Policies...>;
+    using park_backend = detail::select_policy_t<park_backend_tag, condvar_backend, Policies...>;
+    using reader_slot_policy = detail::select_policy_t<reader_slot_tag, thread_slots, Policies...>;
+
+    distributed_upgrade_mutex() : state_(0) {}
+
+    distributed_upgrade_mutex(const distributed_upgrade_mutex &) = delete;
+    distributed_upgrade_mutex &operator=(const distributed_upgrade_mutex &) = delete;
+
+    // Exclusive locking
+    void lock();
+    void unlock();
+
+    // Shared locking
+    void lock_shared();
+    void unlock_shared();
+
+    // Upgradeable locking
+    void lock_upgrade();
+    void unlock_upgrade();
+
+    // Non-blocking acquisition. try_lock() sweeps the slots once and backs
+    // out if any reader is present.
+    bool try_lock();
+    bool try_lock_shared();
+    bool try_lock_upgrade();
+
+    // Timed acquisition
+    template <typename Rep, typename Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout);
+    template <typename Clock, typename Duration>
+    bool try_lock_until(const std::chrono::time_point<Clock, Duration> &deadline);
+    template <typename Rep, typename Period>
+    bool try_lock_shared_for(const std::chrono::duration<Rep, Period> &timeout);
+    template <typename Clock, typename Duration>
+    bool try_lock_shared_until(const std::chrono::time_point<Clock, Duration> &deadline);
+    template <typename Rep, typename Period>
+    bool try_lock_upgrade_for(const std::chrono::duration<Rep, Period> &timeout);
+    template <typename Clock, typename Duration>
+    bool try_lock_upgrade_until(const std::chrono::time_point<Clock, Duration> &deadline);
+
+    // Conditional escalation of a held shared lock. The upgrade flag is
+    // claimed before our slot is released, so the caller is never unlocked.
+    bool try_upgrade_from_shared();
+
+  private:
+    template <typename>
+    friend class unique_lock;
+    template <typename>
+    friend class shared_lock;
+    template <typename>
+    friend class upgrade_lock;
+    template <typename>
+    friend class scoped_upgrade;
+
+    // --- Internal transition functions for lock guards ---
+    void upgrade_to_unique();
+    bool try_upgrade_to_unique();
+    template <typename Clock, typename Duration>
+    bool try_upgrade_to_unique_until(const std::chrono::time_point<Clock, Duration> &deadline);
+    void unique_to_upgrade();
+    void unique_to_shared();
+    void scoped_upgrade_entry();
+    void scoped_upgrade_exit();
+    bool try_shared_to_unique();
+
+    // --- Helpers ---
+    std::atomic<uint32_t> &my_slot() noexcept;
+    bool try_claim_exclusive();
+    bool try_acquire_upgrade();
+    bool readers_admitted() const;
+    bool slots_drained() const;
+    void drain_readers();
+    template <typename Clock, typename Duration, typename TryAcquire>
+    bool acquire_until(int gate, uint32_t waiters_flag, const std::chrono::time_point<Clock, Duration> &deadline, TryAcquire try_acquire);
+    void notify_drainer(uint32_t observed_state);
+
+    // Backend gate indices
+    static constexpr int GATE1 = 0; // For shared/upgrade waiters
+    static constexpr int GATE2 = 1; // For exclusive waiters and slot drains
+
+    // --- State constants ---
+    // The central state word holds no reader count; readers live in slots_.
+    // Bit 31: Exclusive write lock held (or being drained towards)
+    // Bit 30: Upgradeable lock held
+    // Bit 29: An upgrade to exclusive is pending (to starve new readers)
+    // Bit 28: At least one thread is parked on gate1
+    // Bit 27: At least one thread is parked on gate2
+    static constexpr uint32_t WRITE_LOCKED_FLAG = 1u << 31;
+    static constexpr uint32_t UPGRADE_LOCKED_FLAG = 1u << 30;
+    static constexpr uint32_t UPGRADE_PENDING_FLAG = 1u << 29;
+    static constexpr uint32_t GATE1_WAITERS_FLAG = 1u << 28;
+    static constexpr uint32_t GATE2_WAITERS_FLAG = 1u << 27;
+    static constexpr uint32_t WAITER_FLAGS = GATE1_WAITERS_FLAG | GATE2_WAITERS_FLAG;
+    static constexpr uint32_t READERS_BLOCKED = WRITE_LOCKED_FLAG | UPGRADE_PENDING_FLAG;
+
+    // One reader counter per cache line
+    struct alignas(cache_line_size) reader_slot
+    {
+      std::atomic<uint32_t> readers{0};
+    };
+
+    // --- Synchronization Primitives ---
+    // As in basic_upgrade_mutex, the central word gets its own line unless the
+    // park backend is stateless; the slots always start on a fresh line.
+    alignas(detail::state_alignment<park_backend>) std::atomic<uint32_t> state_;
+    reader_slot slots_[SlotCount];
+  };
+
+  // --- distributed_upgrade_mutex Method Implementations ---
+  // Readers publish themselves in their slot and then check the central word;
+  // writers publish the central flag and then check the slots. Both sides use
+  // sequentially consistent operations so that at least one of them observes
+  // the other (the classic store-load/Dekker pattern).
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline void distributed_upgrade_mutex<SlotCount, Policies...>::lock()
+  {
+    // Claim the central word against other writers and the upgrader. This
+    // immediately stops new readers.
+    if (!try_claim_exclusive() && !wait_policy::spin_until([this]
+                                                           { return try_claim_exclusive(); }))
+    {
+      park_backend::park(state_, GATE2, GATE2_WAITERS_FLAG, [this]
+                         { return try_claim_exclusive(); });
+    }
+    drain_readers();
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline void distributed_upgrade_mutex<SlotCount, Policies...>::unlock()
+  {
+    uint32_t old_state = state_.fetch_and(~WRITE_LOCKED_FLAG, std::memory_order_release);
+    if ((old_state & WAITER_FLAGS) == 0)
+      return; // Nobody is parked, nothing to signal.
+
+    // Wake up ONE waiting writer on gate2, and ALL readers and upgraders on gate1.
+    if (old_state & GATE2_WAITERS_FLAG)
+      park_backend::notify(state_, GATE2, GATE2_WAITERS_FLAG, false);
+    if (old_state & GATE1_WAITERS_FLAG)
+      park_backend::notify(state_, GATE1, GATE1_WAITERS_FLAG, true);
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline void distributed_upgrade_mutex<SlotCount, Policies...>::lock_shared()
+  {
+    std::atomic<uint32_t> &slot = my_slot();
+    for (;;)
+    {
+      // Fast path: one RMW on a line no other thread (ideally) writes to.
+      slot.fetch_add(1, std::memory_order_seq_cst);
+      uint32_t current_state = state_.load(std::memory_order_seq_cst);
+      if ((current_state & READERS_BLOCKED) == 0)
+        return;
+
+      // A writer or upgrader is draining. Back out so it can proceed, and
+      // wait for it to finish before publishing ourselves again.
+      slot.fetch_sub(1, std::memory_order_seq_cst);
+      notify_drainer(state_.load(std::memory_order_seq_cst));
+
+      if (!wait_policy::spin_until([this]
+                                   { return readers_admitted(); }))
+      {
+        park_backend::park(state_, GATE1, GATE1_WAITERS_FLAG, [this]
+                           { return readers_admitted(); });
+      }
+    }
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline void distributed_upgrade_mutex<SlotCount, Policies...>::unlock_shared()
+  {
+    my_slot().fetch_sub(1, std::memory_order_seq_cst);
+    notify_drainer(state_.load(std::memory_order_seq_cst));
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline void distributed_upgrade_mutex<SlotCount, Policies...>::lock_upgrade()
+  {
+    // The upgrader coexists with readers, so only the central word is involved.
+    if (!try_acquire_upgrade() && !wait_policy::spin_until([this]
+                                                           { return try_acquire_upgrade(); }))
+    {
+      park_backend::park(state_, GATE1, GATE1_WAITERS_FLAG, [this]
+                         { return try_acquire_upgrade(); });
+    }
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline void distributed_upgrade_mutex<SlotCount, Policies...>::unlock_upgrade()
+  {
+    uint32_t old_state = state_.fetch_and(~UPGRADE_LOCKED_FLAG, std::memory_order_release);
+    if ((old_state & WAITER_FLAGS) == 0)
+      return; // Nobody is parked, nothing to signal.
+
+    if (old_state & GATE2_WAITERS_FLAG)
+      park_backend::notify(state_, GATE2, GATE2_WAITERS_FLAG, false);
+    if (old_state & GATE1_WAITERS_FLAG)
+      park_backend::notify(state_, GATE1, GATE1_WAITERS_FLAG, true);
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline bool distributed_upgrade_mutex<SlotCount, Policies...>::try_lock()
+  {
+    if (!try_claim_exclusive())
+      return false;
+    if (slots_drained())
+      return true;
+    // Readers are present; undo the claim and wake anyone who blocked on it.
+    unlock();
+    return false;
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline bool distributed_upgrade_mutex<SlotCount, Policies...>::try_lock_shared()
+  {
+    std::atomic<uint32_t> &slot = my_slot();
+    slot.fetch_add(1, std::memory_order_seq_cst);
+    if ((state_.load(std::memory_order_seq_cst) & READERS_BLOCKED) == 0)
+      return true;
+    slot.fetch_sub(1, std::memory_order_seq_cst);
+    notify_drainer(state_.load(std::memory_order_seq_cst));
+    return false;
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline bool distributed_upgrade_mutex<SlotCount, Policies...>::try_lock_upgrade()
+  {
+    return try_acquire_upgrade();
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  template <typename Rep, typename Period>
+  inline bool distributed_upgrade_mutex<SlotCount, Policies...>::try_lock_for(const std::chrono::duration<Rep, Period> &timeout)
+  {
+    return try_lock_until(std::chrono::steady_clock::now() + timeout);
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  template <typename Clock, typename Duration>
+  inline bool distributed_upgrade_mutex<SlotCount, Policies...>::try_lock_until(const std::chrono::time_point<Clock, Duration> &deadline)
+  {
+    if (!try_claim_exclusive() && !acquire_until(GATE2, GATE2_WAITERS_FLAG, deadline, [this]
+                                                 { return try_claim_exclusive(); }))
+      return false;
+    if (slots_drained() || acquire_until(GATE2, GATE2_WAITERS_FLAG, deadline, [this]
+                                         { return slots_drained(); }))
+      return true;
+    // Timed out while draining; undo the claim and wake anyone who blocked on it.
+    unlock();
+    return false;
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  template <typename Rep, typename Period>
+  inline bool distributed_upgrade_mutex<SlotCount, Policies...>::try_lock_shared_for(const std::chrono::duration<Rep, Period> &timeout)
+  {
+    return try_lock_shared_until(std::chrono::steady_clock::now() + timeout);
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  template <typename Clock, typename Duration>
+  inline bool distributed_upgrade_mutex<SlotCount, Policies...>::try_lock_shared_until(const std::chrono::time_point<Clock, Duration> &deadline)
+  {
+    while (!try_lock_shared())
+    {
+      if (!acquire_until(GATE1, GATE1_WAITERS_FLAG, deadline, [this]
+                         { return readers_admitted(); }))
+        return false;
+    }
+    return true;
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  template <typename Rep, typename Period>
+  inline bool distributed_upgrade_mutex<SlotCount, Policies...>::try_lock_upgrade_for(const std::chrono::duration<Rep, Period> &timeout)
+  {
+    return try_lock_upgrade_until(std::chrono::steady_clock::now() + timeout);
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  template <typename Clock, typename Duration>
+  inline bool distributed_upgrade_mutex<SlotCount, Policies...>::try_lock_upgrade_until(const std::chrono::time_point<Clock, Duration> &deadline)
+  {
+    return try_acquire_upgrade() || acquire_until(GATE1, GATE1_WAITERS_FLAG, deadline, [this]
+                                                  { return try_acquire_upgrade(); });
+  }
+
+  // --- Internal Transition Method Implementations ---
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline void distributed_upgrade_mutex<SlotCount, Policies...>::upgrade_to_unique()
+  {
+    // Signal that an upgrade is pending to block new readers
+    state_.fetch_or(UPGRADE_PENDING_FLAG, std::memory_order_seq_cst);
+
+    // Wait until all current readers are finished
+    drain_readers();
+
+    // Atomically swap upgrade and pending flags for the write flag
+    state_.fetch_xor(UPGRADE_LOCKED_FLAG | UPGRADE_PENDING_FLAG | WRITE_LOCKED_FLAG, std::memory_order_acquire);
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline bool distributed_upgrade_mutex<SlotCount, Policies...>::try_upgrade_to_unique()
+  {
+    // Block new readers while we sweep once; back out if any reader remains.
+    state_.fetch_or(UPGRADE_PENDING_FLAG, std::memory_order_seq_cst);
+    if (slots_drained())
+    {
+      state_.fetch_xor(UPGRADE_LOCKED_FLAG | UPGRADE_PENDING_FLAG | WRITE_LOCKED_FLAG, std::memory_order_acquire);
+      return true;
+    }
+    uint32_t old_state = state_.fetch_and(~UPGRADE_PENDING_FLAG, std::memory_order_release);
+    if (old_state & GATE1_WAITERS_FLAG)
+      park_backend::notify(state_, GATE1, GATE1_WAITERS_FLAG, true);
+    return false;
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline bool distributed_upgrade_mutex<SlotCount, Policies...>::try_upgrade_from_shared()
+  {
+    if (!try_acquire_upgrade())
+      return false;
+    unlock_shared();
+    return true;
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline bool distributed_upgrade_mutex<SlotCount, Policies...>::try_shared_to_unique()
+  {
+    // Claim the upgrade flag while still reading, then sweep once as
+    // try_upgrade_to_unique() does, with our own reader withdrawn.
+    if (!try_acquire_upgrade())
+      return false;
+    state_.fetch_or(UPGRADE_PENDING_FLAG, std::memory_order_seq_cst);
+    std::atomic<uint32_t> &slot = my_slot();
+    slot.fetch_sub(1, std::memory_order_seq_cst);
+    if (slots_drained())
+    {
+      state_.fetch_xor(UPGRADE_LOCKED_FLAG | UPGRADE_PENDING_FLAG | WRITE_LOCKED_FLAG, std::memory_order_acquire);
+      return true;
+    }
+    // Other readers remain. Nobody else can drain while we hold the upgrade
+    // flag, so our reader can simply return to its slot.
+    slot.fetch_add(1, std::memory_order_seq_cst);
+    uint32_t old_state = state_.fetch_and(~UPGRADE_PENDING_FLAG, std::memory_order_release);
+    if (old_state & GATE1_WAITERS_FLAG)
+      park_backend::notify(state_, GATE1, GATE1_WAITERS_FLAG, true);
+    unlock_upgrade();
+    return false;
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  template <typename Clock, typename Duration>
+  inline bool distributed_upgrade_mutex<SlotCount, Policies...>::try_upgrade_to_unique_until(const std::chrono::time_point<Clock, Duration> &deadline)
+  {
+    state_.fetch_or(UPGRADE_PENDING_FLAG, std::memory_order_seq_cst);
+    if (slots_drained() || acquire_until(GATE2, GATE2_WAITERS_FLAG, deadline, [this]
+                                         { return slots_drained(); }))
+    {
+      state_.fetch_xor(UPGRADE_LOCKED_FLAG | UPGRADE_PENDING_FLAG | WRITE_LOCKED_FLAG, std::memory_order_acquire);
+      return true;
+    }
+    // Abandon the upgrade and let the readers it blocked back in.
+    uint32_t old_state = state_.fetch_and(~UPGRADE_PENDING_FLAG, std::memory_order_release);
+    if (old_state & GATE1_WAITERS_FLAG)
+      park_backend::notify(state_, GATE1, GATE1_WAITERS_FLAG, true);
+    return false;
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline void distributed_upgrade_mutex<SlotCount, Policies...>::unique_to_upgrade()
+  {
+    // Atomically swap write flag for upgrade flag
+    uint32_t old_state = state_.fetch_xor(WRITE_LOCKED_FLAG | UPGRADE_LOCKED_FLAG, std::memory_order_release);
+    // Wake up any waiting readers
+    if (old_state & GATE1_WAITERS_FLAG)
+      park_backend::notify(state_, GATE1, GATE1_WAITERS_FLAG, true);
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline void distributed_upgrade_mutex<SlotCount, Policies...>::unique_to_shared()
+  {
+    // Publish ourselves as a reader before dropping the write flag, so that no
+    // writer can slip in between.
+    my_slot().fetch_add(1, std::memory_order_relaxed);
+    uint32_t old_state = state_.fetch_and(~WRITE_LOCKED_FLAG, std::memory_order_release);
+    // Wake up any waiting readers
+    if (old_state & GATE1_WAITERS_FLAG)
+      park_backend::notify(state_, GATE1, GATE1_WAITERS_FLAG, true);
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline void distributed_upgrade_mutex<SlotCount, Policies...>::scoped_upgrade_entry()
+  {
+    // This is identical to a full upgrade
+    upgrade_to_unique();
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline void distributed_upgrade_mutex<SlotCount, Policies...>::scoped_upgrade_exit()
+  {
+    // This is identical to a downgrade to upgradeable
+    unique_to_upgrade();
+  }
+
+  // --- Helpers ---
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline std::atomic<uint32_t> &distributed_upgrade_mutex<SlotCount, Policies...>::my_slot() noexcept
+  {
+    return slots_[reader_slot_policy::slot_hint() % SlotCount].readers;
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline bool distributed_upgrade_mutex<SlotCount, Policies...>::try_claim_exclusive()
+  {
+    // Can claim if there is no writer and no upgrader. Readers are drained afterwards.
+    uint32_t current_state = state_.load(std::memory_order_relaxed);
+    while ((current_state & (WRITE_LOCKED_FLAG | UPGRADE_LOCKED_FLAG)) == 0)
+    {
+      if (state_.compare_exchange_weak(current_state, current_state | WRITE_LOCKED_FLAG, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return true;
+    }
+    return false;
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline bool distributed_upgrade_mutex<SlotCount, Policies...>::try_acquire_upgrade()
+  {
+    // Can acquire if no write lock and no other upgrade lock is held
+    uint32_t current_state = state_.load(std::memory_order_relaxed);
+    while ((current_state & (WRITE_LOCKED_FLAG | UPGRADE_LOCKED_FLAG)) == 0)
+    {
+      if (state_.compare_exchange_weak(current_state, current_state | UPGRADE_LOCKED_FLAG, std::memory_order_acquire, std::memory_order_relaxed))
+        return true;
+    }
+    return false;
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline bool distributed_upgrade_mutex<SlotCount, Policies...>::readers_admitted() const
+  {
+    return (state_.load(std::memory_order_relaxed) & READERS_BLOCKED) == 0;
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline bool distributed_upgrade_mutex<SlotCount, Policies...>::slots_drained() const
+  {
+    // Order the caller's flag update (possibly a relaxed RMW inside the park
+    // backend) before the sweep.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (const reader_slot &slot : slots_)
+    {
+      if (slot.readers.load(std::memory_order_seq_cst) != 0)
+        return false;
+    }
+    return true;
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline void distributed_upgrade_mutex<SlotCount, Policies...>::drain_readers()
+  {
+    // New readers are already blocked by the caller's flag; wait for the rest.
+    if (slots_drained() || wait_policy::spin_until([this]
+                                                   { return slots_drained(); }))
+      return;
+    park_backend::park(state_, GATE2, GATE2_WAITERS_FLAG, [this]
+                       { return slots_drained(); });
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  template <typename Clock, typename Duration, typename TryAcquire>
+  inline bool distributed_upgrade_mutex<SlotCount, Policies...>::acquire_until(int gate, uint32_t waiters_flag, const std::chrono::time_point<Clock, Duration> &deadline, TryAcquire try_acquire)
+  {
+    bool acquired = false;
+    if (wait_policy::spin_until([&]
+                                { return (acquired = try_acquire()) || Clock::now() >= deadline; }))
+      return acquired;
+    return park_backend::park_until(state_, gate, waiters_flag, deadline, try_acquire);
+  }
+
+  template <std::size_t SlotCount, typename... Policies>
+  inline void distributed_upgrade_mutex<SlotCount, Policies...>::notify_drainer(uint32_t observed_state)
+  {
+    // A departing reader only matters to a thread that is sweeping the slots.
+    // That thread shares gate2 with writers waiting for the central word, so
+    // wake all of them to make sure the drainer is among the woken threads.
+    if ((observed_state & GATE2_WAITERS_FLAG) && (observed_state & READERS_BLOCKED))
+      park_backend::notify(state_, GATE2, GATE2_WAITERS_FLAG, true);
+  }
+
+} // namespace sync_prim
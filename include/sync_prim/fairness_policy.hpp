@@ -0,0 +1,87 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+namespace sync_prim
+{
+
+  /**
+   * @brief Category tag shared by all fairness policies.
+   */
+  struct fairness_tag
+  {
+  };
+
+  // --- Fairness Policies ---
+  // A fairness policy decides who goes first when readers and a plain lock()
+  // caller compete. Upgrades are unaffected: a pending upgrade_to_unique()
+  // always blocks new readers. A policy provides:
+  //   - `blocks_new_readers`: a waiting writer sets WRITE_PENDING_FLAG, which
+  //     keeps new readers and upgraders out until it has had its turn.
+  //   - `alternates_phases`: readers that were waiting when a writer released
+  //     are admitted before the next writer, even if it is already pending.
+
+  /**
+   * @brief Readers are admitted whenever no writer holds the lock.
+   *
+   * The default, and the cheapest: a continuous stream of readers can starve a
+   * writer indefinitely.
+   */
+  struct reader_preferring
+  {
+    using policy_category = fairness_tag;
+    static constexpr bool blocks_new_readers = false;
+    static constexpr bool alternates_phases = false;
+  };
+
+  /**
+   * @brief A waiting writer stops new readers until it has acquired the lock.
+   *
+   * Writers never starve, but a steady stream of writers can starve readers.
+   * A thread that already holds a shared lock must not take a second one (it
+   * could block behind a pending writer that waits for the first).
+   */
+  struct writer_preferring
+  {
+    using policy_category = fairness_tag;
+    static constexpr bool blocks_new_readers = true;
+    static constexpr bool alternates_phases = false;
+  };
+
+  /**
+   * @brief Readers and writers take turns in batches.
+   *
+   * As writer_preferring, but when a writer releases, every reader that was
+   * waiting for it gets in before the next writer. Neither side starves.
+   * Requires a park backend with exact waiter flags (condvar_backend) unless
+   * the wait policy never parks.
+   */
+  struct phase_fair
+  {
+    using policy_category = fairness_tag;
+    static constexpr bool blocks_new_readers = true;
+    static constexpr bool alternates_phases = true;
+  };
+
+} // namespace sync_prim
@@ -0,0 +1,137 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sync_prim
+{
+
+  /**
+   * @brief Category tags for the feature policies of basic_upgrade_mutex.
+   */
+  struct upgrade_support_tag
+  {
+  };
+  struct state_width_tag
+  {
+  };
+  struct reader_limit_tag
+  {
+  };
+
+  // --- Feature Policies ---
+  // Feature policies trim or widen basic_upgrade_mutex for call sites that
+  // do not need its full generality. Everything they turn off compiles out:
+  // the flags involved are constant zero, so the checks on them fold away.
+  //
+  // An upgrade support policy provides:
+  //   - `enabled`: whether the upgrade lock and its transitions exist. Without
+  //     it, UPGRADE_LOCKED_FLAG and UPGRADE_PENDING_FLAG are never tested, and
+  //     calling any upgrade operation is a compile error.
+  //
+  // A state width policy provides:
+  //   - `word_type`: the unsigned integer holding the state. The flags take
+  //     the top five bits (eight with writer_preferring or phase_fair) and
+  //     the reader count the rest.
+  //
+  // A reader limit policy provides:
+  //   - `bounded`: whether new readers wait once `max_readers` shared locks
+  //     are held, instead of overflowing the reader count.
+
+  /**
+   * @brief The full shared / upgrade / exclusive mutex. The default.
+   */
+  struct with_upgrade
+  {
+    using policy_category = upgrade_support_tag;
+    static constexpr bool enabled = true;
+  };
+
+  /**
+   * @brief A plain reader-writer mutex: no upgrade lock and no transitions
+   * through it.
+   *
+   * Shared and exclusive acquisition skip every upgrade check, and the last
+   * reader out wakes a writer without looking for a pending upgrade.
+   * unique_to_shared() and the conditional shared-to-exclusive step remain.
+   */
+  struct no_upgrade
+  {
+    using policy_category = upgrade_support_tag;
+    static constexpr bool enabled = false;
+  };
+
+  /**
+   * @brief A 32-bit state word with up to 2^27 - 1 readers (2^24 - 1 under
+   * writer_preferring or phase_fair). The default.
+   */
+  struct narrow_state
+  {
+    using policy_category = state_width_tag;
+    using word_type = uint32_t;
+  };
+
+  /**
+   * @brief A 64-bit state word with up to 2^59 - 1 readers (2^56 - 1 under
+   * writer_preferring or phase_fair), for shared locks used as reference
+   * counts.
+   *
+   * Needs a park backend that can wait on a 64-bit word (condvar_backend).
+   */
+  struct wide_state
+  {
+    using policy_category = state_width_tag;
+    using word_type = uint64_t;
+  };
+
+  /**
+   * @brief No reader limit beyond the width of the count. The default.
+   */
+  struct unbounded_readers
+  {
+    using policy_category = reader_limit_tag;
+    static constexpr bool bounded = false;
+    static constexpr std::size_t max_readers = 0;
+  };
+
+  /**
+   * @brief At most MaxReaders shared locks at a time; further readers wait
+   * (or fail a try) until one is released.
+   *
+   * Bounds the load behind a shared resource, and makes overflowing the
+   * reader count impossible. Costs one compare on the shared fast path and
+   * one on unlock_shared().
+   */
+  template <std::size_t MaxReaders>
+  struct bounded_readers
+  {
+    static_assert(MaxReaders > 0, "bounded_readers needs room for at least one reader");
+    using policy_category = reader_limit_tag;
+    static constexpr bool bounded = true;
+    static constexpr std::size_t max_readers = MaxReaders;
+  };
+
+} // namespace sync_prim
@@ -0,0 +1,72 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+namespace sync_prim
+{
+
+  /**
+   * @brief Category tag shared by all handoff policies.
+   */
+  struct handoff_tag
+  {
+  };
+
+  // --- Handoff Policies ---
+  // A handoff policy decides what a release does when a writer is parked.
+  // A policy provides:
+  //   - `enabled`: instead of clearing WRITE_LOCKED_FLAG and waking a writer
+  //     that then has to win a CAS against newly arriving threads, the
+  //     releaser leaves the flag set and passes ownership straight to one
+  //     parked writer, which returns from park() already holding the lock.
+
+  /**
+   * @brief Releases always clear the state and wake waiters to compete for it.
+   *
+   * The default. Highest throughput, since a running thread may take the lock
+   * while the woken one is still being scheduled.
+   */
+  struct no_handoff
+  {
+    using policy_category = handoff_tag;
+    static constexpr bool enabled = false;
+  };
+
+  /**
+   * @brief unlock(), and the last unlock_shared() before a parked writer, hand
+   * the exclusive lock directly to a parked writer.
+   *
+   * A woken writer never loses the lock to a barging thread and goes back to
+   * sleep, at the cost of keeping the lock busy while it is being scheduled.
+   * Applies only while no reader or upgrader is parked, so parked readers
+   * still get their turn. Requires a park backend with handoff support
+   * (condvar_backend).
+   */
+  struct direct_handoff
+  {
+    using policy_category = handoff_tag;
+    static constexpr bool enabled = true;
+  };
+
+} // namespace sync_prim
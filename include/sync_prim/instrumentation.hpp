@@ -0,0 +1,312 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "sync_prim/cache_line.hpp"
+
+namespace sync_prim
+{
+
+  /**
+   * @brief Category tag shared by the instrumentation policies.
+   */
+  struct instrumentation_tag
+  {
+  };
+
+  // --- Instrumentation Policies ---
+  // With instrumentation enabled, the mutex counts how each acquisition went
+  // and how long threads waited and held it, and exposes the totals through
+  // basic_upgrade_mutex::stats().
+
+  /**
+   * @brief No statistics. This is the default, and costs nothing.
+   */
+  struct no_instrumentation
+  {
+    using policy_category = instrumentation_tag;
+    static constexpr bool enabled = false;
+  };
+
+  /**
+   * @brief Enables stats() / reset_stats().
+   *
+   * Adds relaxed counter increments to every acquisition and clock reads
+   * around every park, every exclusive or upgrade hold and every pending
+   * upgrade. Counters live in per-thread shards, so uncontended threads do
+   * not contend on them either.
+   */
+  struct instrumented
+  {
+    using policy_category = instrumentation_tag;
+    static constexpr bool enabled = true;
+  };
+
+  /**
+   * @brief A snapshot of an instrumented mutex's counters. Times are in
+   * nanoseconds.
+   */
+  struct lock_stats
+  {
+    struct mode_stats
+    {
+      // Acquired by the first attempt (fast path) or after waiting (slow path).
+      // Failed try_lock*() calls count as neither.
+      uint64_t fast_acquisitions = 0;
+      uint64_t slow_acquisitions = 0;
+
+      uint64_t acquisitions() const noexcept { return fast_acquisitions + slow_acquisitions; }
+    };
+
+    struct gate_stats
+    {
+      uint64_t parks = 0;   // Times a thread went to sleep on the gate
+      uint64_t wait_ns = 0; // Total time spent parked on it
+    };
+
+    struct hold_stats
+    {
+      uint64_t holds = 0;
+      uint64_t hold_ns = 0;
+
+      uint64_t average_ns() const noexcept { return holds ? hold_ns / holds : 0; }
+    };
+
+    mode_stats shared;
+    mode_stats upgrade;
+    mode_stats exclusive;
+
+    gate_stats gate1; // Shared and upgrade waiters
+    gate_stats gate2; // Exclusive waiters and draining upgraders
+
+    // Exclusive holds include those reached by upgrading. Shared holds are
+    // not timed: a reader's lock and unlock are not paired in the mutex.
+    hold_stats exclusive_hold;
+    hold_stats upgrade_hold;
+
+    // upgrade_to_unique() and its try/timed forms, and how many did not convert.
+    uint64_t upgrade_attempts = 0;
+    uint64_t upgrade_failures = 0;
+
+    // How long UPGRADE_PENDING_FLAG stayed set (blocking new readers) per upgrade.
+    hold_stats upgrade_pending;
+
+    uint32_t max_concurrent_readers = 0;
+  };
+
+  namespace detail
+  {
+    enum class lock_mode
+    {
+      shared,
+      upgrade,
+      exclusive,
+    };
+
+    /**
+     * @brief The counters behind the instrumented policy, held by the mutex as
+     * a private base so that the disabled case adds no storage.
+     *
+     * Every hook is an empty inline function here, and stamp_t is an empty
+     * type, so with instrumentation off no clock is ever read.
+     */
+    template <bool Enabled>
+    class lock_stats_recorder
+    {
+    protected:
+      struct stamp_t
+      {
+      };
+
+      static stamp_t stamp() noexcept { return {}; }
+      void record_acquire(lock_mode, bool) noexcept {}
+      void record_readers(uint32_t) noexcept {}
+      void record_park(int, stamp_t) noexcept {}
+      void record_exclusive_start() noexcept {}
+      void record_exclusive_end() noexcept {}
+      void record_upgrade_start() noexcept {}
+      void record_upgrade_end() noexcept {}
+      void record_upgrade_result(stamp_t, bool, bool) noexcept {}
+    };
+
+    template <>
+    class lock_stats_recorder<true>
+    {
+    protected:
+      lock_stats snapshot() const noexcept
+      {
+        lock_stats out;
+        for (const shard &s : shards_)
+        {
+          out.shared.fast_acquisitions += load(s.acquisitions[0][0]);
+          out.shared.slow_acquisitions += load(s.acquisitions[0][1]);
+          out.upgrade.fast_acquisitions += load(s.acquisitions[1][0]);
+          out.upgrade.slow_acquisitions += load(s.acquisitions[1][1]);
+          out.exclusive.fast_acquisitions += load(s.acquisitions[2][0]);
+          out.exclusive.slow_acquisitions += load(s.acquisitions[2][1]);
+          out.gate1.parks += load(s.parks[0]);
+          out.gate1.wait_ns += load(s.park_ns[0]);
+          out.gate2.parks += load(s.parks[1]);
+          out.gate2.wait_ns += load(s.park_ns[1]);
+          out.exclusive_hold.holds += load(s.exclusive_holds);
+          out.exclusive_hold.hold_ns += load(s.exclusive_hold_ns);
+          out.upgrade_hold.holds += load(s.upgrade_holds);
+          out.upgrade_hold.hold_ns += load(s.upgrade_hold_ns);
+          out.upgrade_attempts += load(s.upgrade_attempts);
+          out.upgrade_failures += load(s.upgrade_failures);
+          out.upgrade_pending.holds += load(s.upgrade_pendings);
+          out.upgrade_pending.hold_ns += load(s.upgrade_pending_ns);
+          uint32_t readers = s.max_readers.load(std::memory_order_relaxed);
+          if (readers > out.max_concurrent_readers)
+            out.max_concurrent_readers = readers;
+        }
+        return out;
+      }
+
+      void clear() noexcept
+      {
+        for (shard &s : shards_)
+          s.clear();
+      }
+
+      using stamp_t = std::chrono::steady_clock::time_point;
+
+      static stamp_t stamp() noexcept { return std::chrono::steady_clock::now(); }
+
+      void record_acquire(lock_mode mode, bool slow) noexcept
+      {
+        bump(my_shard().acquisitions[static_cast<int>(mode)][slow]);
+      }
+
+      void record_readers(uint32_t readers) noexcept
+      {
+        std::atomic<uint32_t> &max = my_shard().max_readers;
+        uint32_t seen = max.load(std::memory_order_relaxed);
+        while (readers > seen && !max.compare_exchange_weak(seen, readers, std::memory_order_relaxed))
+        {
+        }
+      }
+
+      void record_park(int gate, stamp_t start) noexcept
+      {
+        shard &s = my_shard();
+        bump(s.parks[gate]);
+        bump(s.park_ns[gate], elapsed_ns(start));
+      }
+
+      // The exclusive owner and the upgrader are unique, so their start times
+      // need no synchronization beyond the lock itself.
+      void record_exclusive_start() noexcept { exclusive_since_ = stamp(); }
+
+      void record_exclusive_end() noexcept
+      {
+        shard &s = my_shard();
+        bump(s.exclusive_holds);
+        bump(s.exclusive_hold_ns, elapsed_ns(exclusive_since_));
+      }
+
+      void record_upgrade_start() noexcept { upgrade_since_ = stamp(); }
+
+      void record_upgrade_end() noexcept
+      {
+        shard &s = my_shard();
+        bump(s.upgrade_holds);
+        bump(s.upgrade_hold_ns, elapsed_ns(upgrade_since_));
+      }
+
+      // `since` is when the attempt began; if `pending` is set, that is also
+      // when UPGRADE_PENDING_FLAG was set (try_upgrade_to_unique() never sets it).
+      void record_upgrade_result(stamp_t since, bool converted, bool pending) noexcept
+      {
+        shard &s = my_shard();
+        bump(s.upgrade_attempts);
+        if (!converted)
+          bump(s.upgrade_failures);
+        if (pending)
+        {
+          bump(s.upgrade_pendings);
+          bump(s.upgrade_pending_ns, elapsed_ns(since));
+        }
+      }
+
+    private:
+      static constexpr std::size_t SHARD_COUNT = 16;
+
+      struct alignas(cache_line_size) shard
+      {
+        std::atomic<uint64_t> acquisitions[3][2] = {};
+        std::atomic<uint64_t> parks[2] = {};
+        std::atomic<uint64_t> park_ns[2] = {};
+        std::atomic<uint64_t> exclusive_holds{0};
+        std::atomic<uint64_t> exclusive_hold_ns{0};
+        std::atomic<uint64_t> upgrade_holds{0};
+        std::atomic<uint64_t> upgrade_hold_ns{0};
+        std::atomic<uint64_t> upgrade_attempts{0};
+        std::atomic<uint64_t> upgrade_failures{0};
+        std::atomic<uint64_t> upgrade_pendings{0};
+        std::atomic<uint64_t> upgrade_pending_ns{0};
+        std::atomic<uint32_t> max_readers{0};
+
+        void clear() noexcept
+        {
+          for (auto &mode : acquisitions)
+            for (auto &counter : mode)
+              counter.store(0, std::memory_order_relaxed);
+          for (int gate = 0; gate < 2; ++gate)
+          {
+            parks[gate].store(0, std::memory_order_relaxed);
+            park_ns[gate].store(0, std::memory_order_relaxed);
+          }
+          for (std::atomic<uint64_t> *counter : {&exclusive_holds, &exclusive_hold_ns, &upgrade_holds, &upgrade_hold_ns,
+                                                 &upgrade_attempts, &upgrade_failures, &upgrade_pendings, &upgrade_pending_ns})
+            counter->store(0, std::memory_order_relaxed);
+          max_readers.store(0, std::memory_order_relaxed);
+        }
+      };
+
+      shard &my_shard() noexcept { return shards_[reader_slot_hint() % SHARD_COUNT]; }
+
+      static uint64_t load(const std::atomic<uint64_t> &counter) noexcept { return counter.load(std::memory_order_relaxed); }
+
+      // Only one thread at a time usually writes a shard, so this is
+      // uncontended; it must still be atomic as threads can share a shard.
+      static void bump(std::atomic<uint64_t> &counter, uint64_t by = 1) noexcept { counter.fetch_add(by, std::memory_order_relaxed); }
+
+      static uint64_t elapsed_ns(stamp_t since) noexcept
+      {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(stamp() - since).count());
+      }
+
+      shard shards_[SHARD_COUNT];
+      stamp_t exclusive_since_{};
+      stamp_t upgrade_since_{};
+    };
+  } // namespace detail
+
+} // namespace sync_prim
@@ -0,0 +1,299 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "sync_prim/upgrade_mutex.hpp"
+
+namespace sync_prim
+{
+
+  // --- Lock Requests ---
+
+  struct shared_mode
+  {
+  };
+  struct upgrade_mode
+  {
+  };
+  struct exclusive_mode
+  {
+  };
+
+  /**
+   * @brief One mutex and the mode to lock it in, for lock() and scoped_lock.
+   *
+   * Made with as_shared(), as_upgrade() or as_exclusive(). A bare mutex
+   * passed to lock() or scoped_lock is an exclusive request, so any standard
+   * Lockable works for that mode.
+   */
+  template <typename Mutex, typename Mode>
+  struct lock_request
+  {
+    Mutex *mutex;
+
+    void lock() const
+    {
+      if constexpr (std::is_same_v<Mode, shared_mode>)
+        mutex->lock_shared();
+      else if constexpr (std::is_same_v<Mode, upgrade_mode>)
+        mutex->lock_upgrade();
+      else
+        mutex->lock();
+    }
+
+    bool try_lock() const
+    {
+      if constexpr (std::is_same_v<Mode, shared_mode>)
+        return mutex->try_lock_shared();
+      else if constexpr (std::is_same_v<Mode, upgrade_mode>)
+        return mutex->try_lock_upgrade();
+      else
+        return mutex->try_lock();
+    }
+
+    void unlock() const
+    {
+      if constexpr (std::is_same_v<Mode, shared_mode>)
+        mutex->unlock_shared();
+      else if constexpr (std::is_same_v<Mode, upgrade_mode>)
+        mutex->unlock_upgrade();
+      else
+        mutex->unlock();
+    }
+  };
+
+  template <typename Mutex>
+  lock_request<Mutex, shared_mode> as_shared(Mutex &m) noexcept { return {&m}; }
+  template <typename Mutex>
+  lock_request<Mutex, upgrade_mode> as_upgrade(Mutex &m) noexcept { return {&m}; }
+  template <typename Mutex>
+  lock_request<Mutex, exclusive_mode> as_exclusive(Mutex &m) noexcept { return {&m}; }
+
+  namespace detail
+  {
+    template <typename T>
+    struct is_lock_request : std::false_type
+    {
+    };
+    template <typename Mutex, typename Mode>
+    struct is_lock_request<lock_request<Mutex, Mode>> : std::true_type
+    {
+    };
+
+    // A lock_request as is, or a bare mutex as an exclusive request.
+    template <typename Arg>
+    using request_type_t = std::conditional_t<is_lock_request<std::decay_t<Arg>>::value, std::decay_t<Arg>,
+                                              lock_request<std::remove_reference_t<Arg>, exclusive_mode>>;
+
+    template <typename Arg>
+    request_type_t<Arg> to_request(Arg &arg) noexcept
+    {
+      if constexpr (is_lock_request<std::decay_t<Arg>>::value)
+        return arg;
+      else
+        return {&arg};
+    }
+
+    // Exclusive requests are the hardest to satisfy, so they go first: the
+    // thread then blocks on the most contended lock while holding nothing,
+    // and picks up the cheap shared locks last.
+    template <typename Request>
+    struct request_rank;
+    template <typename Mutex, typename Mode>
+    struct request_rank<lock_request<Mutex, Mode>>
+        : std::integral_constant<int, std::is_same_v<Mode, exclusive_mode> ? 0 : std::is_same_v<Mode, upgrade_mode> ? 1
+                                                                                                                 : 2>
+    {
+    };
+
+    // A request with its type erased, so the acquisition loop can index them.
+    struct erased_request
+    {
+      const void *request;
+      void (*lock)(const void *);
+      bool (*try_lock)(const void *);
+      void (*unlock)(const void *);
+      int rank;
+    };
+
+    template <typename Request>
+    erased_request erase(const Request &r) noexcept
+    {
+      return {&r,
+              [](const void *p)
+              { static_cast<const Request *>(p)->lock(); },
+              [](const void *p)
+              { return static_cast<const Request *>(p)->try_lock(); },
+              [](const void *p)
+              { static_cast<const Request *>(p)->unlock(); },
+              request_rank<Request>::value};
+    }
+
+    /**
+     * Try-and-back-off: block on one request, then try the rest in order. On
+     * a failure, release everything and start the next round by blocking on
+     * the request that failed, so the thread waits where the contention is
+     * instead of repeatedly taking and dropping the locks in front of it.
+     */
+    template <std::size_t N>
+    void lock_all(std::array<erased_request, N> &requests)
+    {
+      std::stable_sort(requests.begin(), requests.end(), [](const erased_request &a, const erased_request &b)
+                       { return a.rank < b.rank; });
+      std::size_t first = 0;
+      for (;;)
+      {
+        requests[first].lock(requests[first].request);
+        std::size_t failed = N;
+        for (std::size_t k = 1; k < N; ++k)
+        {
+          std::size_t i = (first + k) % N;
+          if (!requests[i].try_lock(requests[i].request))
+          {
+            failed = i;
+            break;
+          }
+        }
+        if (failed == N)
+          return;
+        for (std::size_t i = first; i != failed; i = (i + 1) % N)
+          requests[i].unlock(requests[i].request);
+        first = failed;
+        std::this_thread::yield();
+      }
+    }
+
+    // Returns the index (in argument order) of the first request that
+    // failed, or -1 with every lock held.
+    template <std::size_t N>
+    int try_lock_all(const std::array<erased_request, N> &requests)
+    {
+      for (std::size_t i = 0; i < N; ++i)
+      {
+        if (!requests[i].try_lock(requests[i].request))
+        {
+          for (std::size_t j = 0; j < i; ++j)
+            requests[j].unlock(requests[j].request);
+          return static_cast<int>(i);
+        }
+      }
+      return -1;
+    }
+  } // namespace detail
+
+  // --- Multi-mutex Acquisition ---
+
+  /**
+   * @brief Locks several mutexes, each in its own mode, without deadlock.
+   *
+   *   sync_prim::lock(sync_prim::as_exclusive(to), sync_prim::as_shared(rates), from_mtx);
+   *
+   * Arguments are lock_requests or bare mutexes (locked exclusively). The same
+   * mutex must not appear twice. The caller unlocks each in its mode; prefer
+   * scoped_lock, which does that on destruction.
+   */
+  template <typename... Args>
+  void lock(Args &&...args)
+  {
+    static_assert(sizeof...(Args) > 0, "sync_prim::lock needs at least one request");
+    std::tuple<detail::request_type_t<Args>...> requests{detail::to_request(args)...};
+    std::apply([](const auto &...r)
+               {
+      std::array<detail::erased_request, sizeof...(Args)> erased{detail::erase(r)...};
+      detail::lock_all(erased); },
+               requests);
+  }
+
+  /**
+   * @brief Tries each request once, in argument order.
+   *
+   * Returns -1 if every lock was acquired. Otherwise releases the ones taken
+   * and returns the 0-based index of the request that failed.
+   */
+  template <typename... Args>
+  int try_lock(Args &&...args)
+  {
+    static_assert(sizeof...(Args) > 0, "sync_prim::try_lock needs at least one request");
+    std::tuple<detail::request_type_t<Args>...> requests{detail::to_request(args)...};
+    return std::apply([](const auto &...r)
+                      {
+      std::array<detail::erased_request, sizeof...(Args)> erased{detail::erase(r)...};
+      return detail::try_lock_all(erased); },
+                      requests);
+  }
+
+  /**
+   * @class scoped_lock
+   * @brief Holds several mutexes, each in its own mode, for a scope.
+   *
+   *   sync_prim::scoped_lock guard(from.mtx, to.mtx); // both exclusive
+   *   sync_prim::scoped_lock mixed(sync_prim::as_upgrade(index), sync_prim::as_shared(config));
+   *
+   * Acquires through sync_prim::lock() and releases every lock on destruction.
+   */
+  template <typename... Requests>
+  class scoped_lock
+  {
+  public:
+    template <typename... Args>
+    explicit scoped_lock(Args &&...args) : requests_{detail::to_request(args)...}
+    {
+      std::apply([](const auto &...r)
+                 { sync_prim::lock(r...); },
+                 requests_);
+    }
+
+    // Takes over locks the caller already holds in the requested modes.
+    template <typename... Args>
+    explicit scoped_lock(std::adopt_lock_t, Args &&...args) noexcept : requests_{detail::to_request(args)...} {}
+
+    ~scoped_lock()
+    {
+      std::apply([](const auto &...r)
+                 { (r.unlock(), ...); },
+                 requests_);
+    }
+
+    scoped_lock(const scoped_lock &) = delete;
+    scoped_lock &operator=(const scoped_lock &) = delete;
+
+  private:
+    std::tuple<Requests...> requests_;
+  };
+
+  template <typename... Args>
+  scoped_lock(Args &&...) -> scoped_lock<detail::request_type_t<Args>...>;
+  template <typename... Args>
+  scoped_lock(std::adopt_lock_t, Args &&...) -> scoped_lock<detail::request_type_t<Args>...>;
+
+} // namespace sync_prim
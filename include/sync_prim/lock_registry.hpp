@@ -0,0 +1,569 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sync_prim/upgrade_mutex.hpp"
+
+namespace sync_prim
+{
+
+  /**
+   * @brief A log-bucketed (HDR-style) histogram of nanosecond durations.
+   *
+   * Values below 8 get a bucket each; above that, every power of two is split
+   * into 8 linear sub-buckets, so any recorded value is reported within 12.5%
+   * of its true size, from nanoseconds up to centuries, in 496 counters.
+   * record() is a relaxed increment and may be called concurrently.
+   */
+  class log_histogram
+  {
+  public:
+    static constexpr std::size_t SUB_BUCKET_BITS = 3;
+    static constexpr std::size_t SUB_BUCKETS = std::size_t{1} << SUB_BUCKET_BITS;
+    static constexpr std::size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    void record(uint64_t value) noexcept
+    {
+      buckets_[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+      count_.fetch_add(1, std::memory_order_relaxed);
+      sum_.fetch_add(value, std::memory_order_relaxed);
+      uint64_t seen = max_.load(std::memory_order_relaxed);
+      while (value > seen && !max_.compare_exchange_weak(seen, value, std::memory_order_relaxed))
+      {
+      }
+    }
+
+    uint64_t count() const noexcept { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum() const noexcept { return sum_.load(std::memory_order_relaxed); }
+    uint64_t max() const noexcept { return max_.load(std::memory_order_relaxed); }
+
+    // The lower bound of the bucket holding the p-th quantile (0 <= p <= 1),
+    // or 0 if nothing was recorded.
+    uint64_t percentile(double p) const noexcept
+    {
+      uint64_t total = count();
+      if (total == 0)
+        return 0;
+      uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(total - 1)) + 1;
+      uint64_t seen = 0;
+      for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+      {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+          return lower_bound_of(i);
+      }
+      return max();
+    }
+
+    static std::size_t bucket_of(uint64_t value) noexcept
+    {
+      if (value < SUB_BUCKETS)
+        return static_cast<std::size_t>(value);
+      std::size_t msb = 0;
+      for (uint64_t v = value; v >>= 1;)
+        ++msb;
+      std::size_t shift = msb - SUB_BUCKET_BITS;
+      return (shift + 1) * SUB_BUCKETS + static_cast<std::size_t>((value >> shift) & (SUB_BUCKETS - 1));
+    }
+
+    static uint64_t lower_bound_of(std::size_t bucket) noexcept
+    {
+      if (bucket < SUB_BUCKETS)
+        return bucket;
+      std::size_t shift = bucket / SUB_BUCKETS - 1;
+      return (SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+    }
+
+  private:
+    std::atomic<uint64_t> buckets_[BUCKET_COUNT] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+  };
+
+  /**
+   * @brief The sampled wait and hold times of one named mutex.
+   *
+   * `wait` covers every sampled acquisition in any mode, including upgrades
+   * to exclusive; `hold` covers sampled exclusive holds.
+   */
+  struct lock_profile
+  {
+    explicit lock_profile(std::string lock_name) : name(std::move(lock_name)) {}
+
+    const std::string name;
+    log_histogram wait;
+    log_histogram hold;
+  };
+
+  /**
+   * @brief One row of a contention report.
+   */
+  struct lock_report_entry
+  {
+    std::string name;
+    uint64_t samples = 0;
+    uint64_t estimated_wait_ns = 0; // Sampled total wait, scaled by the sample rate
+    uint64_t wait_p50_ns = 0;
+    uint64_t wait_p99_ns = 0;
+    uint64_t wait_max_ns = 0;
+    uint64_t hold_p50_ns = 0;
+    uint64_t hold_p99_ns = 0;
+    uint64_t hold_max_ns = 0;
+  };
+
+  /**
+   * @class lock_registry
+   * @brief A table of named mutexes and their sampled wait/hold histograms.
+   *
+   * profiled_mutex registers itself here on construction and unregisters on
+   * destruction. Only 1 in sample_rate() acquisitions per thread is timed, so
+   * the cost for the rest is one thread-local increment. report() ranks the
+   * registered locks by estimated total wait time, answering "which lock is
+   * eating p99" without a profiler.
+   */
+  class lock_registry
+  {
+  public:
+    static constexpr uint32_t default_sample_rate = 64;
+
+    explicit lock_registry(uint32_t sample_rate = default_sample_rate) : sample_rate_(std::max(sample_rate, 1u)) {}
+
+    lock_registry(const lock_registry &) = delete;
+    lock_registry &operator=(const lock_registry &) = delete;
+
+    // The process-wide registry used by default.
+    static lock_registry &global()
+    {
+      static lock_registry registry;
+      return registry;
+    }
+
+    // Time 1 in `rate` acquisitions (1 times them all).
+    void set_sample_rate(uint32_t rate) noexcept { sample_rate_.store(std::max(rate, 1u), std::memory_order_relaxed); }
+    uint32_t sample_rate() const noexcept { return sample_rate_.load(std::memory_order_relaxed); }
+
+    // Whether the calling thread should time its current acquisition.
+    bool should_sample() const noexcept
+    {
+      thread_local uint32_t counter = 0;
+      return ++counter % sample_rate() == 0;
+    }
+
+    // Adds a profile. The pointer stays valid until unregister_lock().
+    lock_profile *register_lock(std::string name)
+    {
+      auto profile = std::make_unique<lock_profile>(std::move(name));
+      lock_profile *raw = profile.get();
+      std::lock_guard<std::mutex> lock(mutex_);
+      profiles_.push_back(std::move(profile));
+      return raw;
+    }
+
+    void unregister_lock(lock_profile *profile)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = std::find_if(profiles_.begin(), profiles_.end(), [&](const auto &p)
+                             { return p.get() == profile; });
+      if (it != profiles_.end())
+        profiles_.erase(it);
+    }
+
+    // The `top_n` locks with the largest estimated total wait, largest first.
+    std::vector<lock_report_entry> report(std::size_t top_n = 10) const
+    {
+      std::vector<lock_report_entry> rows;
+      uint64_t rate = sample_rate();
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rows.reserve(profiles_.size());
+        for (const auto &p : profiles_)
+        {
+          lock_report_entry row;
+          row.name = p->name;
+          row.samples = p->wait.count();
+          row.estimated_wait_ns = p->wait.sum() * rate;
+          row.wait_p50_ns = p->wait.percentile(0.50);
+          row.wait_p99_ns = p->wait.percentile(0.99);
+          row.wait_max_ns = p->wait.max();
+          row.hold_p50_ns = p->hold.percentile(0.50);
+          row.hold_p99_ns = p->hold.percentile(0.99);
+          row.hold_max_ns = p->hold.max();
+          rows.push_back(std::move(row));
+        }
+      }
+      std::sort(rows.begin(), rows.end(), [](const lock_report_entry &a, const lock_report_entry &b)
+                { return a.estimated_wait_ns > b.estimated_wait_ns; });
+      if (rows.size() > top_n)
+        rows.resize(top_n);
+      return rows;
+    }
+
+    void write_text_report(std::ostream &out, std::size_t top_n = 10) const
+    {
+      out << std::left << std::setw(32) << "lock" << std::right << std::setw(10) << "samples" << std::setw(14) << "est.wait(us)"
+          << std::setw(12) << "wait p50" << std::setw(12) << "wait p99" << std::setw(12) << "wait max"
+          << std::setw(12) << "hold p50" << std::setw(12) << "hold p99" << std::setw(12) << "hold max" << "  (ns)\n";
+      for (const lock_report_entry &row : report(top_n))
+      {
+        out << std::left << std::setw(32) << row.name << std::right << std::setw(10) << row.samples
+            << std::setw(14) << row.estimated_wait_ns / 1000 << std::setw(12) << row.wait_p50_ns << std::setw(12) << row.wait_p99_ns
+            << std::setw(12) << row.wait_max_ns << std::setw(12) << row.hold_p50_ns << std::setw(12) << row.hold_p99_ns
+            << std::setw(12) << row.hold_max_ns << "\n";
+      }
+    }
+
+    void write_json_report(std::ostream &out, std::size_t top_n = 10) const
+    {
+      out << "{\"sample_rate\":" << sample_rate() << ",\"locks\":[";
+      bool first = true;
+      for (const lock_report_entry &row : report(top_n))
+      {
+        out << (first ? "" : ",") << "{\"name\":";
+        write_json_string(out, row.name);
+        out << ",\"samples\":" << row.samples << ",\"estimated_wait_ns\":" << row.estimated_wait_ns
+            << ",\"wait_ns\":{\"p50\":" << row.wait_p50_ns << ",\"p99\":" << row.wait_p99_ns << ",\"max\":" << row.wait_max_ns
+            << "},\"hold_ns\":{\"p50\":" << row.hold_p50_ns << ",\"p99\":" << row.hold_p99_ns << ",\"max\":" << row.hold_max_ns << "}}";
+        first = false;
+      }
+      out << "]}\n";
+    }
+
+  private:
+    static void write_json_string(std::ostream &out, const std::string &s)
+    {
+      static const char *hex = "0123456789abcdef";
+      out << '"';
+      for (unsigned char c : s)
+      {
+        if (c == '"' || c == '\\')
+          out << '\\' << c;
+        else if (c < 0x20)
+          out << "\\u00" << hex[c >> 4] << hex[c & 15];
+        else
+          out << c;
+      }
+      out << '"';
+    }
+
+    std::atomic<uint32_t> sample_rate_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<lock_profile>> profiles_;
+  };
+
+  /**
+   * @class profiled_mutex
+   * @brief Wraps any sync_prim mutex with a name and sampled wait/hold
+   * histograms in a lock_registry.
+   *
+   * The API and lock guards match the wrapped mutex, so a profiled_mutex can
+   * replace it with a one-line change:
+   *
+   *   sync_prim::profiled_mutex<> orders_lock("orders.index");
+   *
+   * Sampled acquisitions read the clock before and after the wrapped call, so
+   * their wait includes the uncontended fast path. The registry must outlive
+   * the mutex.
+   */
+  template <typename Mutex = upgrade_mutex>
+  class profiled_mutex
+  {
+  public:
+    using mutex_type = Mutex;
+
+    explicit profiled_mutex(std::string name, lock_registry &registry = lock_registry::global())
+        : registry_(registry), profile_(registry.register_lock(std::move(name))) {}
+
+    ~profiled_mutex() { registry_.unregister_lock(profile_); }
+
+    profiled_mutex(const profiled_mutex &) = delete;
+    profiled_mutex &operator=(const profiled_mutex &) = delete;
+
+    // Exclusive locking
+    void lock();
+    void unlock();
+
+    // Shared locking
+    void lock_shared();
+    void unlock_shared() { mutex_.unlock_shared(); }
+
+    // Upgradeable locking
+    void lock_upgrade();
+    void unlock_upgrade() { mutex_.unlock_upgrade(); }
+
+    // Non-blocking acquisition (never sampled: it does not wait)
+    bool try_lock();
+    bool try_lock_shared() { return mutex_.try_lock_shared(); }
+    bool try_lock_upgrade() { return mutex_.try_lock_upgrade(); }
+
+    // Timed acquisition
+    template <typename Rep, typename Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout) { return try_lock_until(std::chrono::steady_clock::now() + timeout); }
+    template <typename Clock, typename Duration>
+    bool try_lock_until(const std::chrono::time_point<Clock, Duration> &deadline);
+    template <typename Rep, typename Period>
+    bool try_lock_shared_for(const std::chrono::duration<Rep, Period> &timeout) { return try_lock_shared_until(std::chrono::steady_clock::now() + timeout); }
+    template <typename Clock, typename Duration>
+    bool try_lock_shared_until(const std::chrono::time_point<Clock, Duration> &deadline);
+    template <typename Rep, typename Period>
+    bool try_lock_upgrade_for(const std::chrono::duration<Rep, Period> &timeout) { return try_lock_upgrade_until(std::chrono::steady_clock::now() + timeout); }
+    template <typename Clock, typename Duration>
+    bool try_lock_upgrade_until(const std::chrono::time_point<Clock, Duration> &deadline);
+
+    // Conditional escalation of a held shared lock
+    bool try_upgrade_from_shared() { return mutex_.try_upgrade_from_shared(); }
+
+    const lock_profile &profile() const noexcept { return *profile_; }
+    Mutex &native() noexcept { return mutex_; }
+
+  private:
+    template <typename>
+    friend class unique_lock;
+    template <typename>
+    friend class shared_lock;
+    template <typename>
+    friend class upgrade_lock;
+    template <typename>
+    friend class scoped_upgrade;
+
+    // --- Internal transition functions for lock guards ---
+    // Forwarded through the wrapped mutex's own guards, which adopt its locks.
+    void upgrade_to_unique();
+    bool try_upgrade_to_unique();
+    template <typename Clock, typename Duration>
+    bool try_upgrade_to_unique_until(const std::chrono::time_point<Clock, Duration> &deadline);
+    void unique_to_upgrade();
+    void unique_to_shared();
+    void scoped_upgrade_entry() { upgrade_to_unique(); }
+    void scoped_upgrade_exit() { unique_to_upgrade(); }
+    bool try_shared_to_unique();
+
+    using clock = std::chrono::steady_clock;
+
+    // --- Sampling helpers ---
+    // Runs `acquire`, timing it if this acquisition is sampled. Returns its
+    // result; `exclusive` starts a hold measurement on success.
+    template <typename Acquire>
+    bool sampled(bool exclusive, Acquire acquire);
+    void end_hold() noexcept;
+
+    static uint64_t elapsed_ns(clock::time_point since) noexcept
+    {
+      return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - since).count());
+    }
+
+    Mutex mutex_;
+    lock_registry &registry_;
+    lock_profile *profile_;
+
+    // Written by the exclusive owner only.
+    bool hold_sampled_ = false;
+    clock::time_point hold_since_{};
+  };
+
+  // --- profiled_mutex Method Implementations ---
+
+  template <typename Mutex>
+  template <typename Acquire>
+  inline bool profiled_mutex<Mutex>::sampled(bool exclusive, Acquire acquire)
+  {
+    if (!registry_.should_sample())
+    {
+      bool acquired = acquire();
+      if (acquired && exclusive)
+        hold_sampled_ = false;
+      return acquired;
+    }
+    clock::time_point start = clock::now();
+    bool acquired = acquire();
+    profile_->wait.record(elapsed_ns(start));
+    if (acquired && exclusive)
+    {
+      hold_sampled_ = true;
+      hold_since_ = clock::now();
+    }
+    return acquired;
+  }
+
+  template <typename Mutex>
+  inline void profiled_mutex<Mutex>::end_hold() noexcept
+  {
+    if (hold_sampled_)
+    {
+      profile_->hold.record(elapsed_ns(hold_since_));
+      hold_sampled_ = false;
+    }
+  }
+
+  template <typename Mutex>
+  inline void profiled_mutex<Mutex>::lock()
+  {
+    sampled(true, [this]
+            { mutex_.lock(); return true; });
+  }
+
+  template <typename Mutex>
+  inline void profiled_mutex<Mutex>::unlock()
+  {
+    end_hold();
+    mutex_.unlock();
+  }
+
+  template <typename Mutex>
+  inline void profiled_mutex<Mutex>::lock_shared()
+  {
+    sampled(false, [this]
+            { mutex_.lock_shared(); return true; });
+  }
+
+  template <typename Mutex>
+  inline void profiled_mutex<Mutex>::lock_upgrade()
+  {
+    sampled(false, [this]
+            { mutex_.lock_upgrade(); return true; });
+  }
+
+  template <typename Mutex>
+  inline bool profiled_mutex<Mutex>::try_lock()
+  {
+    if (!mutex_.try_lock())
+      return false;
+    hold_sampled_ = false;
+    return true;
+  }
+
+  template <typename Mutex>
+  template <typename Clock, typename Duration>
+  inline bool profiled_mutex<Mutex>::try_lock_until(const std::chrono::time_point<Clock, Duration> &deadline)
+  {
+    return sampled(true, [&]
+                   { return mutex_.try_lock_until(deadline); });
+  }
+
+  template <typename Mutex>
+  template <typename Clock, typename Duration>
+  inline bool profiled_mutex<Mutex>::try_lock_shared_until(const std::chrono::time_point<Clock, Duration> &deadline)
+  {
+    return sampled(false, [&]
+                   { return mutex_.try_lock_shared_until(deadline); });
+  }
+
+  template <typename Mutex>
+  template <typename Clock, typename Duration>
+  inline bool profiled_mutex<Mutex>::try_lock_upgrade_until(const std::chrono::time_point<Clock, Duration> &deadline)
+  {
+    return sampled(false, [&]
+                   { return mutex_.try_lock_upgrade_until(deadline); });
+  }
+
+  template <typename Mutex>
+  inline void profiled_mutex<Mutex>::upgrade_to_unique()
+  {
+    sampled(true, [this]
+            {
+      upgrade_lock<Mutex> u_lock(mutex_, std::adopt_lock);
+      unique_lock<Mutex> x_lock(std::move(u_lock));
+      x_lock.release();
+      return true; });
+  }
+
+  template <typename Mutex>
+  inline bool profiled_mutex<Mutex>::try_upgrade_to_unique()
+  {
+    upgrade_lock<Mutex> u_lock(mutex_, std::adopt_lock);
+    unique_lock<Mutex> x_lock(std::move(u_lock), std::try_to_lock);
+    if (!x_lock.owns_lock())
+    {
+      u_lock.release(); // Still upgradeable
+      return false;
+    }
+    x_lock.release();
+    hold_sampled_ = false;
+    return true;
+  }
+
+  template <typename Mutex>
+  template <typename Clock, typename Duration>
+  inline bool profiled_mutex<Mutex>::try_upgrade_to_unique_until(const std::chrono::time_point<Clock, Duration> &deadline)
+  {
+    return sampled(true, [&]
+                   {
+      upgrade_lock<Mutex> u_lock(mutex_, std::adopt_lock);
+      unique_lock<Mutex> x_lock(std::move(u_lock), deadline);
+      if (!x_lock.owns_lock())
+      {
+        u_lock.release();
+        return false;
+      }
+      x_lock.release();
+      return true; });
+  }
+
+  template <typename Mutex>
+  inline bool profiled_mutex<Mutex>::try_shared_to_unique()
+  {
+    shared_lock<Mutex> s_lock(mutex_, std::adopt_lock);
+    unique_lock<Mutex> x_lock(std::move(s_lock), std::try_to_lock);
+    if (!x_lock.owns_lock())
+    {
+      s_lock.release(); // Still shared
+      return false;
+    }
+    x_lock.release();
+    hold_sampled_ = false;
+    return true;
+  }
+
+  template <typename Mutex>
+  inline void profiled_mutex<Mutex>::unique_to_upgrade()
+  {
+    end_hold();
+    unique_lock<Mutex> x_lock(mutex_, std::adopt_lock);
+    upgrade_lock<Mutex> u_lock(std::move(x_lock));
+    u_lock.release();
+  }
+
+  template <typename Mutex>
+  inline void profiled_mutex<Mutex>::unique_to_shared()
+  {
+    end_hold();
+    unique_lock<Mutex> x_lock(mutex_, std::adopt_lock);
+    shared_lock<Mutex> s_lock(std::move(x_lock));
+    s_lock.release();
+  }
+
+} // namespace sync_prim
@@ -0,0 +1,105 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "sync_prim/instrumentation.hpp"
+
+namespace sync_prim
+{
+
+  /**
+   * @brief Category tag shared by the lock validation policies.
+   */
+  struct lock_validation_tag
+  {
+  };
+
+  // --- Lock Validation Policies ---
+  // With validation enabled, the mutex checks every acquisition against the
+  // locks the calling thread already holds and against a process-wide
+  // lock-order graph, and reports misuse to lock_validator::global(). The
+  // checker lives in lock_validator.hpp, so that a build without validation
+  // pulls in none of its containers or iostreams.
+
+  /**
+   * @brief No validation. Every hook is an empty inline function, so the mutex
+   * is exactly as if validation did not exist.
+   */
+  struct no_lock_validation
+  {
+    using policy_category = lock_validation_tag;
+    static constexpr bool enabled = false;
+  };
+
+  /**
+   * @brief Enables deadlock and lock-order checking; meant for debug builds.
+   *
+   * Each acquisition scans a thread-local array of held locks, and an
+   * acquisition made while holding others takes a global mutex to update the
+   * lock-order graph. Using it requires including
+   * "sync_prim/lock_validator.hpp". Defining SYNC_PRIM_LOCK_VALIDATION to 1
+   * includes it and makes this the default for every basic_upgrade_mutex.
+   */
+  struct lock_validation
+  {
+    using policy_category = lock_validation_tag;
+    static constexpr bool enabled = true;
+  };
+
+#if defined(SYNC_PRIM_LOCK_VALIDATION) && SYNC_PRIM_LOCK_VALIDATION
+  using default_lock_validation = lock_validation;
+#else
+  using default_lock_validation = no_lock_validation;
+#endif
+
+  namespace detail
+  {
+    /**
+     * @brief The hooks behind the lock_validation policy, held by the mutex
+     * as a private base so that the disabled case adds no storage. The
+     * enabled specialization is defined in lock_validator.hpp.
+     */
+    template <bool Enabled>
+    class lock_order_checker
+    {
+      static_assert(!Enabled, "the lock_validation policy requires #include \"sync_prim/lock_validator.hpp\"");
+
+    public:
+      // Names the mutex in validation reports. Does nothing without validation.
+      void set_debug_name(const char *) noexcept {}
+
+    protected:
+      void check_acquire(lock_mode) noexcept {}
+      void check_convert() noexcept {}
+      void note_acquire(lock_mode) noexcept {}
+      void note_release(lock_mode) noexcept {}
+      void note_convert(lock_mode, lock_mode) noexcept {}
+    };
+  } // namespace detail
+
+} // namespace sync_prim
+
+#if defined(SYNC_PRIM_LOCK_VALIDATION) && SYNC_PRIM_LOCK_VALIDATION
+#include "sync_prim/lock_validator.hpp"
+#endif
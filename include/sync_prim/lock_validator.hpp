@@ -0,0 +1,382 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sync_prim/lock_validation.hpp"
+
+// Locks a thread can hold at once while validation tracks them.
+#ifndef SYNC_PRIM_MAX_VALIDATED_LOCKS
+#define SYNC_PRIM_MAX_VALIDATED_LOCKS 32
+#endif
+
+namespace sync_prim
+{
+
+  enum class lock_violation_kind
+  {
+    order_cycle,         // Two locks were taken in both orders
+    double_upgrade,      // lock_upgrade() while already holding the upgrade lock
+    upgrade_from_shared, // An upgrade or exclusive request while holding a shared lock on the same mutex
+    recursive_acquire,   // Any other blocking re-acquisition of a held mutex
+    unheld_release,      // Unlocking or converting a mode this thread does not hold
+    too_many_held,       // More than SYNC_PRIM_MAX_VALIDATED_LOCKS held at once
+  };
+
+  /**
+   * @brief One detected problem. `locks` names the mutexes involved; for an
+   * order cycle it is the cycle, starting and ending with a held lock.
+   */
+  struct lock_violation
+  {
+    lock_violation_kind kind;
+    std::string message;
+    std::vector<std::string> locks;
+  };
+
+  /**
+   * @brief The process-wide lock-order graph and violation handler used by
+   * the lock_validation policy.
+   *
+   * A node is a live mutex, named by set_debug_name() or "upgrade_mutex#<id>".
+   * Acquiring B while holding A (blocking or timed) records A -> B. A new
+   * edge that closes a cycle is a potential deadlock, reported even if the
+   * two orders never actually raced. try_lock*() calls cannot deadlock, so
+   * they add no edges, but the locks they take count as held.
+   *
+   * The default handler prints the violation to std::cerr and aborts. A
+   * handler may instead log, or throw; violations found before acquiring are
+   * reported before the mutex is touched.
+   */
+  class lock_validator
+  {
+  public:
+    using handler_type = std::function<void(const lock_violation &)>;
+
+    static lock_validator &global()
+    {
+      static lock_validator validator;
+      return validator;
+    }
+
+    // An empty handler restores the default.
+    void set_handler(handler_type handler)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      handler_ = std::move(handler);
+    }
+
+    // Forgets every recorded order, e.g. between test cases.
+    void clear_order()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (auto &entry : nodes_)
+        entry.second.after.clear();
+    }
+
+    // --- Used by detail::lock_order_checker ---
+    uint64_t register_lock()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      uint64_t id = ++last_id_;
+      nodes_[id].name = "upgrade_mutex#" + std::to_string(id);
+      return id;
+    }
+
+    void unregister_lock(uint64_t id)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      nodes_.erase(id);
+      for (auto &entry : nodes_)
+      {
+        std::vector<uint64_t> &after = entry.second.after;
+        after.erase(std::remove(after.begin(), after.end(), id), after.end());
+      }
+    }
+
+    void set_name(uint64_t id, std::string name)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      nodes_[id].name = std::move(name);
+    }
+
+    std::string name(uint64_t id) const
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = nodes_.find(id);
+      return it == nodes_.end() ? "upgrade_mutex#" + std::to_string(id) : it->second.name;
+    }
+
+    // Records held[i] -> target for every held lock. Returns false, with the
+    // first cycle found in `violation`, if an edge closes one.
+    bool add_order(const uint64_t *held, std::size_t count, uint64_t target, lock_violation &violation)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        auto held_node = nodes_.find(held[i]);
+        if (held[i] == target || held_node == nodes_.end())
+          continue;
+        std::vector<uint64_t> &after = held_node->second.after;
+        if (std::find(after.begin(), after.end(), target) != after.end())
+          continue;
+        std::vector<uint64_t> path;
+        if (find_path(target, held[i], path))
+        {
+          violation.kind = lock_violation_kind::order_cycle;
+          violation.locks.push_back(held_node->second.name);
+          for (uint64_t id : path)
+            violation.locks.push_back(nodes_[id].name);
+          violation.message = "lock order inversion: acquiring \"" + nodes_[target].name + "\" while holding \"" +
+                              held_node->second.name + "\", but the opposite order was seen before (cycle: ";
+          for (std::size_t n = 0; n < violation.locks.size(); ++n)
+            violation.message += (n ? " -> " : "") + violation.locks[n];
+          violation.message += ")";
+          return false;
+        }
+        after.push_back(target);
+      }
+      return true;
+    }
+
+    void report(const lock_violation &violation)
+    {
+      handler_type handler;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        handler = handler_;
+      }
+      if (handler)
+      {
+        handler(violation);
+        return;
+      }
+      std::cerr << "sync_prim: " << violation.message << std::endl;
+      std::abort();
+    }
+
+  private:
+    struct node
+    {
+      std::string name;
+      std::vector<uint64_t> after; // Locks acquired while holding this one
+    };
+
+    // Depth-first search; `path` receives from..to on success.
+    bool find_path(uint64_t from, uint64_t to, std::vector<uint64_t> &path)
+    {
+      std::vector<uint64_t> visited;
+      return visit(from, to, path, visited);
+    }
+
+    bool visit(uint64_t at, uint64_t to, std::vector<uint64_t> &path, std::vector<uint64_t> &visited)
+    {
+      if (std::find(visited.begin(), visited.end(), at) != visited.end())
+        return false;
+      visited.push_back(at);
+      path.push_back(at);
+      if (at == to)
+        return true;
+      auto it = nodes_.find(at);
+      if (it != nodes_.end())
+      {
+        for (uint64_t next : it->second.after)
+          if (visit(next, to, path, visited))
+            return true;
+      }
+      path.pop_back();
+      return false;
+    }
+
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, node> nodes_;
+    uint64_t last_id_ = 0;
+    handler_type handler_;
+  };
+
+  namespace detail
+  {
+    inline const char *lock_mode_name(lock_mode mode) noexcept
+    {
+      switch (mode)
+      {
+      case lock_mode::shared:
+        return "shared";
+      case lock_mode::upgrade:
+        return "upgrade";
+      default:
+        return "exclusive";
+      }
+    }
+
+    // The locks the calling thread holds, in acquisition order.
+    struct held_locks
+    {
+      struct entry
+      {
+        uint64_t id;
+        lock_mode mode;
+      };
+
+      entry locks[SYNC_PRIM_MAX_VALIDATED_LOCKS];
+      std::size_t count = 0;
+
+      static held_locks &mine() noexcept
+      {
+        thread_local held_locks held;
+        return held;
+      }
+
+      // The most recent entry for `id` in `mode` (any mode if null), or null.
+      entry *find(uint64_t id, const lock_mode *mode = nullptr) noexcept
+      {
+        for (std::size_t i = count; i-- > 0;)
+          if (locks[i].id == id && (!mode || locks[i].mode == *mode))
+            return &locks[i];
+        return nullptr;
+      }
+    };
+
+    template <>
+    class lock_order_checker<true>
+    {
+    public:
+      void set_debug_name(const char *name) { lock_validator::global().set_name(id_, name); }
+
+    protected:
+      lock_order_checker() : id_(lock_validator::global().register_lock()) {}
+      ~lock_order_checker() { lock_validator::global().unregister_lock(id_); }
+
+      lock_order_checker(const lock_order_checker &) = delete;
+      lock_order_checker &operator=(const lock_order_checker &) = delete;
+
+      // Before a blocking or timed acquisition in `mode`.
+      void check_acquire(lock_mode mode)
+      {
+        held_locks &held = held_locks::mine();
+        if (const held_locks::entry *mine = held.find(id_))
+        {
+          if (mine->mode == lock_mode::upgrade && mode == lock_mode::upgrade)
+            fail(lock_violation_kind::double_upgrade, "double upgrade: lock_upgrade() on \"" + name() + "\", whose upgrade lock this thread already holds");
+          else if (mine->mode == lock_mode::shared && mode != lock_mode::shared)
+            fail(lock_violation_kind::upgrade_from_shared, std::string("upgrade from shared: ") + lock_mode_name(mode) + " lock on \"" + name() +
+                                                               "\" requested while this thread holds it shared");
+          else
+            fail(lock_violation_kind::recursive_acquire, std::string("recursive acquisition: ") + lock_mode_name(mode) + " lock on \"" + name() +
+                                                             "\" requested while this thread holds it " + lock_mode_name(mine->mode));
+          return;
+        }
+        check_order(held);
+      }
+
+      // Before a blocking or timed upgrade-to-exclusive conversion. It waits
+      // for readers, so it is ordered after every other lock held.
+      void check_convert()
+      {
+        held_locks &held = held_locks::mine();
+        const lock_mode upgrade = lock_mode::upgrade, shared = lock_mode::shared;
+        if (!held.find(id_, &upgrade))
+          fail(lock_violation_kind::unheld_release, "upgrade to exclusive on \"" + name() + "\" without holding its upgrade lock");
+        else if (held.find(id_, &shared))
+          fail(lock_violation_kind::upgrade_from_shared, "upgrade to exclusive on \"" + name() + "\" waits for this thread's own shared lock");
+        else
+          check_order(held);
+      }
+
+      void note_acquire(lock_mode mode)
+      {
+        held_locks &held = held_locks::mine();
+        if (held.count == SYNC_PRIM_MAX_VALIDATED_LOCKS)
+        {
+          fail(lock_violation_kind::too_many_held, "too many locks held at once (SYNC_PRIM_MAX_VALIDATED_LOCKS is " +
+                                                       std::to_string(SYNC_PRIM_MAX_VALIDATED_LOCKS) + "); \"" + name() + "\" is not tracked");
+          return;
+        }
+        held.locks[held.count++] = {id_, mode};
+      }
+
+      void note_release(lock_mode mode)
+      {
+        held_locks &held = held_locks::mine();
+        held_locks::entry *entry = held.find(id_, &mode);
+        if (!entry)
+        {
+          fail(lock_violation_kind::unheld_release, std::string("release of a ") + lock_mode_name(mode) + " lock on \"" + name() +
+                                                        "\" that this thread does not hold");
+          return;
+        }
+        std::copy(entry + 1, held.locks + held.count, entry);
+        --held.count;
+      }
+
+      void note_convert(lock_mode from, lock_mode to)
+      {
+        held_locks::entry *entry = held_locks::mine().find(id_, &from);
+        if (!entry)
+        {
+          fail(lock_violation_kind::unheld_release, std::string(lock_mode_name(from)) + " to " + lock_mode_name(to) + " transition on \"" + name() +
+                                                        "\" without holding it " + lock_mode_name(from));
+          return;
+        }
+        entry->mode = to;
+      }
+
+    private:
+      void check_order(const held_locks &held)
+      {
+        if (held.count == 0)
+          return;
+        uint64_t ids[SYNC_PRIM_MAX_VALIDATED_LOCKS];
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < held.count; ++i)
+          ids[count++] = held.locks[i].id;
+        lock_violation violation;
+        if (!lock_validator::global().add_order(ids, count, id_, violation))
+          lock_validator::global().report(violation);
+      }
+
+      void fail(lock_violation_kind kind, std::string message)
+      {
+        lock_violation violation{kind, std::move(message), {name()}};
+        lock_validator::global().report(violation);
+      }
+
+      std::string name() const { return lock_validator::global().name(id_); }
+
+      uint64_t id_;
+    };
+  } // namespace detail
+
+} // namespace sync_prim
@@ -0,0 +1,493 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+#include "sync_prim/cache_line.hpp"
+#include "sync_prim/distributed_upgrade_mutex.hpp"
+#include "sync_prim/upgrade_mutex.hpp"
+
+namespace sync_prim
+{
+
+  namespace detail
+  {
+    /**
+     * @brief The NUMA node of the CPU the calling thread is running on, or 0
+     * where the platform cannot tell.
+     */
+    inline std::size_t current_numa_node() noexcept
+    {
+#if defined(__linux__) && defined(SYS_getcpu)
+      unsigned cpu = 0, node = 0;
+      if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+        return node;
+      return 0;
+#elif defined(_WIN32)
+      PROCESSOR_NUMBER processor;
+      GetCurrentProcessorNumberEx(&processor);
+      USHORT node = 0;
+      if (GetNumaProcessorNodeEx(&processor, &node))
+        return node;
+      return 0;
+#else
+      return 0;
+#endif
+    }
+
+    /**
+     * @brief The NUMA node the calling thread first ran a numa_upgrade_mutex
+     * operation on.
+     *
+     * Like reader_slot_hint(), the value is fixed for the thread's lifetime, so
+     * an unlock always finds the counters its lock used. Threads that care
+     * about locality should be pinned before they first touch the mutex.
+     */
+    inline std::size_t numa_node_hint() noexcept
+    {
+      thread_local std::size_t node = current_numa_node();
+      return node;
+    }
+  } // namespace detail
+
+  /**
+   * @brief Reader slot policy that counts each thread's reads on its NUMA node.
+   */
+  struct numa_node_slots
+  {
+    using policy_category = reader_slot_tag;
+    static std::size_t slot_hint() noexcept { return detail::numa_node_hint(); }
+  };
+
+  /**
+   * @class numa_upgrade_mutex
+   * @brief A NUMA-aware cohort variant of upgrade_mutex.
+   *
+   * A global arbiter, a distributed_upgrade_mutex with one reader slot per
+   * node, decides between readers, the upgrader and writers. Readers only
+   * touch their node's slot. Writers first take their node's local lock; the
+   * first writer of a cohort then takes the global exclusive lock, and on
+   * unlock passes both to the next writer waiting on the same node, so the
+   * lock's cache lines stay on one socket. After `batch_limit` consecutive
+   * local passes the global lock is released anyway, so other nodes and
+   * readers are not starved.
+   *
+   * Threads stay on the node (and slot) they first used the mutex from; pin
+   * them before first use. Nodes beyond NodeCount share counters with lower
+   * ones modulo NodeCount. The API and lock guards match basic_upgrade_mutex.
+   * Policies: a wait policy and a park backend, used by the arbiter and the
+   * local locks alike.
+   */
+  template <std::size_t NodeCount = 4, typename... Policies>
+  class numa_upgrade_mutex
+  {
+  public:
+    static_assert(NodeCount > 0, "numa_upgrade_mutex needs at least one node");
+
+    using wait_policy = detail::select_policy_t<wait_policy_tag, spin_then_park, Policies...>;
+    using park_backend = detail::select_policy_t<park_backend_tag, condvar_backend, Policies...>;
+    using global_mutex = distributed_upgrade_mutex<NodeCount, numa_node_slots, wait_policy, park_backend>;
+    using local_mutex = basic_upgrade_mutex<wait_policy, park_backend>;
+
+    static constexpr uint32_t default_batch_limit = 64;
+
+    explicit numa_upgrade_mutex(uint32_t batch_limit = default_batch_limit) : batch_limit_(batch_limit) {}
+
+    numa_upgrade_mutex(const numa_upgrade_mutex &) = delete;
+    numa_upgrade_mutex &operator=(const numa_upgrade_mutex &) = delete;
+
+    // Exclusive locking
+    void lock();
+    void unlock();
+
+    // Shared locking
+    void lock_shared();
+    void unlock_shared();
+
+    // Upgradeable locking
+    void lock_upgrade();
+    void unlock_upgrade();
+
+    // Non-blocking acquisition
+    bool try_lock();
+    bool try_lock_shared();
+    bool try_lock_upgrade();
+
+    // Timed acquisition. Timed writers never receive a cohort pass (they might
+    // give up and leave the node owning the global lock), but may still pass
+    // it on when they unlock.
+    template <typename Rep, typename Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout);
+    template <typename Clock, typename Duration>
+    bool try_lock_until(const std::chrono::time_point<Clock, Duration> &deadline);
+    template <typename Rep, typename Period>
+    bool try_lock_shared_for(const std::chrono::duration<Rep, Period> &timeout);
+    template <typename Clock, typename Duration>
+    bool try_lock_shared_until(const std::chrono::time_point<Clock, Duration> &deadline);
+    template <typename Rep, typename Period>
+    bool try_lock_upgrade_for(const std::chrono::duration<Rep, Period> &timeout);
+    template <typename Clock, typename Duration>
+    bool try_lock_upgrade_until(const std::chrono::time_point<Clock, Duration> &deadline);
+
+    // Conditional escalation of a held shared lock; readers and the upgrader
+    // only ever touch the arbiter.
+    bool try_upgrade_from_shared() { return global_.try_upgrade_from_shared(); }
+
+  private:
+    template <typename>
+    friend class unique_lock;
+    template <typename>
+    friend class shared_lock;
+    template <typename>
+    friend class upgrade_lock;
+    template <typename>
+    friend class scoped_upgrade;
+
+    // --- Internal transition functions for lock guards ---
+    void upgrade_to_unique();
+    bool try_upgrade_to_unique();
+    template <typename Clock, typename Duration>
+    bool try_upgrade_to_unique_until(const std::chrono::time_point<Clock, Duration> &deadline);
+    void unique_to_upgrade();
+    void unique_to_shared();
+    void scoped_upgrade_entry();
+    void scoped_upgrade_exit();
+    bool try_shared_to_unique();
+
+    // Per-node writer state, one cache line (or more) per node.
+    struct alignas(cache_line_size) cohort
+    {
+      local_mutex local;
+      // Untimed lock() callers of this node waiting for, or holding, `local`.
+      std::atomic<uint32_t> waiting{0};
+      // Guarded by `local`: the cohort holds the global exclusive lock, and
+      // how many times it has been passed on within the cohort.
+      bool owns_global = false;
+      uint32_t passes = 0;
+    };
+
+    // --- Helpers ---
+    cohort &my_cohort() noexcept;
+    void acquire_global_for_cohort(cohort &c);
+    void leave_cohort();
+
+    // --- Synchronization Primitives ---
+    global_mutex global_;
+    cohort cohorts_[NodeCount];
+    const uint32_t batch_limit_;
+
+    // Written by the exclusive owner only: the cohort it came through, or
+    // nullptr if it got exclusive access by upgrading.
+    cohort *owner_ = nullptr;
+  };
+
+  // --- numa_upgrade_mutex Method Implementations ---
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline void numa_upgrade_mutex<NodeCount, Policies...>::lock()
+  {
+    cohort &c = my_cohort();
+    c.waiting.fetch_add(1, std::memory_order_relaxed);
+    c.local.lock();
+    c.waiting.fetch_sub(1, std::memory_order_relaxed);
+    acquire_global_for_cohort(c);
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline void numa_upgrade_mutex<NodeCount, Policies...>::unlock()
+  {
+    cohort *c = owner_;
+    owner_ = nullptr;
+    if (!c)
+    {
+      global_.unlock(); // Exclusive access came from an upgrade
+      return;
+    }
+
+    // Pass within the node while a local lock() caller is waiting for it.
+    // Such a caller always goes on to take `local`, and with it the global
+    // lock we leave behind.
+    if (c->waiting.load(std::memory_order_relaxed) != 0 && ++c->passes < batch_limit_)
+    {
+      c->local.unlock();
+      return;
+    }
+    c->owns_global = false;
+    global_.unlock();
+    c->local.unlock();
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline void numa_upgrade_mutex<NodeCount, Policies...>::lock_shared()
+  {
+    global_.lock_shared();
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline void numa_upgrade_mutex<NodeCount, Policies...>::unlock_shared()
+  {
+    global_.unlock_shared();
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline void numa_upgrade_mutex<NodeCount, Policies...>::lock_upgrade()
+  {
+    global_.lock_upgrade();
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline void numa_upgrade_mutex<NodeCount, Policies...>::unlock_upgrade()
+  {
+    global_.unlock_upgrade();
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline bool numa_upgrade_mutex<NodeCount, Policies...>::try_lock()
+  {
+    cohort &c = my_cohort();
+    if (!c.local.try_lock())
+      return false;
+    if (!c.owns_global)
+    {
+      if (!global_.try_lock())
+      {
+        c.local.unlock();
+        return false;
+      }
+      c.owns_global = true;
+      c.passes = 0;
+    }
+    owner_ = &c;
+    return true;
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline bool numa_upgrade_mutex<NodeCount, Policies...>::try_lock_shared()
+  {
+    return global_.try_lock_shared();
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline bool numa_upgrade_mutex<NodeCount, Policies...>::try_lock_upgrade()
+  {
+    return global_.try_lock_upgrade();
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  template <typename Rep, typename Period>
+  inline bool numa_upgrade_mutex<NodeCount, Policies...>::try_lock_for(const std::chrono::duration<Rep, Period> &timeout)
+  {
+    return try_lock_until(std::chrono::steady_clock::now() + timeout);
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  template <typename Clock, typename Duration>
+  inline bool numa_upgrade_mutex<NodeCount, Policies...>::try_lock_until(const std::chrono::time_point<Clock, Duration> &deadline)
+  {
+    cohort &c = my_cohort();
+    if (!c.local.try_lock_until(deadline))
+      return false;
+    if (!c.owns_global)
+    {
+      if (!global_.try_lock_until(deadline))
+      {
+        c.local.unlock();
+        return false;
+      }
+      c.owns_global = true;
+      c.passes = 0;
+    }
+    owner_ = &c;
+    return true;
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  template <typename Rep, typename Period>
+  inline bool numa_upgrade_mutex<NodeCount, Policies...>::try_lock_shared_for(const std::chrono::duration<Rep, Period> &timeout)
+  {
+    return global_.try_lock_shared_for(timeout);
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  template <typename Clock, typename Duration>
+  inline bool numa_upgrade_mutex<NodeCount, Policies...>::try_lock_shared_until(const std::chrono::time_point<Clock, Duration> &deadline)
+  {
+    return global_.try_lock_shared_until(deadline);
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  template <typename Rep, typename Period>
+  inline bool numa_upgrade_mutex<NodeCount, Policies...>::try_lock_upgrade_for(const std::chrono::duration<Rep, Period> &timeout)
+  {
+    return global_.try_lock_upgrade_for(timeout);
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  template <typename Clock, typename Duration>
+  inline bool numa_upgrade_mutex<NodeCount, Policies...>::try_lock_upgrade_until(const std::chrono::time_point<Clock, Duration> &deadline)
+  {
+    return global_.try_lock_upgrade_until(deadline);
+  }
+
+  // --- Internal Transition Method Implementations ---
+  // The upgrader and downgraded writers hold the arbiter directly. The
+  // transitions go through the arbiter's own guards, which adopt its locks.
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline void numa_upgrade_mutex<NodeCount, Policies...>::upgrade_to_unique()
+  {
+    upgrade_lock<global_mutex> u_lock(global_, std::adopt_lock);
+    unique_lock<global_mutex> x_lock(std::move(u_lock));
+    x_lock.release();
+    owner_ = nullptr;
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline bool numa_upgrade_mutex<NodeCount, Policies...>::try_upgrade_to_unique()
+  {
+    upgrade_lock<global_mutex> u_lock(global_, std::adopt_lock);
+    unique_lock<global_mutex> x_lock(std::move(u_lock), std::try_to_lock);
+    if (!x_lock.owns_lock())
+    {
+      u_lock.release(); // Still upgradeable
+      return false;
+    }
+    x_lock.release();
+    owner_ = nullptr;
+    return true;
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  template <typename Clock, typename Duration>
+  inline bool numa_upgrade_mutex<NodeCount, Policies...>::try_upgrade_to_unique_until(const std::chrono::time_point<Clock, Duration> &deadline)
+  {
+    upgrade_lock<global_mutex> u_lock(global_, std::adopt_lock);
+    unique_lock<global_mutex> x_lock(std::move(u_lock), deadline);
+    if (!x_lock.owns_lock())
+    {
+      u_lock.release();
+      return false;
+    }
+    x_lock.release();
+    owner_ = nullptr;
+    return true;
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline bool numa_upgrade_mutex<NodeCount, Policies...>::try_shared_to_unique()
+  {
+    shared_lock<global_mutex> s_lock(global_, std::adopt_lock);
+    unique_lock<global_mutex> x_lock(std::move(s_lock), std::try_to_lock);
+    if (!x_lock.owns_lock())
+    {
+      s_lock.release(); // Still shared
+      return false;
+    }
+    x_lock.release();
+    owner_ = nullptr;
+    return true;
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline void numa_upgrade_mutex<NodeCount, Policies...>::unique_to_upgrade()
+  {
+    leave_cohort();
+    unique_lock<global_mutex> x_lock(global_, std::adopt_lock);
+    upgrade_lock<global_mutex> u_lock(std::move(x_lock));
+    u_lock.release();
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline void numa_upgrade_mutex<NodeCount, Policies...>::unique_to_shared()
+  {
+    leave_cohort();
+    unique_lock<global_mutex> x_lock(global_, std::adopt_lock);
+    shared_lock<global_mutex> s_lock(std::move(x_lock));
+    s_lock.release();
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline void numa_upgrade_mutex<NodeCount, Policies...>::scoped_upgrade_entry()
+  {
+    upgrade_to_unique();
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline void numa_upgrade_mutex<NodeCount, Policies...>::scoped_upgrade_exit()
+  {
+    unique_to_upgrade();
+  }
+
+  // --- Helpers ---
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline typename numa_upgrade_mutex<NodeCount, Policies...>::cohort &numa_upgrade_mutex<NodeCount, Policies...>::my_cohort() noexcept
+  {
+    return cohorts_[detail::numa_node_hint() % NodeCount];
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline void numa_upgrade_mutex<NodeCount, Policies...>::acquire_global_for_cohort(cohort &c)
+  {
+    // With `local` held: unless a cohort peer passed it to us, take the global
+    // exclusive lock and start a new batch.
+    if (!c.owns_global)
+    {
+      global_.lock();
+      c.owns_global = true;
+      c.passes = 0;
+    }
+    owner_ = &c;
+  }
+
+  template <std::size_t NodeCount, typename... Policies>
+  inline void numa_upgrade_mutex<NodeCount, Policies...>::leave_cohort()
+  {
+    // A downgrading writer keeps its arbiter lock in a weaker mode, so it
+    // cannot pass it to the cohort. It leaves the cohort without it.
+    cohort *c = owner_;
+    owner_ = nullptr;
+    if (c)
+    {
+      c->owns_global = false;
+      c->local.unlock();
+    }
+  }
+
+} // namespace sync_prim
@@ -0,0 +1,97 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace sync_prim
+{
+
+  /**
+   * @brief Category tag shared by the optimistic read policies.
+   */
+  struct optimistic_read_tag
+  {
+  };
+
+  // --- Optimistic Read Policies ---
+  // With optimistic reads enabled, the mutex keeps a version counter next to
+  // its state word. Every exit from exclusive mode (unlock(), and the
+  // unique_to_upgrade() / unique_to_shared() downgrades) bumps it, so a reader
+  // can run without taking any lock and check afterwards whether a writer got
+  // in the way (see basic_upgrade_mutex::read_begin()).
+
+  /**
+   * @brief No version counter. This is the default, and costs nothing.
+   */
+  struct no_optimistic_reads
+  {
+    using policy_category = optimistic_read_tag;
+    static constexpr bool enabled = false;
+  };
+
+  /**
+   * @brief Enables read_begin() / read_validate() (sequence-lock reads).
+   *
+   * Adds a 32-bit version counter and one extra relaxed increment to every
+   * exclusive release, plus a release fence (free on x86) to every exclusive
+   * acquisition.
+   */
+  struct optimistic_reads
+  {
+    using policy_category = optimistic_read_tag;
+    static constexpr bool enabled = true;
+  };
+
+  namespace detail
+  {
+    /**
+     * @brief The version counter behind optimistic reads, held by the mutex as
+     * a private base so that the disabled case adds no storage.
+     */
+    template <bool Enabled>
+    struct sequence_counter
+    {
+      static void publish_exclusive() noexcept {}
+      void bump_version() noexcept {}
+    };
+
+    template <>
+    struct sequence_counter<true>
+    {
+      // Called right after WRITE_LOCKED_FLAG was set. Keeps the writer's data
+      // stores from becoming visible before the flag, so a reader that saw
+      // any of them also sees the flag when it validates.
+      static void publish_exclusive() noexcept { std::atomic_thread_fence(std::memory_order_release); }
+
+      // Called right before WRITE_LOCKED_FLAG is cleared with a release
+      // operation, which orders this increment before the flag change.
+      void bump_version() noexcept { version_.fetch_add(1, std::memory_order_relaxed); }
+
+      std::atomic<uint32_t> version_{0};
+    };
+  } // namespace detail
+
+} // namespace sync_prim
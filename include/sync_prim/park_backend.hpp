@@ -0,0 +1,311 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "Synchronization.lib")
+#endif
+#endif
+
+namespace sync_prim
+{
+
+  /**
+   * @brief Category tag shared by all park backends.
+   */
+  struct park_backend_tag
+  {
+  };
+
+  // --- Park Backends ---
+  // A park backend puts threads to sleep once the wait policy gives up, and
+  // wakes them again. The mutex owns the state word and tells the backend which
+  // of its two gates a thread is waiting on:
+  //   - gate 0 ("gate1"): shared and upgrade waiters, always woken all at once.
+  //   - gate 1 ("gate2"): exclusive and upgrade-to-exclusive waiters.
+  // Each gate has a waiter flag in the state word. A backend sets it before a
+  // thread sleeps, and releases only call notify() when they observe it.
+  //
+  // A backend provides:
+  //   - `park(state, gate, flag, try_acquire)`: blocks until try_acquire succeeds.
+  //   - `park_until(state, gate, flag, deadline, try_acquire)`: as park(), but
+  //     gives up at the deadline and returns whether try_acquire succeeded.
+  //   - `notify(state, gate, flag, all)`: wakes one or all threads on a gate.
+  //   - `exact_waiter_flags`: whether a set flag guarantees a parked thread,
+  //     rather than merely that one may exist.
+  //   - `supports_handoff`: whether the backend provides
+  //     `hand_off(state, gate, grant)`, which passes the caller's lock to one
+  //     thread parked on `gate` (see direct_handoff).
+  //   - `supports_wide_state`: whether the state word may be 64 bits wide
+  //     (see wide_state) rather than only 32.
+
+  /**
+   * @brief Parks threads on a std::mutex and two std::condition_variables.
+   *
+   * The waiter flags track the exact number of sleepers on each gate, so
+   * releases never signal spuriously. This is the default backend.
+   */
+  class condvar_backend
+  {
+  public:
+    using policy_category = park_backend_tag;
+    // A set waiter flag always means at least one thread is parked (or about
+    // to re-check its predicate) on that gate.
+    static constexpr bool exact_waiter_flags = true;
+    static constexpr bool supports_handoff = true;
+    static constexpr bool supports_wide_state = true;
+
+    template <typename Word, typename Predicate>
+    void park(std::atomic<Word> &state, int gate, Word flag, Predicate try_acquire)
+    {
+      std::unique_lock<std::mutex> internal_lock(internal_mutex_);
+      // Register as a sleeper before re-checking the state, so that any release
+      // which happens after our check is guaranteed to see the flag.
+      if (waiters_[gate]++ == 0)
+        state.fetch_or(flag, std::memory_order_relaxed);
+      gates_[gate].wait(internal_lock, [&]
+                        { return take_grant(gate) || try_acquire(); });
+      if (--waiters_[gate] == 0)
+        state.fetch_and(~flag, std::memory_order_relaxed);
+    }
+
+    template <typename Word, typename Clock, typename Duration, typename Predicate>
+    bool park_until(std::atomic<Word> &state, int gate, Word flag,
+                    const std::chrono::time_point<Clock, Duration> &deadline, Predicate try_acquire)
+    {
+      std::unique_lock<std::mutex> internal_lock(internal_mutex_);
+      if (waiters_[gate]++ == 0)
+        state.fetch_or(flag, std::memory_order_relaxed);
+      bool acquired = gates_[gate].wait_until(internal_lock, deadline, [&]
+                                              { return take_grant(gate) || try_acquire(); });
+      if (--waiters_[gate] == 0)
+        state.fetch_and(~flag, std::memory_order_relaxed);
+      return acquired;
+    }
+
+    template <typename Word>
+    void notify(std::atomic<Word> &, int gate, Word, bool all)
+    {
+      // Waiters re-check the state while holding internal_mutex_, so briefly taking
+      // it here closes the window between a waiter's failed check and its sleep.
+      {
+        std::lock_guard<std::mutex> internal_lock(internal_mutex_);
+      }
+      if (all)
+        gates_[gate].notify_all();
+      else
+        gates_[gate].notify_one();
+    }
+
+    // Passes the caller's lock to one thread parked on `gate`, provided one is
+    // parked there without a grant already and nobody is parked on the other
+    // gate. Runs `grant` first, under internal_mutex_, and returns whether the
+    // lock was handed over. The woken thread returns from park() owning it.
+    template <typename Word, typename Grant>
+    bool hand_off(std::atomic<Word> &, int gate, Grant grant)
+    {
+      std::lock_guard<std::mutex> internal_lock(internal_mutex_);
+      if (waiters_[gate] == grants_[gate] || waiters_[1 - gate] != 0)
+        return false;
+      grant();
+      ++grants_[gate];
+      gates_[gate].notify_one();
+      return true;
+    }
+
+  private:
+    // Called with internal_mutex_ held. Any thread parked on the gate may take
+    // a pending grant; the one notify_one() woke then simply sleeps again.
+    bool take_grant(int gate)
+    {
+      if (grants_[gate] == 0)
+        return false;
+      --grants_[gate];
+      return true;
+    }
+
+    std::mutex internal_mutex_;
+    std::condition_variable gates_[2];
+
+    // Number of threads parked on each gate. Guarded by internal_mutex_; the
+    // matching waiter flag is set exactly while the count is non-zero.
+    uint32_t waiters_[2] = {0, 0};
+
+    // Locks handed to a gate by hand_off() but not yet taken by a parked thread.
+    uint32_t grants_[2] = {0, 0};
+  };
+
+  namespace detail
+  {
+#if defined(__linux__) || defined(_WIN32) || defined(__cpp_lib_atomic_wait)
+    inline constexpr bool has_address_wait = true;
+#else
+    inline constexpr bool has_address_wait = false;
+#endif
+
+    // Sleeps while `word` still holds `expected`. May return spuriously.
+    inline void address_wait(std::atomic<uint32_t> &word, uint32_t expected, int gate)
+    {
+#if defined(__linux__)
+      syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT_BITSET_PRIVATE,
+              expected, nullptr, nullptr, 1u << gate);
+#elif defined(_WIN32)
+      (void)gate;
+      WaitOnAddress(reinterpret_cast<volatile VOID *>(&word), &expected, sizeof(expected), INFINITE);
+#elif defined(__cpp_lib_atomic_wait)
+      (void)gate;
+      word.wait(expected, std::memory_order_relaxed);
+#else
+      (void)word, (void)expected, (void)gate;
+#endif
+    }
+
+    // As address_wait(), but sleeps for at most `timeout`.
+    inline void address_wait_for(std::atomic<uint32_t> &word, uint32_t expected, int gate,
+                                 std::chrono::nanoseconds timeout)
+    {
+      // Cap the wait so that the deadline arithmetic below cannot overflow on
+      // near-infinite timeouts. Callers loop until their own deadline anyway.
+      constexpr std::chrono::nanoseconds max_wait = std::chrono::hours(24);
+      if (timeout > max_wait)
+        timeout = max_wait;
+#if defined(__linux__)
+      // FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC deadline.
+      timespec deadline;
+      clock_gettime(CLOCK_MONOTONIC, &deadline);
+      long long ns = deadline.tv_nsec + timeout.count();
+      deadline.tv_sec += static_cast<time_t>(ns / 1000000000);
+      deadline.tv_nsec = static_cast<long>(ns % 1000000000);
+      syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT_BITSET_PRIVATE,
+              expected, &deadline, nullptr, 1u << gate);
+#elif defined(_WIN32)
+      (void)gate;
+      auto ms = std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
+      WaitOnAddress(reinterpret_cast<volatile VOID *>(&word), &expected, sizeof(expected),
+                    static_cast<DWORD>(ms < 0xFFFFFFFELL ? ms : 0xFFFFFFFELL));
+#else
+      // std::atomic::wait has no timed form; poll at a coarse interval instead.
+      (void)word, (void)expected, (void)gate;
+      std::this_thread::sleep_for(timeout < std::chrono::milliseconds(1) ? timeout : std::chrono::nanoseconds(std::chrono::milliseconds(1)));
+#endif
+    }
+
+    // Wakes one or all threads sleeping on `word` for the given gate. Platforms
+    // without per-gate wake masks wake everybody; waiters always re-check.
+    inline void address_wake(std::atomic<uint32_t> &word, int gate, bool all)
+    {
+#if defined(__linux__)
+      syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE_BITSET_PRIVATE,
+              all ? INT_MAX : 1, nullptr, nullptr, 1u << gate);
+#elif defined(_WIN32)
+      (void)gate, (void)all;
+      WakeByAddressAll(reinterpret_cast<PVOID>(&word));
+#elif defined(__cpp_lib_atomic_wait)
+      (void)gate, (void)all;
+      word.notify_all();
+#else
+      (void)word, (void)gate, (void)all;
+#endif
+    }
+  } // namespace detail
+
+  /**
+   * @brief Parks threads directly on the mutex's state word (futex on Linux,
+   * WaitOnAddress on Windows, std::atomic::wait under C++20).
+   *
+   * The backend is stateless, so a mutex using it is just its 4-byte state
+   * word, and a woken thread never has to reacquire an internal lock. The
+   * waiter flags are conservative: a notify clears the gate's flag and every
+   * woken thread re-arms it before it retries, so a later release may issue a
+   * wake-up that nobody is waiting for, but never misses one.
+   */
+  class futex_backend
+  {
+  public:
+    using policy_category = park_backend_tag;
+    static constexpr bool exact_waiter_flags = false;
+    static constexpr bool supports_handoff = false;
+    // The kernel only waits on 32-bit words.
+    static constexpr bool supports_wide_state = false;
+
+    static_assert(detail::has_address_wait, "futex_backend needs Linux, Windows or C++20 std::atomic::wait");
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free,
+                  "futex_backend parks on the address of a lock-free 32-bit atomic");
+
+    template <typename Predicate>
+    void park(std::atomic<uint32_t> &state, int gate, uint32_t flag, Predicate try_acquire)
+    {
+      for (;;)
+      {
+        // Arm the flag first; if the state changes before we sleep, the
+        // kernel sees a different value and returns immediately.
+        uint32_t armed = state.fetch_or(flag, std::memory_order_relaxed) | flag;
+        if (try_acquire())
+          return;
+        detail::address_wait(state, armed, gate);
+      }
+    }
+
+    template <typename Clock, typename Duration, typename Predicate>
+    bool park_until(std::atomic<uint32_t> &state, int gate, uint32_t flag,
+                    const std::chrono::time_point<Clock, Duration> &deadline, Predicate try_acquire)
+    {
+      for (;;)
+      {
+        uint32_t armed = state.fetch_or(flag, std::memory_order_relaxed) | flag;
+        if (try_acquire())
+          return true;
+        auto remaining = deadline - Clock::now();
+        if (remaining <= remaining.zero())
+          return false;
+        detail::address_wait_for(state, armed, gate, std::chrono::duration_cast<std::chrono::nanoseconds>(remaining));
+      }
+    }
+
+    void notify(std::atomic<uint32_t> &state, int gate, uint32_t flag, bool all)
+    {
+      state.fetch_and(~flag, std::memory_order_relaxed);
+      detail::address_wake(state, gate, all);
+    }
+  };
+
+} // namespace sync_prim
@@ -0,0 +1,918 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "sync_prim/instrumentation.hpp"
+#include "sync_prim/park_backend.hpp"
+#include "sync_prim/upgrade_mutex.hpp"
+#include "sync_prim/wait_policy.hpp"
+
+/**
+ * @brief Consecutive high-priority grants a queued_upgrade_mutex makes while
+ * normal-priority waiters are queued, before it serves the normal lane once.
+ *
+ * Bounds how long background work can be starved by a steady stream of
+ * latency-critical waiters.
+ */
+#ifndef SYNC_PRIM_PRIORITY_AGING_LIMIT
+#define SYNC_PRIM_PRIORITY_AGING_LIMIT 8
+#endif
+
+namespace sync_prim
+{
+
+  /**
+   * @brief The wait lane a blocking queued_upgrade_mutex acquisition joins.
+   */
+  enum class lock_priority
+  {
+    normal, // Background work
+    high,   // Latency-critical callers
+  };
+
+  /**
+   * @brief A snapshot of an instrumented queued_upgrade_mutex's queue waits,
+   * per priority lane. Times are in nanoseconds.
+   */
+  struct queue_wait_stats
+  {
+    struct lane_stats
+    {
+      uint64_t waits = 0;       // Acquisitions that had to queue
+      uint64_t wait_ns = 0;     // Total time from enqueueing to the grant
+      uint64_t max_wait_ns = 0; // The longest single wait
+
+      uint64_t average_ns() const noexcept { return waits ? wait_ns / waits : 0; }
+    };
+
+    lane_stats normal;
+    lane_stats high;
+
+    // Normal-lane grants made because of SYNC_PRIM_PRIORITY_AGING_LIMIT, ahead
+    // of queued high-priority waiters.
+    uint64_t aged_grants = 0;
+  };
+
+  namespace detail
+  {
+    /**
+     * @brief A test-and-test-and-set spinlock for very short critical sections.
+     */
+    class spin_lock
+    {
+    public:
+      void lock() noexcept
+      {
+        for (unsigned round = 0; locked_.exchange(true, std::memory_order_acquire);)
+        {
+          while (locked_.load(std::memory_order_relaxed))
+          {
+            if (round < 6)
+              backoff(round++);
+            else
+              std::this_thread::yield();
+          }
+        }
+      }
+
+      void unlock() noexcept { locked_.store(false, std::memory_order_release); }
+
+    private:
+      std::atomic<bool> locked_{false};
+    };
+
+    /**
+     * @brief The queue-wait counters behind queued_upgrade_mutex's
+     * instrumented policy; empty, with no-op hooks, when disabled.
+     *
+     * Only waiters that queued record anything, so the fast paths are
+     * untouched either way.
+     */
+    template <bool Enabled>
+    class queue_stats_recorder
+    {
+    protected:
+      struct stamp_t
+      {
+      };
+
+      static stamp_t stamp() noexcept { return {}; }
+      void record_wait(lock_priority, stamp_t) noexcept {}
+      void record_aged_grant() noexcept {}
+    };
+
+    template <>
+    class queue_stats_recorder<true>
+    {
+    protected:
+      queue_wait_stats snapshot() const noexcept
+      {
+        queue_wait_stats out;
+        read(lanes_[0], out.normal);
+        read(lanes_[1], out.high);
+        out.aged_grants = aged_grants_.load(std::memory_order_relaxed);
+        return out;
+      }
+
+      void clear() noexcept
+      {
+        for (lane &l : lanes_)
+        {
+          l.waits.store(0, std::memory_order_relaxed);
+          l.wait_ns.store(0, std::memory_order_relaxed);
+          l.max_wait_ns.store(0, std::memory_order_relaxed);
+        }
+        aged_grants_.store(0, std::memory_order_relaxed);
+      }
+
+      using stamp_t = std::chrono::steady_clock::time_point;
+
+      static stamp_t stamp() noexcept { return std::chrono::steady_clock::now(); }
+
+      void record_wait(lock_priority priority, stamp_t since) noexcept
+      {
+        uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(stamp() - since).count());
+        lane &l = lanes_[static_cast<int>(priority)];
+        l.waits.fetch_add(1, std::memory_order_relaxed);
+        l.wait_ns.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t seen = l.max_wait_ns.load(std::memory_order_relaxed);
+        while (ns > seen && !l.max_wait_ns.compare_exchange_weak(seen, ns, std::memory_order_relaxed))
+        {
+        }
+      }
+
+      // Called under the queue lock.
+      void record_aged_grant() noexcept { aged_grants_.fetch_add(1, std::memory_order_relaxed); }
+
+    private:
+      // One line per lane: its waiters record concurrently, off the fast path.
+      struct alignas(cache_line_size) lane
+      {
+        std::atomic<uint64_t> waits{0};
+        std::atomic<uint64_t> wait_ns{0};
+        std::atomic<uint64_t> max_wait_ns{0};
+      };
+
+      static void read(const lane &l, queue_wait_stats::lane_stats &out) noexcept
+      {
+        out.waits = l.waits.load(std::memory_order_relaxed);
+        out.wait_ns = l.wait_ns.load(std::memory_order_relaxed);
+        out.max_wait_ns = l.max_wait_ns.load(std::memory_order_relaxed);
+      }
+
+      lane lanes_[2];
+      std::atomic<uint64_t> aged_grants_{0};
+    };
+  } // namespace detail
+
+  /**
+   * @class queued_upgrade_mutex
+   * @brief A FIFO, queue-based variant of upgrade_mutex.
+   *
+   * Once any thread has to wait, later arrivals queue behind it instead of
+   * barging in. Each waiter spins, then parks, on a word in its own
+   * stack-allocated node. A release hands the lock directly to the waiters at
+   * the head of the queue: the next writer, or the whole run of consecutive
+   * readers (and at most one upgrader) at the head. Only those threads are
+   * woken, and they return already holding the lock, so there is no
+   * thundering herd and tail latency stays bounded as thread counts grow.
+   *
+   * As with basic_upgrade_mutex, an upgrade_to_unique() in progress blocks new
+   * readers, and the upgrader is served before anything in the queue as soon
+   * as the readers have drained.
+   *
+   * Blocking and timed acquisitions take an optional lock_priority. Waiters
+   * join one of two FIFO lanes, and a release serves the high lane first.
+   * After SYNC_PRIM_PRIORITY_AGING_LIMIT high-lane grants in a row with
+   * normal waiters present, the head of the normal lane is served once, so
+   * background work is delayed but never starved. Priority only orders the
+   * queue: an uncontended acquisition takes the fast path either way.
+   *
+   * The API and lock guards match basic_upgrade_mutex. Policies:
+   * - A wait policy (spin budget before parking on the node).
+   * - `instrumented` records per-lane queue wait times, read back through
+   *   queue_stats(). Defaults to `no_instrumentation`.
+   *
+   * Uncontended acquisition and release are a single atomic operation, as in
+   * basic_upgrade_mutex.
+   */
+  template <typename... Policies>
+  class queued_upgrade_mutex : private detail::queue_stats_recorder<detail::select_policy_t<instrumentation_tag, no_instrumentation, Policies...>::enabled>
+  {
+  public:
+    using wait_policy = detail::select_policy_t<wait_policy_tag, spin_then_park, Policies...>;
+    using instrumentation_policy = detail::select_policy_t<instrumentation_tag, no_instrumentation, Policies...>;
+
+    queued_upgrade_mutex() : state_(0) {}
+
+    queued_upgrade_mutex(const queued_upgrade_mutex &) = delete;
+    queued_upgrade_mutex &operator=(const queued_upgrade_mutex &) = delete;
+
+    // Exclusive locking
+    void lock(lock_priority priority = lock_priority::normal);
+    void unlock();
+
+    // Shared locking
+    void lock_shared(lock_priority priority = lock_priority::normal);
+    void unlock_shared();
+
+    // Upgradeable locking
+    void lock_upgrade(lock_priority priority = lock_priority::normal);
+    void unlock_upgrade();
+
+    // Non-blocking acquisition. Fails whenever another thread is queued.
+    bool try_lock();
+    bool try_lock_shared();
+    bool try_lock_upgrade();
+
+    // Timed acquisition. A timed-out waiter leaves the queue.
+    template <typename Rep, typename Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout, lock_priority priority = lock_priority::normal);
+    template <typename Clock, typename Duration>
+    bool try_lock_until(const std::chrono::time_point<Clock, Duration> &deadline, lock_priority priority = lock_priority::normal);
+    template <typename Rep, typename Period>
+    bool try_lock_shared_for(const std::chrono::duration<Rep, Period> &timeout, lock_priority priority = lock_priority::normal);
+    template <typename Clock, typename Duration>
+    bool try_lock_shared_until(const std::chrono::time_point<Clock, Duration> &deadline, lock_priority priority = lock_priority::normal);
+    template <typename Rep, typename Period>
+    bool try_lock_upgrade_for(const std::chrono::duration<Rep, Period> &timeout, lock_priority priority = lock_priority::normal);
+    template <typename Clock, typename Duration>
+    bool try_lock_upgrade_until(const std::chrono::time_point<Clock, Duration> &deadline, lock_priority priority = lock_priority::normal);
+
+    // Conditional escalation of a held shared lock to the upgrade lock. Like
+    // try_lock_upgrade(), fails whenever another thread is queued; on failure
+    // the caller keeps its shared lock.
+    bool try_upgrade_from_shared();
+
+    // Per-lane queue wait times; requires the instrumented policy. As with
+    // basic_upgrade_mutex::reset_stats(), reset at quiescent points.
+    queue_wait_stats queue_stats() const;
+    void reset_queue_stats();
+
+  private:
+    using stats_recorder = detail::queue_stats_recorder<instrumentation_policy::enabled>;
+
+    template <typename>
+    friend class unique_lock;
+    template <typename>
+    friend class shared_lock;
+    template <typename>
+    friend class upgrade_lock;
+    template <typename>
+    friend class scoped_upgrade;
+
+    // --- Internal transition functions for lock guards ---
+    void upgrade_to_unique();
+    bool try_upgrade_to_unique();
+    template <typename Clock, typename Duration>
+    bool try_upgrade_to_unique_until(const std::chrono::time_point<Clock, Duration> &deadline);
+    void unique_to_upgrade();
+    void unique_to_shared();
+    void scoped_upgrade_entry();
+    void scoped_upgrade_exit();
+    bool try_shared_to_unique();
+
+    // --- Wait queue ---
+    enum class lock_kind
+    {
+      exclusive,
+      shared,
+      upgrade,
+    };
+
+    // Node handshake: the waiter moves WAITING -> PARKED before it sleeps. The
+    // releaser moves it to GRANTED (waking the waiter if it was PARKED) and
+    // finally to DONE, after which it no longer touches the node. The waiter
+    // never returns before DONE, so the node may live on its stack.
+    static constexpr uint32_t NODE_WAITING = 0;
+    static constexpr uint32_t NODE_PARKED = 1;
+    static constexpr uint32_t NODE_GRANTED = 2;
+    static constexpr uint32_t NODE_DONE = 3;
+
+    struct wait_node
+    {
+      lock_kind kind;
+      lock_priority priority = lock_priority::normal;
+      wait_node *next = nullptr;
+      bool dequeued = false; // Guarded by queue_lock_: granted, completion may be pending
+      std::atomic<uint32_t> word{NODE_WAITING};
+    };
+
+    // --- Helpers ---
+    static bool grantable(lock_kind kind, uint32_t state);
+    static uint32_t grant(lock_kind kind, uint32_t state);
+    bool try_acquire(lock_kind kind);
+    template <typename Clock, typename Duration>
+    bool acquire_slow(lock_kind kind, lock_priority priority, const std::chrono::time_point<Clock, Duration> *deadline);
+    bool try_convert_upgrade();
+    template <typename Clock, typename Duration>
+    bool wait_for_grant(wait_node &node, const std::chrono::time_point<Clock, Duration> *deadline);
+    bool abandon(wait_node &node);
+    void dispatch();
+    struct lane;
+    lane &next_lane_locked();
+    wait_node *grant_waiters_locked();
+    static void complete_grants(wait_node *granted);
+
+    // --- State constants ---
+    // Bit 31: Exclusive write lock held
+    // Bit 30: Upgradeable lock held
+    // Bit 29: An upgrade to exclusive is pending (blocks new readers)
+    // Bit 28: The wait queue is non-empty (disables the fast paths)
+    // Bits 0-27: Count of shared readers
+    static constexpr uint32_t WRITE_LOCKED_FLAG = 1u << 31;
+    static constexpr uint32_t UPGRADE_LOCKED_FLAG = 1u << 30;
+    static constexpr uint32_t UPGRADE_PENDING_FLAG = 1u << 29;
+    static constexpr uint32_t QUEUED_FLAG = 1u << 28;
+    static constexpr uint32_t READER_COUNT_MASK = QUEUED_FLAG - 1;
+    static constexpr uint32_t ONE_READER = 1u;
+
+    // A dummy deadline type for the untimed slow paths
+    using no_deadline = std::chrono::steady_clock::time_point;
+
+    // --- Synchronization Primitives ---
+    std::atomic<uint32_t> state_;
+
+    // Guarded by queue_lock_. QUEUED_FLAG is set exactly while a lane is
+    // non-empty. high_streak_ counts high-lane grants since the normal lane
+    // was last served, while it had waiters.
+    struct lane
+    {
+      wait_node *head = nullptr;
+      wait_node *tail = nullptr;
+    };
+
+    detail::spin_lock queue_lock_;
+    lane lanes_[2]; // Indexed by lock_priority
+    uint32_t high_streak_ = 0;
+    wait_node *upgrader_ = nullptr; // A parked upgrade_to_unique(), served first
+
+    bool queue_empty_locked() const { return !lanes_[0].head && !lanes_[1].head; }
+  };
+
+  // --- queued_upgrade_mutex Method Implementations ---
+
+  template <typename... Policies>
+  inline void queued_upgrade_mutex<Policies...>::lock(lock_priority priority)
+  {
+    uint32_t expected = 0;
+    if (state_.compare_exchange_strong(expected, WRITE_LOCKED_FLAG, std::memory_order_acquire, std::memory_order_relaxed))
+      return;
+    acquire_slow<no_deadline::clock, no_deadline::duration>(lock_kind::exclusive, priority, nullptr);
+  }
+
+  template <typename... Policies>
+  inline void queued_upgrade_mutex<Policies...>::unlock()
+  {
+    uint32_t old_state = state_.fetch_sub(WRITE_LOCKED_FLAG, std::memory_order_release);
+    if (old_state & QUEUED_FLAG)
+      dispatch();
+  }
+
+  template <typename... Policies>
+  inline void queued_upgrade_mutex<Policies...>::lock_shared(lock_priority priority)
+  {
+    if (!try_acquire(lock_kind::shared))
+      acquire_slow<no_deadline::clock, no_deadline::duration>(lock_kind::shared, priority, nullptr);
+  }
+
+  template <typename... Policies>
+  inline void queued_upgrade_mutex<Policies...>::unlock_shared()
+  {
+    uint32_t old_state = state_.fetch_sub(ONE_READER, std::memory_order_release);
+    // Only the last reader can unblock a writer, an upgrader or the queue head.
+    if ((old_state & READER_COUNT_MASK) == ONE_READER && (old_state & (QUEUED_FLAG | UPGRADE_PENDING_FLAG)))
+      dispatch();
+  }
+
+  template <typename... Policies>
+  inline void queued_upgrade_mutex<Policies...>::lock_upgrade(lock_priority priority)
+  {
+    if (!try_acquire(lock_kind::upgrade))
+      acquire_slow<no_deadline::clock, no_deadline::duration>(lock_kind::upgrade, priority, nullptr);
+  }
+
+  template <typename... Policies>
+  inline void queued_upgrade_mutex<Policies...>::unlock_upgrade()
+  {
+    uint32_t old_state = state_.fetch_sub(UPGRADE_LOCKED_FLAG, std::memory_order_release);
+    if (old_state & QUEUED_FLAG)
+      dispatch();
+  }
+
+  template <typename... Policies>
+  inline bool queued_upgrade_mutex<Policies...>::try_lock()
+  {
+    return try_acquire(lock_kind::exclusive);
+  }
+
+  template <typename... Policies>
+  inline bool queued_upgrade_mutex<Policies...>::try_lock_shared()
+  {
+    return try_acquire(lock_kind::shared);
+  }
+
+  template <typename... Policies>
+  inline bool queued_upgrade_mutex<Policies...>::try_lock_upgrade()
+  {
+    return try_acquire(lock_kind::upgrade);
+  }
+
+  template <typename... Policies>
+  template <typename Rep, typename Period>
+  inline bool queued_upgrade_mutex<Policies...>::try_lock_for(const std::chrono::duration<Rep, Period> &timeout, lock_priority priority)
+  {
+    return try_lock_until(std::chrono::steady_clock::now() + timeout, priority);
+  }
+
+  template <typename... Policies>
+  template <typename Clock, typename Duration>
+  inline bool queued_upgrade_mutex<Policies...>::try_lock_until(const std::chrono::time_point<Clock, Duration> &deadline, lock_priority priority)
+  {
+    return try_acquire(lock_kind::exclusive) || acquire_slow(lock_kind::exclusive, priority, &deadline);
+  }
+
+  template <typename... Policies>
+  template <typename Rep, typename Period>
+  inline bool queued_upgrade_mutex<Policies...>::try_lock_shared_for(const std::chrono::duration<Rep, Period> &timeout, lock_priority priority)
+  {
+    return try_lock_shared_until(std::chrono::steady_clock::now() + timeout, priority);
+  }
+
+  template <typename... Policies>
+  template <typename Clock, typename Duration>
+  inline bool queued_upgrade_mutex<Policies...>::try_lock_shared_until(const std::chrono::time_point<Clock, Duration> &deadline, lock_priority priority)
+  {
+    return try_acquire(lock_kind::shared) || acquire_slow(lock_kind::shared, priority, &deadline);
+  }
+
+  template <typename... Policies>
+  template <typename Rep, typename Period>
+  inline bool queued_upgrade_mutex<Policies...>::try_lock_upgrade_for(const std::chrono::duration<Rep, Period> &timeout, lock_priority priority)
+  {
+    return try_lock_upgrade_until(std::chrono::steady_clock::now() + timeout, priority);
+  }
+
+  template <typename... Policies>
+  template <typename Clock, typename Duration>
+  inline bool queued_upgrade_mutex<Policies...>::try_lock_upgrade_until(const std::chrono::time_point<Clock, Duration> &deadline, lock_priority priority)
+  {
+    return try_acquire(lock_kind::upgrade) || acquire_slow(lock_kind::upgrade, priority, &deadline);
+  }
+
+  template <typename... Policies>
+  inline queue_wait_stats queued_upgrade_mutex<Policies...>::queue_stats() const
+  {
+    static_assert(instrumentation_policy::enabled, "queue_stats() requires the instrumented policy");
+    return stats_recorder::snapshot();
+  }
+
+  template <typename... Policies>
+  inline void queued_upgrade_mutex<Policies...>::reset_queue_stats()
+  {
+    static_assert(instrumentation_policy::enabled, "reset_queue_stats() requires the instrumented policy");
+    stats_recorder::clear();
+  }
+
+  // --- Internal Transition Method Implementations ---
+
+  template <typename... Policies>
+  inline void queued_upgrade_mutex<Policies...>::upgrade_to_unique()
+  {
+    // Block new readers (including queued ones) while the current ones drain.
+    state_.fetch_or(UPGRADE_PENDING_FLAG, std::memory_order_relaxed);
+    if (try_convert_upgrade() || wait_policy::spin_until([this]
+                                                         { return try_convert_upgrade(); }))
+      return;
+
+    wait_node node{lock_kind::exclusive};
+    queue_lock_.lock();
+    if (try_convert_upgrade())
+    {
+      queue_lock_.unlock();
+      return;
+    }
+    // The last reader to leave sees UPGRADE_PENDING_FLAG and converts for us.
+    upgrader_ = &node;
+    queue_lock_.unlock();
+    wait_for_grant<no_deadline::clock, no_deadline::duration>(node, nullptr);
+  }
+
+  template <typename... Policies>
+  inline bool queued_upgrade_mutex<Policies...>::try_upgrade_to_unique()
+  {
+    uint32_t current_state = state_.load(std::memory_order_relaxed);
+    while ((current_state & READER_COUNT_MASK) == 0)
+    {
+      if (state_.compare_exchange_weak(current_state, current_state ^ (UPGRADE_LOCKED_FLAG | WRITE_LOCKED_FLAG), std::memory_order_acquire, std::memory_order_relaxed))
+        return true;
+    }
+    return false;
+  }
+
+  template <typename... Policies>
+  inline bool queued_upgrade_mutex<Policies...>::try_upgrade_from_shared()
+  {
+    // Nobody queued means nobody waits for our reader to leave, so trading it
+    // for the upgrade flag needs no dispatch.
+    uint32_t current_state = state_.load(std::memory_order_relaxed);
+    while (!(current_state & (QUEUED_FLAG | UPGRADE_LOCKED_FLAG)))
+    {
+      if (state_.compare_exchange_weak(current_state, (current_state - ONE_READER) | UPGRADE_LOCKED_FLAG, std::memory_order_acquire, std::memory_order_relaxed))
+        return true;
+    }
+    return false;
+  }
+
+  template <typename... Policies>
+  inline bool queued_upgrade_mutex<Policies...>::try_shared_to_unique()
+  {
+    uint32_t current_state = state_.load(std::memory_order_relaxed);
+    while ((current_state & (QUEUED_FLAG | UPGRADE_LOCKED_FLAG | READER_COUNT_MASK)) == ONE_READER)
+    {
+      if (state_.compare_exchange_weak(current_state, current_state - ONE_READER + WRITE_LOCKED_FLAG, std::memory_order_acquire, std::memory_order_relaxed))
+        return true;
+    }
+    return false;
+  }
+
+  template <typename... Policies>
+  template <typename Clock, typename Duration>
+  inline bool queued_upgrade_mutex<Policies...>::try_upgrade_to_unique_until(const std::chrono::time_point<Clock, Duration> &deadline)
+  {
+    state_.fetch_or(UPGRADE_PENDING_FLAG, std::memory_order_relaxed);
+    if (try_convert_upgrade() || wait_policy::spin_until([&]
+                                                         { return try_convert_upgrade() || Clock::now() >= deadline; }))
+    {
+      if (!(state_.load(std::memory_order_relaxed) & UPGRADE_PENDING_FLAG))
+        return true; // Converted
+    }
+    else
+    {
+      wait_node node{lock_kind::exclusive};
+      queue_lock_.lock();
+      if (try_convert_upgrade())
+      {
+        queue_lock_.unlock();
+        return true;
+      }
+      upgrader_ = &node;
+      queue_lock_.unlock();
+      if (wait_for_grant(node, &deadline) || abandon(node))
+        return true;
+    }
+
+    // Timed out. Withdraw the pending flag and serve the readers it held back.
+    queue_lock_.lock();
+    if (state_.load(std::memory_order_relaxed) & WRITE_LOCKED_FLAG)
+    {
+      // Converted after all, between the last check and taking the lock.
+      queue_lock_.unlock();
+      return true;
+    }
+    state_.fetch_and(~UPGRADE_PENDING_FLAG, std::memory_order_relaxed);
+    wait_node *granted = grant_waiters_locked();
+    queue_lock_.unlock();
+    complete_grants(granted);
+    return false;
+  }
+
+  template <typename... Policies>
+  inline void queued_upgrade_mutex<Policies...>::unique_to_upgrade()
+  {
+    uint32_t old_state = state_.fetch_xor(WRITE_LOCKED_FLAG | UPGRADE_LOCKED_FLAG, std::memory_order_release);
+    // Queued readers at the head can now come in.
+    if (old_state & QUEUED_FLAG)
+      dispatch();
+  }
+
+  template <typename... Policies>
+  inline void queued_upgrade_mutex<Policies...>::unique_to_shared()
+  {
+    uint32_t old_state = state_.fetch_add(ONE_READER - WRITE_LOCKED_FLAG, std::memory_order_release);
+    if (old_state & QUEUED_FLAG)
+      dispatch();
+  }
+
+  template <typename... Policies>
+  inline void queued_upgrade_mutex<Policies...>::scoped_upgrade_entry()
+  {
+    upgrade_to_unique();
+  }
+
+  template <typename... Policies>
+  inline void queued_upgrade_mutex<Policies...>::scoped_upgrade_exit()
+  {
+    unique_to_upgrade();
+  }
+
+  // --- Helpers ---
+
+  template <typename... Policies>
+  inline bool queued_upgrade_mutex<Policies...>::grantable(lock_kind kind, uint32_t state)
+  {
+    switch (kind)
+    {
+    case lock_kind::exclusive:
+      return (state & (WRITE_LOCKED_FLAG | UPGRADE_LOCKED_FLAG | READER_COUNT_MASK)) == 0;
+    case lock_kind::shared:
+      return (state & (WRITE_LOCKED_FLAG | UPGRADE_PENDING_FLAG)) == 0;
+    default:
+      return (state & (WRITE_LOCKED_FLAG | UPGRADE_LOCKED_FLAG)) == 0;
+    }
+  }
+
+  template <typename... Policies>
+  inline uint32_t queued_upgrade_mutex<Policies...>::grant(lock_kind kind, uint32_t state)
+  {
+    switch (kind)
+    {
+    case lock_kind::exclusive:
+      return state | WRITE_LOCKED_FLAG;
+    case lock_kind::shared:
+      return state + ONE_READER;
+    default:
+      return state | UPGRADE_LOCKED_FLAG;
+    }
+  }
+
+  template <typename... Policies>
+  inline bool queued_upgrade_mutex<Policies...>::try_acquire(lock_kind kind)
+  {
+    // The fast paths only apply while nobody is queued, which keeps the order FIFO.
+    uint32_t current_state = state_.load(std::memory_order_relaxed);
+    while (!(current_state & QUEUED_FLAG) && grantable(kind, current_state))
+    {
+      if (state_.compare_exchange_weak(current_state, grant(kind, current_state), std::memory_order_acquire, std::memory_order_relaxed))
+        return true;
+    }
+    return false;
+  }
+
+  template <typename... Policies>
+  template <typename Clock, typename Duration>
+  inline bool queued_upgrade_mutex<Policies...>::acquire_slow(lock_kind kind, lock_priority priority, const std::chrono::time_point<Clock, Duration> *deadline)
+  {
+    wait_node node{kind, priority};
+    auto since = stats_recorder::stamp();
+    queue_lock_.lock();
+    // Setting QUEUED_FLAG in the same CAS that re-checks the state means any
+    // release after this point sees the flag and serves the queue.
+    uint32_t current_state = state_.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      if (!(current_state & QUEUED_FLAG) && grantable(kind, current_state))
+      {
+        if (state_.compare_exchange_weak(current_state, grant(kind, current_state), std::memory_order_acquire, std::memory_order_relaxed))
+        {
+          queue_lock_.unlock();
+          return true;
+        }
+      }
+      else if (state_.compare_exchange_weak(current_state, current_state | QUEUED_FLAG, std::memory_order_relaxed, std::memory_order_relaxed))
+        break;
+    }
+    lane &l = lanes_[static_cast<int>(priority)];
+    if (l.tail)
+      l.tail->next = &node;
+    else
+      l.head = &node;
+    l.tail = &node;
+    queue_lock_.unlock();
+
+    if (!wait_for_grant(node, deadline) && !abandon(node))
+      return false;
+    stats_recorder::record_wait(priority, since);
+    return true;
+  }
+
+  template <typename... Policies>
+  inline bool queued_upgrade_mutex<Policies...>::try_convert_upgrade()
+  {
+    // Swap the upgrade and pending flags for the write flag once readers are gone.
+    uint32_t current_state = state_.load(std::memory_order_relaxed);
+    while ((current_state & READER_COUNT_MASK) == 0)
+    {
+      uint32_t desired = (current_state & ~(UPGRADE_LOCKED_FLAG | UPGRADE_PENDING_FLAG)) | WRITE_LOCKED_FLAG;
+      if (state_.compare_exchange_weak(current_state, desired, std::memory_order_acquire, std::memory_order_relaxed))
+        return true;
+    }
+    return false;
+  }
+
+  template <typename... Policies>
+  template <typename Clock, typename Duration>
+  inline bool queued_upgrade_mutex<Policies...>::wait_for_grant(wait_node &node, const std::chrono::time_point<Clock, Duration> *deadline)
+  {
+    // Returns true once the node is DONE, or false if the deadline passed first.
+    auto granted = [&]
+    { return node.word.load(std::memory_order_acquire) >= NODE_GRANTED; };
+
+    if (!wait_policy::spin_until([&]
+                                 { return granted() || (deadline && Clock::now() >= *deadline); }))
+    {
+      uint32_t expected = NODE_WAITING;
+      if (node.word.compare_exchange_strong(expected, NODE_PARKED, std::memory_order_relaxed, std::memory_order_relaxed))
+      {
+        while (node.word.load(std::memory_order_acquire) == NODE_PARKED)
+        {
+          if (!deadline)
+            detail::address_wait(node.word, NODE_PARKED, 0);
+          else
+          {
+            auto now = Clock::now();
+            if (now >= *deadline)
+              break;
+            detail::address_wait_for(node.word, NODE_PARKED, 0,
+                                     std::chrono::duration_cast<std::chrono::nanoseconds>(*deadline - now));
+          }
+          if constexpr (!detail::has_address_wait)
+            std::this_thread::yield();
+        }
+      }
+    }
+
+    if (!granted())
+      return false;
+    while (node.word.load(std::memory_order_acquire) != NODE_DONE)
+      detail::cpu_relax();
+    return true;
+  }
+
+  template <typename... Policies>
+  inline bool queued_upgrade_mutex<Policies...>::abandon(wait_node &node)
+  {
+    // Called after a timed wait ran out. Returns true if the lock was granted
+    // in the meantime after all; otherwise unlinks the node.
+    queue_lock_.lock();
+    if (node.dequeued)
+    {
+      queue_lock_.unlock();
+      while (node.word.load(std::memory_order_acquire) != NODE_DONE)
+        detail::cpu_relax();
+      return true;
+    }
+
+    if (upgrader_ == &node)
+      upgrader_ = nullptr;
+    else
+    {
+      lane &l = lanes_[static_cast<int>(node.priority)];
+      wait_node *prev = nullptr;
+      for (wait_node *it = l.head; it != &node; it = it->next)
+        prev = it;
+      (prev ? prev->next : l.head) = node.next;
+      if (l.tail == &node)
+        l.tail = prev;
+      if (queue_empty_locked())
+        state_.fetch_and(~QUEUED_FLAG, std::memory_order_relaxed);
+    }
+
+    // If we were blocking the head of the queue, the waiters behind us may be
+    // grantable now.
+    wait_node *granted = grant_waiters_locked();
+    queue_lock_.unlock();
+    complete_grants(granted);
+    return false;
+  }
+
+  template <typename... Policies>
+  inline void queued_upgrade_mutex<Policies...>::dispatch()
+  {
+    queue_lock_.lock();
+    wait_node *granted = grant_waiters_locked();
+    queue_lock_.unlock();
+    complete_grants(granted);
+  }
+
+  template <typename... Policies>
+  inline typename queued_upgrade_mutex<Policies...>::lane &queued_upgrade_mutex<Policies...>::next_lane_locked()
+  {
+    // The high lane, unless it has been served SYNC_PRIM_PRIORITY_AGING_LIMIT
+    // times in a row while normal waiters were queued.
+    lane &high = lanes_[static_cast<int>(lock_priority::high)];
+    lane &normal = lanes_[static_cast<int>(lock_priority::normal)];
+    if (!normal.head)
+      return high;
+    if (!high.head || high_streak_ >= SYNC_PRIM_PRIORITY_AGING_LIMIT)
+      return normal;
+    return high;
+  }
+
+  template <typename... Policies>
+  inline typename queued_upgrade_mutex<Policies...>::wait_node *queued_upgrade_mutex<Policies...>::grant_waiters_locked()
+  {
+    // Decide, against the current state, which waiters at the front can have the
+    // lock, and commit all of their grants with one CAS. Readers may release
+    // concurrently (they do not take queue_lock_), in which case we recompute.
+    // Only the lane picked here is served; a head it cannot grant yet holds
+    // back the other lane as well.
+    lane &from = next_lane_locked();
+    lane &other = &from == &lanes_[0] ? lanes_[1] : lanes_[0];
+    uint32_t current_state = state_.load(std::memory_order_relaxed);
+    wait_node *first_left;
+    bool convert_upgrader;
+    uint32_t desired;
+    do
+    {
+      desired = current_state;
+      first_left = nullptr;
+      convert_upgrader = false;
+      if (upgrader_)
+      {
+        // The draining upgrader is served before anything queued.
+        if ((current_state & READER_COUNT_MASK) == 0)
+        {
+          desired = (current_state & ~(UPGRADE_LOCKED_FLAG | UPGRADE_PENDING_FLAG)) | WRITE_LOCKED_FLAG;
+          convert_upgrader = true;
+        }
+      }
+      else
+      {
+        // The next writer alone, or the run of grantable readers/upgrader.
+        first_left = from.head;
+        while (first_left && grantable(first_left->kind, desired))
+        {
+          desired = grant(first_left->kind, desired);
+          bool was_writer = first_left->kind == lock_kind::exclusive;
+          first_left = first_left->next;
+          if (was_writer)
+            break;
+        }
+        desired = (first_left || other.head) ? (desired | QUEUED_FLAG) : (desired & ~QUEUED_FLAG);
+      }
+      if (desired == current_state)
+        return nullptr;
+    } while (!state_.compare_exchange_weak(current_state, desired, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+    if (convert_upgrader)
+    {
+      wait_node *node = upgrader_;
+      upgrader_ = nullptr;
+      node->next = nullptr;
+      node->dequeued = true;
+      return node;
+    }
+
+    // Detach the granted prefix [from.head, first_left).
+    wait_node *granted = from.head == first_left ? nullptr : from.head;
+    if (granted)
+    {
+      wait_node *last = granted;
+      for (; last->next != first_left; last = last->next)
+        last->dequeued = true;
+      last->dequeued = true;
+      last->next = nullptr;
+
+      bool from_high = &from == &lanes_[static_cast<int>(lock_priority::high)];
+      if (!from_high && other.head)
+        stats_recorder::record_aged_grant();
+      high_streak_ = from_high && lanes_[static_cast<int>(lock_priority::normal)].head ? high_streak_ + 1 : 0;
+    }
+    from.head = first_left;
+    if (!from.head)
+      from.tail = nullptr;
+    return granted;
+  }
+
+  template <typename... Policies>
+  inline void queued_upgrade_mutex<Policies...>::complete_grants(wait_node *granted)
+  {
+    // Outside queue_lock_: wake the new owners, then release their nodes.
+    while (granted)
+    {
+      wait_node *next = granted->next;
+      if (granted->word.exchange(NODE_GRANTED, std::memory_order_release) == NODE_PARKED)
+        detail::address_wake(granted->word, 0, true);
+      granted->word.store(NODE_DONE, std::memory_order_release);
+      granted = next;
+    }
+  }
+
+} // namespace sync_prim
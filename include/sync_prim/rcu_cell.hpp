@@ -0,0 +1,301 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "sync_prim/cache_line.hpp"
+#include "sync_prim/upgrade_mutex.hpp"
+
+namespace sync_prim
+{
+
+  namespace detail
+  {
+    // Readers inside each of the two epoch parities, for the threads that
+    // map to this slot.
+    struct alignas(cache_line_size) rcu_reader_slot
+    {
+      std::atomic<uint32_t> active[2] = {};
+    };
+
+    // Snapshots alive on this thread, of any cell. A writer holding one would
+    // wait for itself in a grace period, so it leaves reclamation to a later
+    // writer instead.
+    inline thread_local std::size_t rcu_snapshots_held = 0;
+  } // namespace detail
+
+  template <typename T, typename Mutex, std::size_t SlotCount>
+  class rcu_cell;
+
+  /**
+   * @brief A read-only handle to one published version of an rcu_cell value.
+   *
+   * The version stays alive, and is never modified, for as long as the handle
+   * exists, however many updates are published meanwhile. Hold it briefly:
+   * while it exists, the writer cannot free versions retired after it was
+   * taken. It must not outlive its cell. A handle released on another thread
+   * than the one that read it keeps counting as held by the reading thread,
+   * whose update()s then defer reclamation to other writers.
+   */
+  template <typename T>
+  class snapshot_ptr
+  {
+  public:
+    snapshot_ptr() noexcept = default;
+    snapshot_ptr(snapshot_ptr &&other) noexcept : value_(other.value_), counter_(other.counter_), held_(other.held_)
+    {
+      other.value_ = nullptr;
+      other.counter_ = nullptr;
+      other.held_ = nullptr;
+    }
+    snapshot_ptr &operator=(snapshot_ptr &&other) noexcept
+    {
+      if (this != &other)
+      {
+        reset();
+        value_ = std::exchange(other.value_, nullptr);
+        counter_ = std::exchange(other.counter_, nullptr);
+        held_ = std::exchange(other.held_, nullptr);
+      }
+      return *this;
+    }
+    ~snapshot_ptr() { reset(); }
+
+    snapshot_ptr(const snapshot_ptr &) = delete;
+    snapshot_ptr &operator=(const snapshot_ptr &) = delete;
+
+    const T &operator*() const noexcept { return *value_; }
+    const T *operator->() const noexcept { return value_; }
+    const T *get() const noexcept { return value_; }
+    explicit operator bool() const noexcept { return value_ != nullptr; }
+
+    // Ends the read early.
+    void reset() noexcept
+    {
+      if (counter_)
+        counter_->fetch_sub(1, std::memory_order_release);
+      // The reading thread may have exited, so only its own count is touched
+      if (held_ == &detail::rcu_snapshots_held)
+        --detail::rcu_snapshots_held;
+      value_ = nullptr;
+      counter_ = nullptr;
+      held_ = nullptr;
+    }
+
+  private:
+    template <typename, typename, std::size_t>
+    friend class rcu_cell;
+
+    snapshot_ptr(const T *value, std::atomic<uint32_t> *counter) noexcept
+        : value_(value), counter_(counter), held_(&detail::rcu_snapshots_held)
+    {
+      ++detail::rcu_snapshots_held;
+    }
+
+    const T *value_ = nullptr;
+    std::atomic<uint32_t> *counter_ = nullptr;
+    std::size_t *held_ = nullptr; // The reading thread's rcu_snapshots_held
+  };
+
+  /**
+   * @class rcu_cell
+   * @brief A value read through an atomically published pointer and replaced
+   * by copy-and-publish (read-copy-update).
+   *
+   * read() is wait-free: it bumps a per-thread-slot reader count, then loads
+   * the current pointer. It never touches the mutex, and never blocks or frees
+   * memory. For config or routing tables read on every request, this is cheaper
+   * than any shared lock.
+   *
+   *   sync_prim::rcu_cell<routing_table> routes(initial);
+   *   auto table = routes.read();             // snapshot_ptr<routing_table>
+   *   route r = table->lookup(key);
+   *   routes.update([&](routing_table &t) { t.add(key, r2); });
+   *
+   * Writers serialize on the upgrade lock of `mutex()`. They copy the current
+   * version, modify the copy, and publish it inside a scoped_upgrade, so code
+   * reading under a shared_lock on `mutex()` also sees a stable value.
+   * Replaced versions are retired. Once `reclaim_batch` of them have piled up,
+   * the writer waits for a grace period (every read begun before it has
+   * ended) and frees them all at once.
+   *
+   * A writer whose own thread still holds a snapshot (`auto t = cell.read();
+   * cell.update(...)`) would wait for itself, so it skips the grace period
+   * and leaves the batch to the next writer, or to reclaim(), once the
+   * snapshot is gone.
+   */
+  template <typename T, typename Mutex = upgrade_mutex, std::size_t SlotCount = 16>
+  class rcu_cell
+  {
+  public:
+    static_assert(SlotCount > 0, "rcu_cell needs at least one reader slot");
+
+    using value_type = T;
+    using mutex_type = Mutex;
+
+    static constexpr std::size_t default_reclaim_batch = 8;
+
+    rcu_cell() : rcu_cell(T{}) {}
+    explicit rcu_cell(T initial, std::size_t reclaim_batch = default_reclaim_batch)
+        : current_(new T(std::move(initial))), reclaim_batch_(reclaim_batch ? reclaim_batch : 1) {}
+
+    // No snapshot may still exist.
+    ~rcu_cell() { delete current_.load(std::memory_order_relaxed); }
+
+    rcu_cell(const rcu_cell &) = delete;
+    rcu_cell &operator=(const rcu_cell &) = delete;
+
+    // The current version, for as long as the handle lives.
+    snapshot_ptr<T> read() const noexcept;
+
+    /**
+     * @brief Publishes a modified copy of the current version.
+     *
+     * `fn(T &copy)` runs under the upgrade lock, so concurrent readers are not
+     * blocked. If it throws, nothing is published. If the calling thread holds
+     * a snapshot, a full batch of retired versions is not freed until a later
+     * writer without one.
+     */
+    template <typename F>
+    void update(F &&fn);
+
+    // Publishes `value` as the new version. Defers reclamation as update() does.
+    void store(T value);
+
+    // Waits for a grace period and frees every retired version. Returns false,
+    // freeing nothing, if the calling thread holds a snapshot.
+    bool reclaim();
+
+    // Versions replaced but not yet freed.
+    std::size_t retired() const;
+
+    Mutex &mutex() const noexcept { return mutex_; }
+
+  private:
+    void publish(std::unique_ptr<T> next, upgrade_lock<Mutex> &lock);
+    void synchronize();
+
+    mutable Mutex mutex_;
+    alignas(cache_line_size) std::atomic<T *> current_;
+    std::atomic<uint32_t> epoch_{0};
+    mutable detail::rcu_reader_slot slots_[SlotCount];
+
+    // Guarded by the upgrade lock
+    std::vector<std::unique_ptr<T>> retired_;
+    std::size_t reclaim_batch_;
+  };
+
+  // --- rcu_cell Method Implementations ---
+
+  template <typename T, typename Mutex, std::size_t SlotCount>
+  inline snapshot_ptr<T> rcu_cell<T, Mutex, SlotCount>::read() const noexcept
+  {
+    // The pointer is loaded after the count is visible, so a writer either
+    // sees this reader or published before it: seq_cst on both sides.
+    detail::rcu_reader_slot &slot = slots_[detail::reader_slot_hint() % SlotCount];
+    std::atomic<uint32_t> &counter = slot.active[epoch_.load(std::memory_order_relaxed) & 1];
+    counter.fetch_add(1, std::memory_order_seq_cst);
+    return {current_.load(std::memory_order_seq_cst), &counter};
+  }
+
+  template <typename T, typename Mutex, std::size_t SlotCount>
+  template <typename F>
+  inline void rcu_cell<T, Mutex, SlotCount>::update(F &&fn)
+  {
+    upgrade_lock<Mutex> lock(mutex_);
+    auto next = std::make_unique<T>(*current_.load(std::memory_order_relaxed));
+    fn(*next);
+    publish(std::move(next), lock);
+  }
+
+  template <typename T, typename Mutex, std::size_t SlotCount>
+  inline void rcu_cell<T, Mutex, SlotCount>::store(T value)
+  {
+    auto next = std::make_unique<T>(std::move(value));
+    upgrade_lock<Mutex> lock(mutex_);
+    publish(std::move(next), lock);
+  }
+
+  template <typename T, typename Mutex, std::size_t SlotCount>
+  inline bool rcu_cell<T, Mutex, SlotCount>::reclaim()
+  {
+    if (detail::rcu_snapshots_held != 0)
+      return false;
+    upgrade_lock<Mutex> lock(mutex_);
+    if (retired_.empty())
+      return true;
+    synchronize();
+    retired_.clear();
+    return true;
+  }
+
+  template <typename T, typename Mutex, std::size_t SlotCount>
+  inline std::size_t rcu_cell<T, Mutex, SlotCount>::retired() const
+  {
+    upgrade_lock<Mutex> lock(mutex_);
+    return retired_.size();
+  }
+
+  template <typename T, typename Mutex, std::size_t SlotCount>
+  inline void rcu_cell<T, Mutex, SlotCount>::publish(std::unique_ptr<T> next, upgrade_lock<Mutex> &lock)
+  {
+    retired_.reserve(retired_.size() + 1); // Cannot fail once published
+    {
+      scoped_upgrade<Mutex> x_scope(lock);
+      retired_.emplace_back(current_.exchange(next.release(), std::memory_order_seq_cst));
+    }
+    if (retired_.size() >= reclaim_batch_ && detail::rcu_snapshots_held == 0)
+    {
+      synchronize();
+      retired_.clear();
+    }
+  }
+
+  template <typename T, typename Mutex, std::size_t SlotCount>
+  inline void rcu_cell<T, Mutex, SlotCount>::synchronize()
+  {
+    // A reader may have loaded the parity just before a flip and counted
+    // itself in the old one afterwards. Waiting out both parities in turn
+    // covers it: in whichever wait matches its parity, it is either seen and
+    // waited for, or it counted itself after the publish and so only ever saw
+    // the new pointer.
+    for (int phase = 0; phase < 2; ++phase)
+    {
+      uint32_t old = epoch_.fetch_add(1, std::memory_order_seq_cst) & 1;
+      for (detail::rcu_reader_slot &slot : slots_)
+      {
+        while (slot.active[old].load(std::memory_order_seq_cst) != 0)
+          std::this_thread::yield();
+      }
+    }
+  }
+
+} // namespace sync_prim
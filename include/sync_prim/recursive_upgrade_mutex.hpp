@@ -0,0 +1,361 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <system_error>
+#include <type_traits>
+
+#include "sync_prim/upgrade_mutex.hpp"
+
+/**
+ * @brief Distinct recursive_upgrade_mutex instances one thread may hold at once.
+ *
+ * Each thread tracks its holdings in a fixed thread-local array of this many
+ * entries, searched linearly. Acquiring one more throws std::system_error.
+ */
+#ifndef SYNC_PRIM_MAX_RECURSIVE_HOLDINGS
+#define SYNC_PRIM_MAX_RECURSIVE_HOLDINGS 16
+#endif
+
+namespace sync_prim
+{
+
+  namespace detail
+  {
+    // One thread's references to one recursive mutex, by mode.
+    struct recursive_holding
+    {
+      const void *mutex = nullptr;
+      uint32_t shared = 0;
+      uint32_t upgrade = 0;
+      uint32_t exclusive = 0;
+
+      bool empty() const noexcept { return shared == 0 && upgrade == 0 && exclusive == 0; }
+    };
+
+    // The calling thread's entry for `mutex`. With `create`, a free entry is
+    // claimed if there is none.
+    inline recursive_holding *find_holding(const void *mutex, bool create)
+    {
+      thread_local recursive_holding table[SYNC_PRIM_MAX_RECURSIVE_HOLDINGS];
+      recursive_holding *free_entry = nullptr;
+      for (recursive_holding &h : table)
+      {
+        if (h.mutex == mutex)
+          return &h;
+        if (!h.mutex && !free_entry)
+          free_entry = &h;
+      }
+      if (!create)
+        return nullptr;
+      if (!free_entry)
+        throw std::system_error(std::make_error_code(std::errc::resource_unavailable_try_again),
+                                "recursive_upgrade_mutex: thread holds SYNC_PRIM_MAX_RECURSIVE_HOLDINGS mutexes");
+      free_entry->mutex = mutex;
+      return free_entry;
+    }
+  } // namespace detail
+
+  /**
+   * @class recursive_upgrade_mutex
+   * @brief An upgrade mutex that one thread may lock again in any mode.
+   *
+   * Each thread counts its shared, upgrade and exclusive references in a
+   * thread-local table, and holds the wrapped mutex in the strongest mode it
+   * has a reference for. Re-acquiring in the same or a weaker mode only bumps
+   * a counter and never touches the wrapped mutex, so a nested lock_shared()
+   * cannot deadlock against a pending upgrade. Because shared references taken
+   * under an upgrade lock are not real readers, the thread can still upgrade.
+   *
+   * Stepping up from shared to upgrade or exclusive uses the wrapped mutex's
+   * try_upgrade_from_shared(), which never waits. Waiting would mean dropping
+   * the real shared lock, since another upgrader may be waiting for our
+   * reader to leave, and the outer shared references would silently stop
+   * protecting anything. So if another thread holds the upgrade lock, a
+   * blocking step-up throws std::system_error with
+   * resource_deadlock_would_occur and a timed one returns false, both with
+   * the shared lock still held. Releasing the last
+   * upgrade reference while shared references remain keeps a shared lock:
+   * it tries a direct shared acquisition first and, if a writer blocks that,
+   * converts through exclusive to shared.
+   *
+   * Every unlock must be made by the thread that locked. Works with all the
+   * lock guards, which are themselves counted references.
+   */
+  template <typename Mutex = upgrade_mutex>
+  class recursive_upgrade_mutex
+  {
+  public:
+    using mutex_type = Mutex;
+
+    recursive_upgrade_mutex() = default;
+
+    recursive_upgrade_mutex(const recursive_upgrade_mutex &) = delete;
+    recursive_upgrade_mutex &operator=(const recursive_upgrade_mutex &) = delete;
+
+    // Exclusive locking
+    void lock() { change(nullptr, &holding::exclusive, blocking{}); }
+    void unlock() { release(&holding::exclusive); }
+
+    // Shared locking
+    void lock_shared() { change(nullptr, &holding::shared, blocking{}); }
+    void unlock_shared() { release(&holding::shared); }
+
+    // Upgradeable locking
+    void lock_upgrade() { change(nullptr, &holding::upgrade, blocking{}); }
+    void unlock_upgrade() { release(&holding::upgrade); }
+
+    // Non-blocking acquisition
+    bool try_lock() { return change(nullptr, &holding::exclusive, attempt{}); }
+    bool try_lock_shared() { return change(nullptr, &holding::shared, attempt{}); }
+    bool try_lock_upgrade() { return change(nullptr, &holding::upgrade, attempt{}); }
+
+    // Timed acquisition
+    template <typename Rep, typename Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout) { return try_lock_until(std::chrono::steady_clock::now() + timeout); }
+    template <typename Clock, typename Duration>
+    bool try_lock_until(const std::chrono::time_point<Clock, Duration> &deadline) { return change(nullptr, &holding::exclusive, until<Clock, Duration>{deadline}); }
+    template <typename Rep, typename Period>
+    bool try_lock_shared_for(const std::chrono::duration<Rep, Period> &timeout) { return try_lock_shared_until(std::chrono::steady_clock::now() + timeout); }
+    template <typename Clock, typename Duration>
+    bool try_lock_shared_until(const std::chrono::time_point<Clock, Duration> &deadline) { return change(nullptr, &holding::shared, until<Clock, Duration>{deadline}); }
+    template <typename Rep, typename Period>
+    bool try_lock_upgrade_for(const std::chrono::duration<Rep, Period> &timeout) { return try_lock_upgrade_until(std::chrono::steady_clock::now() + timeout); }
+    template <typename Clock, typename Duration>
+    bool try_lock_upgrade_until(const std::chrono::time_point<Clock, Duration> &deadline) { return change(nullptr, &holding::upgrade, until<Clock, Duration>{deadline}); }
+
+    // The calling thread's reference counts on this mutex.
+    uint32_t shared_count() const { return count(&holding::shared); }
+    uint32_t upgrade_count() const { return count(&holding::upgrade); }
+    uint32_t exclusive_count() const { return count(&holding::exclusive); }
+
+    // Moves one shared reference to the upgrade lock, if that needs no wait.
+    bool try_upgrade_from_shared() { return change(&holding::shared, &holding::upgrade, attempt{}); }
+
+  private:
+    template <typename>
+    friend class unique_lock;
+    template <typename>
+    friend class shared_lock;
+    template <typename>
+    friend class upgrade_lock;
+    template <typename>
+    friend class scoped_upgrade;
+
+    using holding = detail::recursive_holding;
+    using count_ptr = uint32_t holding::*;
+
+    // --- Internal transition functions for lock guards ---
+    // Each moves one reference between modes.
+    void upgrade_to_unique() { change(&holding::upgrade, &holding::exclusive, blocking{}); }
+    bool try_upgrade_to_unique() { return change(&holding::upgrade, &holding::exclusive, attempt{}); }
+    template <typename Clock, typename Duration>
+    bool try_upgrade_to_unique_until(const std::chrono::time_point<Clock, Duration> &deadline) { return change(&holding::upgrade, &holding::exclusive, until<Clock, Duration>{deadline}); }
+    void unique_to_upgrade() { change(&holding::exclusive, &holding::upgrade, blocking{}); }
+    void unique_to_shared() { change(&holding::exclusive, &holding::shared, blocking{}); }
+    void scoped_upgrade_entry() { upgrade_to_unique(); }
+    void scoped_upgrade_exit() { unique_to_upgrade(); }
+    bool try_shared_to_unique() { return change(&holding::shared, &holding::exclusive, attempt{}); }
+
+    // The mode the wrapped mutex is held in, ordered weakest first.
+    enum class mode
+    {
+      none,
+      shared,
+      upgrade,
+      exclusive
+    };
+
+    static mode mode_of(const holding &h) noexcept
+    {
+      return h.exclusive ? mode::exclusive : h.upgrade ? mode::upgrade
+                                         : h.shared    ? mode::shared
+                                                       : mode::none;
+    }
+
+    // --- Acquisition strategies for stepping the wrapped mutex up ---
+    // Conversions go through the wrapped mutex's own guards, which adopt its locks.
+    struct blocking
+    {
+      bool shared(Mutex &m) const { return m.lock_shared(), true; }
+      bool upgrade(Mutex &m) const { return m.lock_upgrade(), true; }
+      bool exclusive(Mutex &m) const { return m.lock(), true; }
+      bool escalate(Mutex &m) const { return m.try_upgrade_from_shared(); } // change() throws on failure
+      bool convert(Mutex &m) const
+      {
+        upgrade_lock<Mutex> u_lock(m, std::adopt_lock);
+        unique_lock<Mutex> x_lock(std::move(u_lock));
+        x_lock.release();
+        return true;
+      }
+    };
+
+    struct attempt
+    {
+      bool shared(Mutex &m) const { return m.try_lock_shared(); }
+      bool upgrade(Mutex &m) const { return m.try_lock_upgrade(); }
+      bool exclusive(Mutex &m) const { return m.try_lock(); }
+      bool escalate(Mutex &m) const { return m.try_upgrade_from_shared(); }
+      bool convert(Mutex &m) const
+      {
+        upgrade_lock<Mutex> u_lock(m, std::adopt_lock);
+        unique_lock<Mutex> x_lock(std::move(u_lock), std::try_to_lock);
+        u_lock.release(); // Still upgradeable if the conversion failed
+        return x_lock.release() != nullptr;
+      }
+    };
+
+    template <typename Clock, typename Duration>
+    struct until
+    {
+      std::chrono::time_point<Clock, Duration> deadline;
+
+      bool shared(Mutex &m) const { return m.try_lock_shared_until(deadline); }
+      bool upgrade(Mutex &m) const { return m.try_lock_upgrade_until(deadline); }
+      bool exclusive(Mutex &m) const { return m.try_lock_until(deadline); }
+      bool escalate(Mutex &m) const { return m.try_upgrade_from_shared(); }
+      bool convert(Mutex &m) const
+      {
+        upgrade_lock<Mutex> u_lock(m, std::adopt_lock);
+        unique_lock<Mutex> x_lock(std::move(u_lock), deadline);
+        u_lock.release();
+        return x_lock.release() != nullptr;
+      }
+    };
+
+    // Moves one reference from `drop` to `add` (either may be null) and
+    // brings the wrapped mutex to the resulting mode. On failure the counts
+    // are restored and the wrapped mutex is left as it was; a blocking
+    // change can only fail to step up from shared, and throws.
+    template <typename How>
+    bool change(count_ptr drop, count_ptr add, const How &how);
+    void release(count_ptr drop) { change(drop, nullptr, blocking{}); }
+    uint32_t count(count_ptr which) const;
+
+    template <typename How>
+    bool raise(mode from, mode to, const How &how);
+    void lower(mode from, mode to);
+
+    Mutex mutex_;
+  };
+
+  // --- recursive_upgrade_mutex Method Implementations ---
+
+  template <typename Mutex>
+  template <typename How>
+  inline bool recursive_upgrade_mutex<Mutex>::change(count_ptr drop, count_ptr add, const How &how)
+  {
+    holding *h = detail::find_holding(this, add != nullptr);
+    mode from = mode_of(*h);
+    if (drop)
+      --(h->*drop);
+    if (add)
+      ++(h->*add);
+    mode to = mode_of(*h);
+
+    if (to > from && !raise(from, to, how))
+    {
+      if (add)
+        --(h->*add);
+      if (drop)
+        ++(h->*drop);
+      if (h->empty())
+        h->mutex = nullptr;
+      if constexpr (std::is_same_v<How, blocking>)
+        throw std::system_error(std::make_error_code(std::errc::resource_deadlock_would_occur),
+                                "recursive_upgrade_mutex: cannot step up from shared while another thread holds the upgrade lock");
+      return false;
+    }
+    if (to < from)
+      lower(from, to);
+    if (h->empty())
+      h->mutex = nullptr;
+    return true;
+  }
+
+  template <typename Mutex>
+  inline uint32_t recursive_upgrade_mutex<Mutex>::count(count_ptr which) const
+  {
+    const holding *h = detail::find_holding(this, false);
+    return h ? h->*which : 0;
+  }
+
+  template <typename Mutex>
+  template <typename How>
+  inline bool recursive_upgrade_mutex<Mutex>::raise(mode from, mode to, const How &how)
+  {
+    switch (from)
+    {
+    case mode::none:
+      return to == mode::shared ? how.shared(mutex_) : to == mode::upgrade ? how.upgrade(mutex_)
+                                                                           : how.exclusive(mutex_);
+    case mode::shared:
+      // Our own real shared lock would block the conversion, so trade it for
+      // the upgrade lock first. That must not wait: see the class comment.
+      if (!how.escalate(mutex_))
+        return false;
+      if (to == mode::upgrade || how.convert(mutex_))
+        return true;
+      lower(mode::upgrade, mode::shared);
+      return false;
+    case mode::upgrade:
+      return how.convert(mutex_);
+    default:
+      return true;
+    }
+  }
+
+  template <typename Mutex>
+  inline void recursive_upgrade_mutex<Mutex>::lower(mode from, mode to)
+  {
+    if (from == mode::exclusive)
+    {
+      unique_lock<Mutex> x_lock(mutex_, std::adopt_lock);
+      if (to == mode::upgrade)
+        upgrade_lock<Mutex>(std::move(x_lock)).release();
+      else if (to == mode::shared)
+        shared_lock<Mutex>(std::move(x_lock)).release();
+      return; // x_lock unlocks if nothing is left
+    }
+    if (from == mode::upgrade)
+    {
+      if (to == mode::shared && !mutex_.try_lock_shared())
+      {
+        // A waiting writer refuses new readers; go through exclusive, which
+        // only waits for the current readers.
+        blocking{}.convert(mutex_);
+        lower(mode::exclusive, mode::shared);
+        return;
+      }
+      mutex_.unlock_upgrade();
+      return;
+    }
+    mutex_.unlock_shared();
+  }
+
+} // namespace sync_prim
@@ -0,0 +1,221 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "sync_prim/synchronized.hpp"
+#include "sync_prim/upgrade_mutex.hpp"
+
+namespace sync_prim
+{
+
+  namespace detail
+  {
+    /**
+     * @brief Scrambles a hash value so that consecutive keys spread over stripes.
+     *
+     * std::hash of an integer is often the identity, and record ids tend to be
+     * sequential or strided. This is the 64-bit MurmurHash3 finalizer.
+     */
+    inline std::uint64_t mix_hash(std::uint64_t h) noexcept
+    {
+      h ^= h >> 33;
+      h *= 0xff51afd7ed558ccdULL;
+      h ^= h >> 33;
+      h *= 0xc4ceb9fe1a85ec53ULL;
+      h ^= h >> 33;
+      return h;
+    }
+
+    /**
+     * @brief Key-to-stripe mapping and locking shared by the striped lock tables.
+     *
+     * Derived provides `stripes()` (pointer to the first of a contiguous array of
+     * padded stripes) and `stripe_count()`.
+     */
+    template <typename Derived, typename Mutex>
+    class striped_lock_table
+    {
+    public:
+      using mutex_type = Mutex;
+
+      template <typename Key, typename Hash = std::hash<Key>>
+      std::size_t index_of(const Key &key, const Hash &hash = Hash{}) const
+      {
+        return static_cast<std::size_t>(mix_hash(static_cast<std::uint64_t>(hash(key))) % derived().stripe_count());
+      }
+
+      Mutex &stripe(std::size_t index) { return derived().stripes()[index]; }
+
+      template <typename Key>
+      Mutex &mutex_for(const Key &key) { return stripe(index_of(key)); }
+
+      // --- Single-key acquisition ---
+      template <typename Key>
+      shared_lock<Mutex> lock_shared(const Key &key) { return shared_lock<Mutex>(mutex_for(key)); }
+
+      template <typename Key>
+      upgrade_lock<Mutex> lock_upgrade(const Key &key) { return upgrade_lock<Mutex>(mutex_for(key)); }
+
+      template <typename Key>
+      unique_lock<Mutex> lock(const Key &key) { return unique_lock<Mutex>(mutex_for(key)); }
+
+      // --- Multi-key acquisition ---
+      // The stripes of all keys are locked in ascending index order, and each
+      // stripe at most once, so two threads locking overlapping key sets never
+      // deadlock and a key set that hashes twice onto a stripe never
+      // self-deadlocks. The locks are released when the returned vector is
+      // destroyed.
+      template <typename InputIt>
+      std::vector<shared_lock<Mutex>> lock_shared(InputIt first, InputIt last)
+      {
+        return acquire_sorted<shared_lock<Mutex>>(first, last);
+      }
+
+      template <typename InputIt>
+      std::vector<upgrade_lock<Mutex>> lock_upgrade(InputIt first, InputIt last)
+      {
+        return acquire_sorted<upgrade_lock<Mutex>>(first, last);
+      }
+
+      template <typename InputIt>
+      std::vector<unique_lock<Mutex>> lock(InputIt first, InputIt last)
+      {
+        return acquire_sorted<unique_lock<Mutex>>(first, last);
+      }
+
+      template <typename Key>
+      std::vector<shared_lock<Mutex>> lock_shared(std::initializer_list<Key> keys)
+      {
+        return lock_shared(keys.begin(), keys.end());
+      }
+
+      template <typename Key>
+      std::vector<upgrade_lock<Mutex>> lock_upgrade(std::initializer_list<Key> keys)
+      {
+        return lock_upgrade(keys.begin(), keys.end());
+      }
+
+      template <typename Key>
+      std::vector<unique_lock<Mutex>> lock(std::initializer_list<Key> keys)
+      {
+        return lock(keys.begin(), keys.end());
+      }
+
+    private:
+      const Derived &derived() const { return static_cast<const Derived &>(*this); }
+      Derived &derived() { return static_cast<Derived &>(*this); }
+
+      template <typename Lock, typename InputIt>
+      std::vector<Lock> acquire_sorted(InputIt first, InputIt last)
+      {
+        std::vector<std::size_t> indices;
+        for (; first != last; ++first)
+          indices.push_back(index_of(*first));
+        std::sort(indices.begin(), indices.end());
+        indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+        std::vector<Lock> locks;
+        locks.reserve(indices.size());
+        for (std::size_t index : indices)
+          locks.emplace_back(stripe(index));
+        return locks;
+      }
+    };
+  } // namespace detail
+
+  /**
+   * @class striped_upgrade_mutex
+   * @brief A fixed table of StripeCount mutexes that keys are hashed onto.
+   *
+   * Protects an unbounded number of records with a constant amount of lock
+   * memory: every record whose key maps to the same stripe shares that
+   * stripe's mutex. The stripes are stored inline, one cache line (or more)
+   * each, so neighbouring stripes never false-share.
+   *
+   * Keys on the same stripe serialize against each other, so pick StripeCount
+   * well above the number of threads that lock concurrently.
+   */
+  template <std::size_t StripeCount, typename Mutex = upgrade_mutex>
+  class striped_upgrade_mutex
+      : public detail::striped_lock_table<striped_upgrade_mutex<StripeCount, Mutex>, Mutex>
+  {
+  public:
+    static_assert(StripeCount > 0, "striped_upgrade_mutex needs at least one stripe");
+
+    striped_upgrade_mutex() = default;
+
+    striped_upgrade_mutex(const striped_upgrade_mutex &) = delete;
+    striped_upgrade_mutex &operator=(const striped_upgrade_mutex &) = delete;
+
+    static constexpr std::size_t stripe_count() noexcept { return StripeCount; }
+
+  private:
+    friend class detail::striped_lock_table<striped_upgrade_mutex, Mutex>;
+
+    padded_upgrade_mutex<Mutex> *stripes() noexcept { return stripes_.data(); }
+
+    std::array<padded_upgrade_mutex<Mutex>, StripeCount> stripes_;
+  };
+
+  /**
+   * @class upgrade_mutex_pool
+   * @brief A striped lock table whose size is chosen at construction.
+   *
+   * The stripes are allocated once, in a single contiguous block, and are never
+   * resized: a key's stripe must not change while the key is locked.
+   */
+  template <typename Mutex = upgrade_mutex>
+  class upgrade_mutex_pool
+      : public detail::striped_lock_table<upgrade_mutex_pool<Mutex>, Mutex>
+  {
+  public:
+    explicit upgrade_mutex_pool(std::size_t stripe_count)
+        : stripe_count_(std::max<std::size_t>(stripe_count, 1)),
+          stripes_(new padded_upgrade_mutex<Mutex>[stripe_count_]) {}
+
+    upgrade_mutex_pool(const upgrade_mutex_pool &) = delete;
+    upgrade_mutex_pool &operator=(const upgrade_mutex_pool &) = delete;
+
+    std::size_t stripe_count() const noexcept { return stripe_count_; }
+
+  private:
+    friend class detail::striped_lock_table<upgrade_mutex_pool, Mutex>;
+
+    padded_upgrade_mutex<Mutex> *stripes() noexcept { return stripes_.get(); }
+
+    std::size_t stripe_count_;
+    std::unique_ptr<padded_upgrade_mutex<Mutex>[]> stripes_;
+  };
+
+} // namespace sync_prim
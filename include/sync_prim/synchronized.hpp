@@ -0,0 +1,210 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "sync_prim/cache_line.hpp"
+#include "sync_prim/upgrade_mutex.hpp"
+
+namespace sync_prim
+{
+
+  namespace detail
+  {
+    // What the callback accessors return: fn's result by value, since the
+    // lock is released before the caller sees it.
+    template <typename F, typename Arg>
+    using locked_result_t = std::decay_t<std::invoke_result_t<F, Arg>>;
+  } // namespace detail
+
+  /**
+   * @brief A mutex that occupies whole cache lines of its own.
+   *
+   * Use it for arrays of mutexes, or for a mutex embedded next to unrelated
+   * hot data. It is a drop-in replacement for Mutex and works with every
+   * lock guard.
+   */
+  template <typename Mutex = upgrade_mutex>
+  class alignas(cache_line_size) padded_upgrade_mutex : public Mutex
+  {
+  public:
+    using Mutex::Mutex;
+  };
+
+  /**
+   * @brief A pointer-like handle that holds a lock on a synchronized value.
+   *
+   * The lock is released when the handle is destroyed. Obtained from
+   * synchronized::rlock() and synchronized::wlock().
+   */
+  template <typename Value, typename Lock>
+  class locked_ptr
+  {
+  public:
+    locked_ptr(Value &value, Lock lock) noexcept : p_value_(&value), lock_(std::move(lock)) {}
+
+    Value &operator*() const noexcept { return *p_value_; }
+    Value *operator->() const noexcept { return p_value_; }
+
+    // Releases the lock early. The handle must not be dereferenced afterwards.
+    void unlock() { lock_.unlock(); }
+
+  private:
+    Value *p_value_;
+    Lock lock_;
+  };
+
+  /**
+   * @brief A handle that holds the upgrade lock on a synchronized value.
+   *
+   * Gives const access, like an rlock(), while keeping other writers and
+   * upgraders out. write() escalates to exclusive for the duration of one
+   * callback. Obtained from synchronized::ulock(), and passed to
+   * synchronized::upgrade() callbacks.
+   */
+  template <typename Value, typename Mutex>
+  class upgrade_locked_ptr
+  {
+  public:
+    upgrade_locked_ptr(Value &value, upgrade_lock<Mutex> lock) noexcept : p_value_(&value), lock_(std::move(lock)) {}
+
+    const Value &operator*() const noexcept { return *p_value_; }
+    const Value *operator->() const noexcept { return p_value_; }
+
+    // Runs fn(Value &) inside a scoped_upgrade and returns its result by
+    // value. The handle holds the upgrade lock again afterwards.
+    template <typename F>
+    detail::locked_result_t<F, Value &> write(F &&fn)
+    {
+      scoped_upgrade<Mutex> x_scope(lock_);
+      return std::forward<F>(fn)(*p_value_);
+    }
+
+    // Converts to an exclusive handle for the rest of the scope. This handle
+    // must not be used afterwards.
+    locked_ptr<Value, unique_lock<Mutex>> upgrade() &&
+    {
+      return {*p_value_, unique_lock<Mutex>(std::move(lock_))};
+    }
+
+    // Releases the lock early. The handle must not be dereferenced afterwards.
+    void unlock() { lock_.unlock(); }
+
+  private:
+    Value *p_value_;
+    upgrade_lock<Mutex> lock_;
+  };
+
+  /**
+   * @class synchronized
+   * @brief A value of type T together with the mutex that protects it.
+   *
+   * The object starts on a cache line boundary, and the value starts on the
+   * next line after the mutex. Readers spinning on the mutex are therefore not
+   * disturbed by a writer modifying the value, and neither line is shared with
+   * neighbouring objects.
+   *
+   * The value is only reachable through a lock-holding handle or a callback
+   * run under the lock, so it cannot be accessed without holding the lock.
+   * The callback forms make the lock's scope the callback's, and return the
+   * callback's result by value, even if it returns a reference:
+   *
+   *   counts.read([](const auto &m) { return m.size(); });       // shared
+   *   counts.write([](auto &m) { m.clear(); });                  // exclusive
+   *   counts.upgrade([&](auto &u) {                              // upgradeable
+   *     if (u->count(key) == 0)
+   *       u.write([&](auto &m) { m[key] = 0; });                 // escalates briefly
+   *   });
+   */
+  template <typename T, typename Mutex = upgrade_mutex>
+  class alignas(cache_line_size) synchronized
+  {
+  public:
+    using value_type = T;
+    using mutex_type = Mutex;
+
+    synchronized() = default;
+
+    template <typename Arg, typename... Args,
+              typename = std::enable_if_t<!std::is_same_v<std::decay_t<Arg>, synchronized>>>
+    explicit synchronized(Arg &&arg, Args &&...args)
+        : value_(std::forward<Arg>(arg), std::forward<Args>(args)...) {}
+
+    synchronized(const synchronized &) = delete;
+    synchronized &operator=(const synchronized &) = delete;
+
+    // Shared access
+    locked_ptr<const T, shared_lock<Mutex>> rlock() const
+    {
+      return {value_, shared_lock<Mutex>(mutex_)};
+    }
+
+    // Upgradeable access
+    upgrade_locked_ptr<T, Mutex> ulock()
+    {
+      return {value_, upgrade_lock<Mutex>(mutex_)};
+    }
+
+    // Exclusive access
+    locked_ptr<T, unique_lock<Mutex>> wlock()
+    {
+      return {value_, unique_lock<Mutex>(mutex_)};
+    }
+
+    // Runs fn(const T &) under a shared lock and returns its result by value.
+    template <typename F>
+    detail::locked_result_t<F, const T &> read(F &&fn) const
+    {
+      shared_lock<Mutex> lock(mutex_);
+      return std::forward<F>(fn)(std::as_const(value_));
+    }
+
+    // Runs fn(upgrade_locked_ptr<T, Mutex> &) under the upgrade lock and
+    // returns its result by value.
+    template <typename F>
+    detail::locked_result_t<F, upgrade_locked_ptr<T, Mutex> &> upgrade(F &&fn)
+    {
+      upgrade_locked_ptr<T, Mutex> value = ulock();
+      return std::forward<F>(fn)(value);
+    }
+
+    // Runs fn(T &) under the exclusive lock and returns its result by value.
+    template <typename F>
+    detail::locked_result_t<F, T &> write(F &&fn)
+    {
+      unique_lock<Mutex> lock(mutex_);
+      return std::forward<F>(fn)(value_);
+    }
+
+    // The protecting mutex, e.g. for stats() with the instrumented policy.
+    Mutex &mutex() const noexcept { return mutex_; }
+
+  private:
+    mutable Mutex mutex_;
+    alignas(cache_line_size) T value_{};
+  };
+
+} // namespace sync_prim
@@ -24,14 +24,32 @@
 #pragma once
 
 #include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
 #include <mutex>
-#include <condition_variable>
+
+#include "sync_prim/cache_line.hpp"
+#include "sync_prim/fairness_policy.hpp"
+#include "sync_prim/feature_policy.hpp"
+#include "sync_prim/handoff_policy.hpp"
+#include "sync_prim/instrumentation.hpp"
+#include "sync_prim/lock_validation.hpp"
+#include "sync_prim/optimistic_read.hpp"
+#include "sync_prim/park_backend.hpp"
+#include "sync_prim/wait_policy.hpp"
 
 namespace sync_prim
 {
 
   // Forward declarations
-  class upgrade_mutex;
+  template <typename... Policies>
+  class basic_upgrade_mutex;
+
+  /**
+   * @brief The default upgrade_mutex: spins briefly, then parks.
+   */
+  using upgrade_mutex = basic_upgrade_mutex<>;
 
   template <typename Mutex>
   class unique_lock;
@@ -46,7 +64,7 @@ namespace sync_prim
   class scoped_upgrade;
 
   /**
-   * @class upgrade_mutex
+   * @class basic_upgrade_mutex
    * @brief A synchronization primitive that allows multiple readers, a single
    * upgrader, and a single writer, with atomic transitions between lock states.
    *
@@ -58,14 +76,67 @@ namespace sync_prim
    *
    * The state is managed by a single atomic integer, allowing for efficient
    * lock acquisition and release under low contention.
+   *
+   * Behavior is customized at compile time through Policies, given in any order:
+   * - A wait policy (`pure_spin`, `spin_then_park`, `immediate_park`) decides
+   *   whether contended threads spin, park, or both. Defaults to `spin_then_park`.
+   * - A park backend (`condvar_backend`, `futex_backend`) decides how parked
+   *   threads sleep. Defaults to `condvar_backend`; with `futex_backend` the
+   *   whole mutex is a single 32-bit word.
+   * - A fairness policy (`reader_preferring`, `writer_preferring`,
+   *   `phase_fair`) decides whether a waiting lock() caller stops new readers.
+   *   Defaults to `reader_preferring`.
+   * - `optimistic_reads` adds a version counter and the lock-free
+   *   read_begin() / read_validate() API. Defaults to `no_optimistic_reads`.
+   * - `direct_handoff` makes releases pass the exclusive lock straight to a
+   *   parked writer instead of waking it to compete. Defaults to `no_handoff`.
+   * - `instrumented` records contention counters and wait/hold times, read
+   *   back through stats(). Defaults to `no_instrumentation`.
+   * - `lock_validation` reports lock-order cycles and self-deadlocking
+   *   transitions. Defaults to `no_lock_validation`, or to `lock_validation`
+   *   when SYNC_PRIM_LOCK_VALIDATION is defined to 1.
+   * - Feature policies (see feature_policy.hpp) trim or widen the state:
+   *   `no_upgrade` drops the upgrade lock for plain reader-writer use,
+   *   `wide_state` makes the state 64 bits wide for more than 2^27 readers,
+   *   and `bounded_readers<N>` admits at most N readers at once. Defaults to
+   *   `with_upgrade`, `narrow_state` and `unbounded_readers`, which together
+   *   are `upgrade_mutex`.
+   *
+   * With a backend that has wait structures (such as `condvar_backend`), the
+   * state word sits on its own cache line behind them, so the mutex is
+   * cache-line aligned and never shares the hot line with neighbouring data.
    */
-  class upgrade_mutex
+  template <typename... Policies>
+  class basic_upgrade_mutex
+      : private detail::select_policy_t<park_backend_tag, condvar_backend, Policies...>,
+        private detail::sequence_counter<detail::select_policy_t<optimistic_read_tag, no_optimistic_reads, Policies...>::enabled>,
+        private detail::lock_stats_recorder<detail::select_policy_t<instrumentation_tag, no_instrumentation, Policies...>::enabled>,
+        private detail::lock_order_checker<detail::select_policy_t<lock_validation_tag, default_lock_validation, Policies...>::enabled>
   {
   public:
-    upgrade_mutex() : state_(0) {}
+    using wait_policy = detail::select_policy_t<wait_policy_tag, spin_then_park, Policies...>;
+    using park_backend = detail::select_policy_t<park_backend_tag, condvar_backend, Policies...>;
+    using optimistic_read_policy = detail::select_policy_t<optimistic_read_tag, no_optimistic_reads, Policies...>;
+    using fairness_policy = detail::select_policy_t<fairness_tag, reader_preferring, Policies...>;
+    using handoff_policy = detail::select_policy_t<handoff_tag, no_handoff, Policies...>;
+    using instrumentation_policy = detail::select_policy_t<instrumentation_tag, no_instrumentation, Policies...>;
+    using lock_validation_policy = detail::select_policy_t<lock_validation_tag, default_lock_validation, Policies...>;
+    using upgrade_policy = detail::select_policy_t<upgrade_support_tag, with_upgrade, Policies...>;
+    using state_width_policy = detail::select_policy_t<state_width_tag, narrow_state, Policies...>;
+    using reader_limit_policy = detail::select_policy_t<reader_limit_tag, unbounded_readers, Policies...>;
+    using state_type = typename state_width_policy::word_type;
+
+    static_assert(!fairness_policy::alternates_phases || park_backend::exact_waiter_flags || !wait_policy::parks,
+                  "phase_fair needs a park backend with exact waiter flags, such as condvar_backend");
+    static_assert(!handoff_policy::enabled || park_backend::supports_handoff,
+                  "direct_handoff needs a park backend with handoff support, such as condvar_backend");
+    static_assert(sizeof(state_type) == sizeof(uint32_t) || park_backend::supports_wide_state,
+                  "wide_state needs a park backend that waits on 64-bit words, such as condvar_backend");
+
+    basic_upgrade_mutex() : state_(0) {}
 
-    upgrade_mutex(const upgrade_mutex &) = delete;
-    upgrade_mutex &operator=(const upgrade_mutex &) = delete;
+    basic_upgrade_mutex(const basic_upgrade_mutex &) = delete;
+    basic_upgrade_mutex &operator=(const basic_upgrade_mutex &) = delete;
 
     // Exclusive locking
     void lock();
@@ -79,68 +150,223 @@ namespace sync_prim
     void lock_upgrade();
     void unlock_upgrade();
 
+    // Non-blocking acquisition. Each is a single atomic operation on the state
+    // word and never touches the park backend.
+    bool try_lock();
+    bool try_lock_shared();
+    bool try_lock_upgrade();
+
+    // Timed acquisition. Together these make the mutex a SharedTimedMutex.
+    template <typename Rep, typename Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout);
+    template <typename Clock, typename Duration>
+    bool try_lock_until(const std::chrono::time_point<Clock, Duration> &deadline);
+    template <typename Rep, typename Period>
+    bool try_lock_shared_for(const std::chrono::duration<Rep, Period> &timeout);
+    template <typename Clock, typename Duration>
+    bool try_lock_shared_until(const std::chrono::time_point<Clock, Duration> &deadline);
+    template <typename Rep, typename Period>
+    bool try_lock_upgrade_for(const std::chrono::duration<Rep, Period> &timeout);
+    template <typename Clock, typename Duration>
+    bool try_lock_upgrade_until(const std::chrono::time_point<Clock, Duration> &deadline);
+
+    // Conditional escalation of a shared lock the caller holds. Succeeds, in a
+    // single atomic operation, if try_lock_upgrade() would: no other thread
+    // holds the upgrade lock (and, under writer_preferring / phase_fair, no
+    // writer is waiting). The caller then holds the upgrade lock instead of
+    // its shared lock; on failure it keeps the shared lock. Readers can thus
+    // proceed optimistically and only escalate once they find work to do.
+    bool try_upgrade_from_shared();
+
+    // Optimistic (sequence-lock) reads; requires the optimistic_reads policy.
+    // read_begin() waits out an active writer and returns a version token.
+    // read_validate() returns true if no writer held the mutex since then,
+    // i.e. everything read in between is consistent. Shared and upgrade lock
+    // holders never invalidate optimistic readers.
+    uint32_t read_begin();
+    bool read_validate(uint32_t token) const;
+
+    // Contention statistics; requires the instrumented policy. stats() sums
+    // the per-thread shards. reset_stats() is not atomic with respect to
+    // concurrent lock operations; call it at quiescent points.
+    lock_stats stats() const;
+    void reset_stats();
+
+    // The most shared locks that can be held at once: the width of the reader
+    // count, or the bounded_readers limit. One more reader past the count's
+    // width would corrupt the state; debug builds assert on it.
+    static constexpr state_type max_readers()
+    {
+      if constexpr (reader_limit_policy::bounded)
+        return reader_limit_policy::max_readers;
+      else
+        return READER_COUNT_MASK;
+    }
+
+    // Names the mutex in lock validation reports; a no-op without the
+    // lock_validation policy.
+    using detail::lock_order_checker<lock_validation_policy::enabled>::set_debug_name;
+
   private:
-    friend class unique_lock<upgrade_mutex>;
-    friend class shared_lock<upgrade_mutex>;
-    friend class upgrade_lock<upgrade_mutex>;
-    friend class scoped_upgrade<upgrade_mutex>;
+    using sequence_counter = detail::sequence_counter<optimistic_read_policy::enabled>;
+    using stats_recorder = detail::lock_stats_recorder<instrumentation_policy::enabled>;
+    using order_checker = detail::lock_order_checker<lock_validation_policy::enabled>;
+    using lock_mode = detail::lock_mode;
+
+    template <typename>
+    friend class unique_lock;
+    template <typename>
+    friend class shared_lock;
+    template <typename>
+    friend class upgrade_lock;
+    template <typename>
+    friend class scoped_upgrade;
 
     // --- Internal transition functions for lock guards ---
     void upgrade_to_unique();
+    bool try_upgrade_to_unique();
+    template <typename Clock, typename Duration>
+    bool try_upgrade_to_unique_until(const std::chrono::time_point<Clock, Duration> &deadline);
     void unique_to_upgrade();
     void unique_to_shared();
     void scoped_upgrade_entry();
     void scoped_upgrade_exit();
+    bool try_shared_to_unique();
+
+    // --- Single-attempt acquisition, shared by the spin and park loops ---
+    // `announce` lets a waiting writer set WRITE_PENDING_FLAG. `seen_phase` is
+    // the writer phase a waiting reader or upgrader last queued behind.
+    bool try_acquire_exclusive(bool announce = false);
+    // `record_peak` feeds the peak-readers statistic; read_begin() skips it.
+    bool try_acquire_shared();
+    bool try_acquire_shared(state_type &seen_phase, bool record_peak = true);
+    bool try_acquire_upgrade();
+    bool try_acquire_upgrade(state_type &seen_phase);
+    bool readers_drained() const;
+    state_type current_phase() const;
+
+    // --- Exclusive release, shared by unlock() and the downgrades ---
+    // Replaces WRITE_LOCKED_FLAG with `replacement` (0, UPGRADE_LOCKED_FLAG or
+    // ONE_READER) and returns the previous state.
+    state_type release_exclusive(state_type replacement);
+    void notify_after_unlock(state_type old_state);
+
+    // --- Shared release, without the validation hook ---
+    void release_shared();
+
+    // --- Optimistic reads (optimistic_reads only) ---
+    // Waits for the active writer as a reader would, through the internal
+    // acquire and release, so no validation or statistics hook sees it.
+    void wait_out_writer();
+
+    // --- Statistics (instrumented only) ---
+    // Records the outcome of an upgrade attempt that began at `since`, and
+    // whether it set UPGRADE_PENDING_FLAG.
+    void record_upgraded(typename stats_recorder::stamp_t since, bool converted, bool pending = true);
+    void abandon_write_pending();
+
+    // --- Direct handoff (direct_handoff only) ---
+    // With WRITE_LOCKED_FLAG held, passes it to a parked writer. Returns false,
+    // leaving the caller the owner, if no writer can take it.
+    bool hand_off_exclusive();
+
+    // --- Slow-path helpers ---
+    void lock_slow();
+    void lock_shared_slow();
+    void lock_upgrade_slow();
+    template <typename Clock, typename Duration, typename TryAcquire>
+    bool acquire_until(int gate, state_type waiters_flag, const std::chrono::time_point<Clock, Duration> &deadline, TryAcquire try_acquire);
+    void notify_gate1();
+    void notify_gate2(bool all);
+
+    // Backend gate indices
+    static constexpr int GATE1 = 0; // For shared/upgrade waiters
+    static constexpr int GATE2 = 1; // For exclusive/upgrade-to-exclusive waiters
 
     // --- State constants ---
-    // The state is represented by a 32-bit atomic integer.
+    // The state is a 32-bit atomic integer (64-bit under wide_state), with
+    // the flags in its top five to eight bits. For the 32-bit word:
     // Bit 31: Exclusive write lock held
     // Bit 30: Upgradeable lock held
     // Bit 29: An upgrade to exclusive is pending (to starve new readers)
-    // Bits 0-28: Count of shared readers
-    static constexpr uint32_t WRITE_LOCKED_FLAG = 1u << 31;
-    static constexpr uint32_t UPGRADE_LOCKED_FLAG = 1u << 30;
-    static constexpr uint32_t UPGRADE_PENDING_FLAG = 1u << 29;
-    static constexpr uint32_t READER_COUNT_MASK = ~(WRITE_LOCKED_FLAG | UPGRADE_LOCKED_FLAG | UPGRADE_PENDING_FLAG);
-    static constexpr uint32_t ONE_READER = 1u;
+    // Bit 28: At least one thread is parked on gate1
+    // Bit 27: At least one thread is parked on gate2
+    // Bit 26: A lock() caller is waiting (writer_preferring / phase_fair only)
+    // Bit 25: Readers released by the last writer go first (phase_fair only)
+    // Bit 24: Writer phase parity, flipped on each exclusive release (phase_fair only)
+    // Bits 0-23: Count of shared readers (0-26 under reader_preferring)
+    // Under no_upgrade, the two upgrade flags are zero and their bits unused.
+    // Under reader_preferring, the three fairness flags are zero and their
+    // bits belong to the reader count.
+    static constexpr state_type TOP_FLAG = state_type(1) << (8 * sizeof(state_type) - 1);
+    static constexpr bool has_fairness_flags = fairness_policy::blocks_new_readers;
+    static constexpr state_type WRITE_LOCKED_FLAG = TOP_FLAG;
+    static constexpr state_type UPGRADE_LOCKED_FLAG = upgrade_policy::enabled ? TOP_FLAG >> 1 : 0;
+    static constexpr state_type UPGRADE_PENDING_FLAG = upgrade_policy::enabled ? TOP_FLAG >> 2 : 0;
+    static constexpr state_type GATE1_WAITERS_FLAG = TOP_FLAG >> 3;
+    static constexpr state_type GATE2_WAITERS_FLAG = TOP_FLAG >> 4;
+    static constexpr state_type WRITE_PENDING_FLAG = has_fairness_flags ? TOP_FLAG >> 5 : 0;
+    static constexpr state_type READER_TURN_FLAG = has_fairness_flags ? TOP_FLAG >> 6 : 0;
+    static constexpr state_type PHASE_FLAG = has_fairness_flags ? TOP_FLAG >> 7 : 0;
+    static constexpr state_type LOWEST_FLAG = has_fairness_flags ? PHASE_FLAG : GATE2_WAITERS_FLAG;
+    static constexpr state_type WAITER_FLAGS = GATE1_WAITERS_FLAG | GATE2_WAITERS_FLAG;
+    static constexpr state_type FAIRNESS_FLAGS = WRITE_PENDING_FLAG | READER_TURN_FLAG | PHASE_FLAG;
+    static constexpr state_type READER_COUNT_MASK = LOWEST_FLAG - 1;
+    static constexpr state_type ONE_READER = 1u;
+
+    static_assert(!reader_limit_policy::bounded || reader_limit_policy::max_readers <= READER_COUNT_MASK,
+                  "bounded_readers limit exceeds the reader count of the state word; use wide_state");
 
     // --- Synchronization Primitives ---
-    std::atomic<uint32_t> state_;
-    std::mutex internal_mutex_;
-    std::condition_variable gate1_; // For shared/upgrade waiters
-    std::condition_variable gate2_; // For exclusive/upgrade-to-exclusive waiters
+    // The park backend is a private base, so a stateless backend adds no size.
+    // Otherwise the state word is pushed past the backend's cold wait
+    // structures onto a cache line of its own.
+    alignas(detail::state_alignment<park_backend, state_type>) std::atomic<state_type> state_;
   };
 
   // --- Lock Guard Implementations ---
 
   /**
    * @brief A generic RAII lock guard base providing common functionality.
+   *
+   * A guard is associated with at most one mutex and may or may not own a lock
+   * on it (e.g. after std::defer_lock or a failed std::try_to_lock).
    */
   template <typename Mutex>
   class lock_guard_base
   {
   public:
-    bool owns_lock() const noexcept { return p_mutex_ != nullptr; }
+    bool owns_lock() const noexcept { return owns_; }
     explicit operator bool() const noexcept { return owns_lock(); }
 
-    void release() noexcept { p_mutex_ = nullptr; }
+    // Disassociates from the mutex without unlocking it.
+    Mutex *release() noexcept
+    {
+      Mutex *m = p_mutex_;
+      p_mutex_ = nullptr;
+      owns_ = false;
+      return m;
+    }
 
     // Public accessor for the underlying mutex pointer.
     Mutex *mutex() const noexcept { return p_mutex_; }
 
   protected:
-    lock_guard_base() noexcept : p_mutex_(nullptr) {}
-    explicit lock_guard_base(Mutex &m) noexcept : p_mutex_(&m) {}
-    lock_guard_base(lock_guard_base &&other) noexcept : p_mutex_(other.p_mutex_)
+    lock_guard_base() noexcept : p_mutex_(nullptr), owns_(false) {}
+    explicit lock_guard_base(Mutex &m, bool owns = true) noexcept : p_mutex_(&m), owns_(owns) {}
+    lock_guard_base(lock_guard_base &&other) noexcept : p_mutex_(other.p_mutex_), owns_(other.owns_)
     {
       other.p_mutex_ = nullptr;
+      other.owns_ = false;
     }
     lock_guard_base &operator=(lock_guard_base &&other) noexcept
     {
       if (this != &other)
       {
         p_mutex_ = other.p_mutex_;
+        owns_ = other.owns_;
         other.p_mutex_ = nullptr;
+        other.owns_ = false;
       }
       return *this;
     }
@@ -149,83 +375,198 @@ namespace sync_prim
     lock_guard_base &operator=(const lock_guard_base &) = delete;
 
     Mutex *p_mutex_;
+    bool owns_;
   };
 
   /**
    * @brief An RAII wrapper for an exclusive lock on an upgrade_mutex.
    */
-  template <>
-  class unique_lock<upgrade_mutex> : public lock_guard_base<upgrade_mutex>
+  template <typename Mutex>
+  class unique_lock : public lock_guard_base<Mutex>
   {
   public:
     unique_lock() noexcept = default;
-    explicit unique_lock(upgrade_mutex &m) : lock_guard_base(m) { p_mutex_->lock(); }
+    explicit unique_lock(Mutex &m) : lock_guard_base<Mutex>(m) { this->p_mutex_->lock(); }
+    unique_lock(Mutex &m, std::defer_lock_t) noexcept : lock_guard_base<Mutex>(m, false) {}
+    unique_lock(Mutex &m, std::try_to_lock_t) : lock_guard_base<Mutex>(m, m.try_lock()) {}
+    unique_lock(Mutex &m, std::adopt_lock_t) noexcept : lock_guard_base<Mutex>(m, true) {}
+    template <typename Rep, typename Period>
+    unique_lock(Mutex &m, const std::chrono::duration<Rep, Period> &timeout) : lock_guard_base<Mutex>(m, m.try_lock_for(timeout)) {}
+    template <typename Clock, typename Duration>
+    unique_lock(Mutex &m, const std::chrono::time_point<Clock, Duration> &deadline) : lock_guard_base<Mutex>(m, m.try_lock_until(deadline)) {}
     ~unique_lock()
     {
-      if (p_mutex_)
-        p_mutex_->unlock();
+      if (this->owns_)
+        this->p_mutex_->unlock();
     }
 
     unique_lock(unique_lock &&other) noexcept = default;
-    unique_lock &operator=(unique_lock &&other) noexcept = default;
+    unique_lock &operator=(unique_lock &&other) noexcept
+    {
+      if (this != &other && this->owns_)
+        this->p_mutex_->unlock();
+      lock_guard_base<Mutex>::operator=(std::move(other));
+      return *this;
+    }
 
     // Atomic transition from an upgrade_lock
-    explicit unique_lock(upgrade_lock<upgrade_mutex> &&other);
+    explicit unique_lock(upgrade_lock<Mutex> &&other);
+
+    // Non-blocking transition from an upgrade_lock. On failure `other` keeps
+    // its upgrade lock and this guard owns nothing.
+    unique_lock(upgrade_lock<Mutex> &&other, std::try_to_lock_t);
+
+    // Timed transition from an upgrade_lock. On timeout `other` keeps its
+    // upgrade lock, and readers blocked by the abandoned upgrade are released.
+    template <typename Rep, typename Period>
+    unique_lock(upgrade_lock<Mutex> &&other, const std::chrono::duration<Rep, Period> &timeout)
+        : unique_lock(std::move(other), std::chrono::steady_clock::now() + timeout) {}
+    template <typename Clock, typename Duration>
+    unique_lock(upgrade_lock<Mutex> &&other, const std::chrono::time_point<Clock, Duration> &deadline);
+
+    // Non-blocking transition from a shared_lock. Succeeds only if `other`'s
+    // reader is the only lock holder. On failure `other` keeps its shared lock
+    // and this guard owns nothing.
+    unique_lock(shared_lock<Mutex> &&other, std::try_to_lock_t);
+
+    // Locking on an associated mutex (e.g. after std::defer_lock).
+    // Precondition: a mutex is associated and not already owned.
+    void lock()
+    {
+      this->p_mutex_->lock();
+      this->owns_ = true;
+    }
+    bool try_lock() { return this->owns_ = this->p_mutex_->try_lock(); }
+    template <typename Rep, typename Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout) { return this->owns_ = this->p_mutex_->try_lock_for(timeout); }
+    template <typename Clock, typename Duration>
+    bool try_lock_until(const std::chrono::time_point<Clock, Duration> &deadline) { return this->owns_ = this->p_mutex_->try_lock_until(deadline); }
+    void unlock()
+    {
+      this->p_mutex_->unlock();
+      this->owns_ = false;
+    }
   };
 
   /**
    * @brief An RAII wrapper for a shared lock on an upgrade_mutex.
    */
-  template <>
-  class shared_lock<upgrade_mutex> : public lock_guard_base<upgrade_mutex>
+  template <typename Mutex>
+  class shared_lock : public lock_guard_base<Mutex>
   {
   public:
     shared_lock() noexcept = default;
-    explicit shared_lock(upgrade_mutex &m) : lock_guard_base(m) { p_mutex_->lock_shared(); }
+    explicit shared_lock(Mutex &m) : lock_guard_base<Mutex>(m) { this->p_mutex_->lock_shared(); }
+    shared_lock(Mutex &m, std::defer_lock_t) noexcept : lock_guard_base<Mutex>(m, false) {}
+    shared_lock(Mutex &m, std::try_to_lock_t) : lock_guard_base<Mutex>(m, m.try_lock_shared()) {}
+    shared_lock(Mutex &m, std::adopt_lock_t) noexcept : lock_guard_base<Mutex>(m, true) {}
+    template <typename Rep, typename Period>
+    shared_lock(Mutex &m, const std::chrono::duration<Rep, Period> &timeout) : lock_guard_base<Mutex>(m, m.try_lock_shared_for(timeout)) {}
+    template <typename Clock, typename Duration>
+    shared_lock(Mutex &m, const std::chrono::time_point<Clock, Duration> &deadline) : lock_guard_base<Mutex>(m, m.try_lock_shared_until(deadline)) {}
     ~shared_lock()
     {
-      if (p_mutex_)
-        p_mutex_->unlock_shared();
+      if (this->owns_)
+        this->p_mutex_->unlock_shared();
     }
 
     shared_lock(shared_lock &&other) noexcept = default;
-    shared_lock &operator=(shared_lock &&other) noexcept = default;
+    shared_lock &operator=(shared_lock &&other) noexcept
+    {
+      if (this != &other && this->owns_)
+        this->p_mutex_->unlock_shared();
+      lock_guard_base<Mutex>::operator=(std::move(other));
+      return *this;
+    }
 
     // Atomic transition from a unique_lock
-    explicit shared_lock(unique_lock<upgrade_mutex> &&other);
+    explicit shared_lock(unique_lock<Mutex> &&other);
+
+    // Locking on an associated mutex (e.g. after std::defer_lock).
+    // Precondition: a mutex is associated and not already owned.
+    void lock()
+    {
+      this->p_mutex_->lock_shared();
+      this->owns_ = true;
+    }
+    bool try_lock() { return this->owns_ = this->p_mutex_->try_lock_shared(); }
+    template <typename Rep, typename Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout) { return this->owns_ = this->p_mutex_->try_lock_shared_for(timeout); }
+    template <typename Clock, typename Duration>
+    bool try_lock_until(const std::chrono::time_point<Clock, Duration> &deadline) { return this->owns_ = this->p_mutex_->try_lock_shared_until(deadline); }
+    void unlock()
+    {
+      this->p_mutex_->unlock_shared();
+      this->owns_ = false;
+    }
   };
 
   /**
    * @brief An RAII wrapper for an upgradeable lock on an upgrade_mutex.
    */
-  template <>
-  class upgrade_lock<upgrade_mutex> : public lock_guard_base<upgrade_mutex>
+  template <typename Mutex>
+  class upgrade_lock : public lock_guard_base<Mutex>
   {
   public:
     upgrade_lock() noexcept = default;
-    explicit upgrade_lock(upgrade_mutex &m) : lock_guard_base(m) { p_mutex_->lock_upgrade(); }
+    explicit upgrade_lock(Mutex &m) : lock_guard_base<Mutex>(m) { this->p_mutex_->lock_upgrade(); }
+    upgrade_lock(Mutex &m, std::defer_lock_t) noexcept : lock_guard_base<Mutex>(m, false) {}
+    upgrade_lock(Mutex &m, std::try_to_lock_t) : lock_guard_base<Mutex>(m, m.try_lock_upgrade()) {}
+    upgrade_lock(Mutex &m, std::adopt_lock_t) noexcept : lock_guard_base<Mutex>(m, true) {}
+    template <typename Rep, typename Period>
+    upgrade_lock(Mutex &m, const std::chrono::duration<Rep, Period> &timeout) : lock_guard_base<Mutex>(m, m.try_lock_upgrade_for(timeout)) {}
+    template <typename Clock, typename Duration>
+    upgrade_lock(Mutex &m, const std::chrono::time_point<Clock, Duration> &deadline) : lock_guard_base<Mutex>(m, m.try_lock_upgrade_until(deadline)) {}
     ~upgrade_lock()
     {
-      if (p_mutex_)
-        p_mutex_->unlock_upgrade();
+      if (this->owns_)
+        this->p_mutex_->unlock_upgrade();
     }
 
     upgrade_lock(upgrade_lock &&other) noexcept = default;
-    upgrade_lock &operator=(upgrade_lock &&other) noexcept = default;
+    upgrade_lock &operator=(upgrade_lock &&other) noexcept
+    {
+      if (this != &other && this->owns_)
+        this->p_mutex_->unlock_upgrade();
+      lock_guard_base<Mutex>::operator=(std::move(other));
+      return *this;
+    }
 
     // Atomic transition from a unique_lock
-    explicit upgrade_lock(unique_lock<upgrade_mutex> &&other);
+    explicit upgrade_lock(unique_lock<Mutex> &&other);
+
+    // Non-blocking transition from a shared_lock (Mutex::try_upgrade_from_shared).
+    // On failure `other` keeps its shared lock and this guard owns nothing.
+    upgrade_lock(shared_lock<Mutex> &&other, std::try_to_lock_t);
+
+    // Locking on an associated mutex (e.g. after std::defer_lock).
+    // Precondition: a mutex is associated and not already owned.
+    void lock()
+    {
+      this->p_mutex_->lock_upgrade();
+      this->owns_ = true;
+    }
+    bool try_lock() { return this->owns_ = this->p_mutex_->try_lock_upgrade(); }
+    template <typename Rep, typename Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout) { return this->owns_ = this->p_mutex_->try_lock_upgrade_for(timeout); }
+    template <typename Clock, typename Duration>
+    bool try_lock_until(const std::chrono::time_point<Clock, Duration> &deadline) { return this->owns_ = this->p_mutex_->try_lock_upgrade_until(deadline); }
+    void unlock()
+    {
+      this->p_mutex_->unlock_upgrade();
+      this->owns_ = false;
+    }
   };
 
   /**
    * @brief A scoped RAII wrapper to temporarily upgrade an upgrade_lock to unique
    * and automatically downgrade upon destruction.
    */
-  template <>
-  class scoped_upgrade<upgrade_mutex>
+  template <typename Mutex>
+  class scoped_upgrade
   {
   public:
-    explicit scoped_upgrade(upgrade_lock<upgrade_mutex> &lock) : p_mutex_(lock.mutex())
+    explicit scoped_upgrade(upgrade_lock<Mutex> &lock) : p_mutex_(lock.owns_lock() ? lock.mutex() : nullptr)
     {
       if (p_mutex_)
       {
@@ -233,6 +574,32 @@ namespace sync_prim
       }
     }
 
+    // Non-blocking upgrade: only succeeds if no readers are present right now.
+    // On failure the upgrade_lock is untouched and owns_lock() returns false.
+    scoped_upgrade(upgrade_lock<Mutex> &lock, std::try_to_lock_t)
+        : p_mutex_(lock.owns_lock() ? lock.mutex() : nullptr)
+    {
+      if (p_mutex_ && !p_mutex_->try_upgrade_to_unique())
+      {
+        p_mutex_ = nullptr;
+      }
+    }
+
+    // Timed upgrade. On timeout the upgrade_lock is untouched, readers blocked
+    // by the abandoned upgrade are released, and owns_lock() returns false.
+    template <typename Rep, typename Period>
+    scoped_upgrade(upgrade_lock<Mutex> &lock, const std::chrono::duration<Rep, Period> &timeout)
+        : scoped_upgrade(lock, std::chrono::steady_clock::now() + timeout) {}
+    template <typename Clock, typename Duration>
+    scoped_upgrade(upgrade_lock<Mutex> &lock, const std::chrono::time_point<Clock, Duration> &deadline)
+        : p_mutex_(lock.owns_lock() ? lock.mutex() : nullptr)
+    {
+      if (p_mutex_ && !p_mutex_->try_upgrade_to_unique_until(deadline))
+      {
+        p_mutex_ = nullptr;
+      }
+    }
+
     ~scoped_upgrade()
     {
       if (p_mutex_)
@@ -241,167 +608,906 @@ namespace sync_prim
       }
     }
 
+    bool owns_lock() const noexcept { return p_mutex_ != nullptr; }
+    explicit operator bool() const noexcept { return owns_lock(); }
+
     scoped_upgrade(const scoped_upgrade &) = delete;
     scoped_upgrade &operator=(const scoped_upgrade &) = delete;
 
   private:
-    upgrade_mutex *p_mutex_;
+    Mutex *p_mutex_;
   };
 
   // --- Atomic Transition Constructor Implementations ---
 
-  inline unique_lock<upgrade_mutex>::unique_lock(upgrade_lock<upgrade_mutex> &&other)
-      : lock_guard_base(std::move(other))
+  template <typename Mutex>
+  inline unique_lock<Mutex>::unique_lock(upgrade_lock<Mutex> &&other)
+      : lock_guard_base<Mutex>(std::move(other))
   {
-    if (p_mutex_)
+    if (this->owns_)
     {
-      p_mutex_->upgrade_to_unique();
+      this->p_mutex_->upgrade_to_unique();
     }
   }
 
-  inline upgrade_lock<upgrade_mutex>::upgrade_lock(unique_lock<upgrade_mutex> &&other)
-      : lock_guard_base(std::move(other))
+  template <typename Mutex>
+  inline unique_lock<Mutex>::unique_lock(upgrade_lock<Mutex> &&other, std::try_to_lock_t)
   {
-    if (p_mutex_)
+    if (other.owns_lock() && other.mutex()->try_upgrade_to_unique())
     {
-      p_mutex_->unique_to_upgrade();
+      lock_guard_base<Mutex>::operator=(std::move(other));
     }
   }
 
-  inline shared_lock<upgrade_mutex>::shared_lock(unique_lock<upgrade_mutex> &&other)
-      : lock_guard_base(std::move(other))
+  template <typename Mutex>
+  template <typename Clock, typename Duration>
+  inline unique_lock<Mutex>::unique_lock(upgrade_lock<Mutex> &&other, const std::chrono::time_point<Clock, Duration> &deadline)
   {
-    if (p_mutex_)
+    if (other.owns_lock() && other.mutex()->try_upgrade_to_unique_until(deadline))
     {
-      p_mutex_->unique_to_shared();
+      lock_guard_base<Mutex>::operator=(std::move(other));
     }
   }
 
-  // --- upgrade_mutex Method Implementations ---
+  template <typename Mutex>
+  inline unique_lock<Mutex>::unique_lock(shared_lock<Mutex> &&other, std::try_to_lock_t)
+  {
+    if (other.owns_lock() && other.mutex()->try_shared_to_unique())
+    {
+      lock_guard_base<Mutex>::operator=(std::move(other));
+    }
+  }
 
-  void upgrade_mutex::lock()
+  template <typename Mutex>
+  inline upgrade_lock<Mutex>::upgrade_lock(shared_lock<Mutex> &&other, std::try_to_lock_t)
   {
-    std::unique_lock<std::mutex> internal_lock(internal_mutex_);
-    gate2_.wait(internal_lock, [this]
-                {
-        // Wait until no other locks are held
-        uint32_t current_state = state_.load(std::memory_order_relaxed);
-        if (current_state == 0) {
-            // Attempt to acquire the lock
-            return state_.compare_exchange_strong(current_state, WRITE_LOCKED_FLAG, std::memory_order_acquire, std::memory_order_relaxed);
-        }
-        return false; });
+    if (other.owns_lock() && other.mutex()->try_upgrade_from_shared())
+    {
+      lock_guard_base<Mutex>::operator=(std::move(other));
+    }
+  }
+
+  template <typename Mutex>
+  inline upgrade_lock<Mutex>::upgrade_lock(unique_lock<Mutex> &&other)
+      : lock_guard_base<Mutex>(std::move(other))
+  {
+    if (this->owns_)
+    {
+      this->p_mutex_->unique_to_upgrade();
+    }
+  }
+
+  template <typename Mutex>
+  inline shared_lock<Mutex>::shared_lock(unique_lock<Mutex> &&other)
+      : lock_guard_base<Mutex>(std::move(other))
+  {
+    if (this->owns_)
+    {
+      this->p_mutex_->unique_to_shared();
+    }
+  }
+
+  // --- basic_upgrade_mutex Method Implementations ---
+
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::lock()
+  {
+    order_checker::check_acquire(lock_mode::exclusive);
+    // Fast path: a completely free mutex with nobody parked goes straight to
+    // WRITE_LOCKED_FLAG with a single CAS. (Under phase_fair, "free" may carry
+    // either phase parity.)
+    state_type expected = current_phase();
+    if (state_.compare_exchange_strong(expected, WRITE_LOCKED_FLAG, std::memory_order_acquire, std::memory_order_relaxed))
+    {
+      sequence_counter::publish_exclusive();
+      stats_recorder::record_acquire(lock_mode::exclusive, false);
+      stats_recorder::record_exclusive_start();
+      order_checker::note_acquire(lock_mode::exclusive);
+      return;
+    }
+    lock_slow();
+    stats_recorder::record_acquire(lock_mode::exclusive, true);
+    stats_recorder::record_exclusive_start();
+    order_checker::note_acquire(lock_mode::exclusive);
   }
 
-  void upgrade_mutex::unlock()
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::lock_slow()
   {
+    if (wait_policy::spin_until([this]
+                                { return try_acquire_exclusive(true); }))
+      return;
+    auto parked_at = stats_recorder::stamp();
+    park_backend::park(state_, GATE2, GATE2_WAITERS_FLAG, [this]
+                       { return try_acquire_exclusive(true); });
+    // A direct handoff grants the lock without running try_acquire_exclusive(),
+    // so it has not published the flag to optimistic readers yet.
+    sequence_counter::publish_exclusive();
+    stats_recorder::record_park(GATE2, parked_at);
+  }
+
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::unlock()
+  {
+    order_checker::note_release(lock_mode::exclusive);
+    stats_recorder::record_exclusive_end();
+    if constexpr (handoff_policy::enabled)
+    {
+      if ((state_.load(std::memory_order_relaxed) & GATE2_WAITERS_FLAG) && hand_off_exclusive())
+        return;
+    }
     // Atomically clear the write flag.
-    state_.fetch_sub(WRITE_LOCKED_FLAG, std::memory_order_release);
+    notify_after_unlock(release_exclusive(0));
+  }
+
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::notify_after_unlock(state_type old_state)
+  {
+    if ((old_state & WAITER_FLAGS) == 0)
+      return; // Nobody is parked, nothing to signal.
 
     // Wake up ONE waiting writer on gate2. This prevents a thundering herd of writers.
-    gate2_.notify_one();
+    if (old_state & GATE2_WAITERS_FLAG)
+      notify_gate2(false);
 
     // Wake up ALL waiting readers and a potential upgrader on gate1.
-    gate1_.notify_all();
+    if (old_state & GATE1_WAITERS_FLAG)
+      notify_gate1();
   }
 
-  void upgrade_mutex::lock_shared()
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::lock_shared()
   {
-    std::unique_lock<std::mutex> internal_lock(internal_mutex_);
-    gate1_.wait(internal_lock, [this]
-                {
-        uint32_t current_state = state_.load(std::memory_order_relaxed);
-        // Can acquire a read lock if there's no write lock and no pending upgrade
-        if ((current_state & WRITE_LOCKED_FLAG) == 0 && (current_state & UPGRADE_PENDING_FLAG) == 0) {
-            // Attempt to increment reader count
-            uint32_t new_state = current_state + ONE_READER;
-            return state_.compare_exchange_strong(current_state, new_state, std::memory_order_acquire, std::memory_order_relaxed);
+    // Fast path: bump the reader count directly as long as no writer holds the
+    // lock and no upgrade is pending. This never touches the park backend.
+    order_checker::check_acquire(lock_mode::shared);
+    if (try_acquire_shared())
+    {
+      stats_recorder::record_acquire(lock_mode::shared, false);
+      order_checker::note_acquire(lock_mode::shared);
+      return;
+    }
+    lock_shared_slow();
+    stats_recorder::record_acquire(lock_mode::shared, true);
+    order_checker::note_acquire(lock_mode::shared);
+  }
+
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::lock_shared_slow()
+  {
+    state_type seen_phase = current_phase();
+    if (wait_policy::spin_until([&]
+                                { return try_acquire_shared(seen_phase); }))
+      return;
+    auto parked_at = stats_recorder::stamp();
+    park_backend::park(state_, GATE1, GATE1_WAITERS_FLAG, [&]
+                       { return try_acquire_shared(seen_phase); });
+    stats_recorder::record_park(GATE1, parked_at);
+  }
+
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::unlock_shared()
+  {
+    order_checker::note_release(lock_mode::shared);
+    release_shared();
+  }
+
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::release_shared()
+  {
+    if constexpr (handoff_policy::enabled)
+    {
+      // The last reader out with a writer parked turns its read lock into the
+      // write lock and passes that on, so that no new reader can slip in
+      // before the writer has been scheduled.
+      state_type current_state = state_.load(std::memory_order_relaxed);
+      while ((current_state & READER_COUNT_MASK) == ONE_READER && (current_state & GATE2_WAITERS_FLAG) &&
+             (current_state & (UPGRADE_LOCKED_FLAG | UPGRADE_PENDING_FLAG)) == 0)
+      {
+        if (state_.compare_exchange_weak(current_state, current_state - ONE_READER + WRITE_LOCKED_FLAG, std::memory_order_acq_rel, std::memory_order_relaxed))
+        {
+          if (!hand_off_exclusive())
+            notify_after_unlock(release_exclusive(0));
+          return;
         }
-        return false; });
+      }
+    }
+
+    state_type old_state = state_.fetch_sub(ONE_READER, std::memory_order_release);
+    if constexpr (reader_limit_policy::bounded)
+    {
+      // Leaving a full mutex lets one more reader in.
+      if ((old_state & READER_COUNT_MASK) == reader_limit_policy::max_readers && (old_state & GATE1_WAITERS_FLAG))
+        notify_gate1();
+    }
+    // Only the last reader can unblock anyone, and only if someone is parked on gate2.
+    if ((old_state & READER_COUNT_MASK) != ONE_READER || (old_state & GATE2_WAITERS_FLAG) == 0)
+      return;
+
+    if (old_state & UPGRADE_PENDING_FLAG)
+    {
+      // The upgrader is draining readers. It shares gate2 with plain writers, so
+      // wake everyone to make sure it is among the woken threads.
+      notify_gate2(true);
+    }
+    else if ((old_state & UPGRADE_LOCKED_FLAG) == 0)
+    {
+      // We were the last lock holder, wake up a writer.
+      notify_gate2(false);
+    }
   }
 
-  void upgrade_mutex::unlock_shared()
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::lock_upgrade()
   {
-    uint32_t old_state = state_.fetch_sub(ONE_READER, std::memory_order_release);
-    // If we were the last lock holder (last reader and no upgrader), wake up a writer.
-    if ((old_state & READER_COUNT_MASK) == ONE_READER && (old_state & UPGRADE_LOCKED_FLAG) == 0)
+    static_assert(upgrade_policy::enabled, "lock_upgrade() is not available under no_upgrade");
+    // Fast path: OR-in the upgrade flag as long as there is no writer and no
+    // other upgrader. Readers may be present.
+    order_checker::check_acquire(lock_mode::upgrade);
+    if (try_acquire_upgrade())
     {
-      gate2_.notify_one();
+      stats_recorder::record_acquire(lock_mode::upgrade, false);
+      stats_recorder::record_upgrade_start();
+      order_checker::note_acquire(lock_mode::upgrade);
+      return;
     }
+    lock_upgrade_slow();
+    stats_recorder::record_acquire(lock_mode::upgrade, true);
+    stats_recorder::record_upgrade_start();
+    order_checker::note_acquire(lock_mode::upgrade);
   }
 
-  void upgrade_mutex::lock_upgrade()
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::lock_upgrade_slow()
   {
-    std::unique_lock<std::mutex> internal_lock(internal_mutex_);
-    gate1_.wait(internal_lock, [this]
-                {
-        uint32_t current_state = state_.load(std::memory_order_relaxed);
-        // Can acquire if no write lock and no other upgrade lock is held
-        if ((current_state & WRITE_LOCKED_FLAG) == 0 && (current_state & UPGRADE_LOCKED_FLAG) == 0) {
-            uint32_t new_state = current_state | UPGRADE_LOCKED_FLAG;
-            return state_.compare_exchange_strong(current_state, new_state, std::memory_order_acquire, std::memory_order_relaxed);
-        }
-        return false; });
+    state_type seen_phase = current_phase();
+    if (wait_policy::spin_until([&]
+                                { return try_acquire_upgrade(seen_phase); }))
+      return;
+    auto parked_at = stats_recorder::stamp();
+    park_backend::park(state_, GATE1, GATE1_WAITERS_FLAG, [&]
+                       { return try_acquire_upgrade(seen_phase); });
+    stats_recorder::record_park(GATE1, parked_at);
   }
 
-  void upgrade_mutex::unlock_upgrade()
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::unlock_upgrade()
   {
-    uint32_t old_state = state_.fetch_sub(UPGRADE_LOCKED_FLAG, std::memory_order_release);
+    static_assert(upgrade_policy::enabled, "unlock_upgrade() is not available under no_upgrade");
+    order_checker::note_release(lock_mode::upgrade);
+    stats_recorder::record_upgrade_end();
+    state_type old_state = state_.fetch_sub(UPGRADE_LOCKED_FLAG, std::memory_order_release);
+    if ((old_state & WAITER_FLAGS) == 0)
+      return; // Nobody is parked, nothing to signal.
 
     // If releasing this upgrade lock makes the mutex completely free (no readers were present),
     // then a waiting exclusive writer can proceed.
-    if ((old_state & READER_COUNT_MASK) == 0)
+    if ((old_state & READER_COUNT_MASK) == 0 && (old_state & GATE2_WAITERS_FLAG))
     {
-      gate2_.notify_one();
+      notify_gate2(false);
     }
 
     // Notify waiting threads on gate1. This allows a new upgrader or waiting readers
     // to contend for the lock now that the previous upgrade lock has been released.
-    gate1_.notify_all();
+    if (old_state & GATE1_WAITERS_FLAG)
+      notify_gate1();
+  }
+
+  template <typename... Policies>
+  inline bool basic_upgrade_mutex<Policies...>::try_lock()
+  {
+    if (!try_acquire_exclusive())
+      return false;
+    stats_recorder::record_acquire(lock_mode::exclusive, false);
+    stats_recorder::record_exclusive_start();
+    order_checker::note_acquire(lock_mode::exclusive);
+    return true;
+  }
+
+  template <typename... Policies>
+  inline bool basic_upgrade_mutex<Policies...>::try_lock_shared()
+  {
+    if (!try_acquire_shared())
+      return false;
+    stats_recorder::record_acquire(lock_mode::shared, false);
+    order_checker::note_acquire(lock_mode::shared);
+    return true;
+  }
+
+  template <typename... Policies>
+  inline bool basic_upgrade_mutex<Policies...>::try_lock_upgrade()
+  {
+    static_assert(upgrade_policy::enabled, "try_lock_upgrade() is not available under no_upgrade");
+    if (!try_acquire_upgrade())
+      return false;
+    stats_recorder::record_acquire(lock_mode::upgrade, false);
+    stats_recorder::record_upgrade_start();
+    order_checker::note_acquire(lock_mode::upgrade);
+    return true;
+  }
+
+  template <typename... Policies>
+  template <typename Rep, typename Period>
+  inline bool basic_upgrade_mutex<Policies...>::try_lock_for(const std::chrono::duration<Rep, Period> &timeout)
+  {
+    return try_lock_until(std::chrono::steady_clock::now() + timeout);
+  }
+
+  template <typename... Policies>
+  template <typename Clock, typename Duration>
+  inline bool basic_upgrade_mutex<Policies...>::try_lock_until(const std::chrono::time_point<Clock, Duration> &deadline)
+  {
+    order_checker::check_acquire(lock_mode::exclusive);
+    bool fast = try_acquire_exclusive(true);
+    if (fast || acquire_until(GATE2, GATE2_WAITERS_FLAG, deadline, [this]
+                              { return try_acquire_exclusive(true); }))
+    {
+      if (!fast)
+        sequence_counter::publish_exclusive(); // May have been a direct handoff, as in lock_slow()
+      stats_recorder::record_acquire(lock_mode::exclusive, !fast);
+      stats_recorder::record_exclusive_start();
+      order_checker::note_acquire(lock_mode::exclusive);
+      return true;
+    }
+    abandon_write_pending();
+    return false;
+  }
+
+  template <typename... Policies>
+  template <typename Rep, typename Period>
+  inline bool basic_upgrade_mutex<Policies...>::try_lock_shared_for(const std::chrono::duration<Rep, Period> &timeout)
+  {
+    return try_lock_shared_until(std::chrono::steady_clock::now() + timeout);
+  }
+
+  template <typename... Policies>
+  template <typename Clock, typename Duration>
+  inline bool basic_upgrade_mutex<Policies...>::try_lock_shared_until(const std::chrono::time_point<Clock, Duration> &deadline)
+  {
+    order_checker::check_acquire(lock_mode::shared);
+    state_type seen_phase = current_phase();
+    bool fast = try_acquire_shared(seen_phase);
+    if (fast || acquire_until(GATE1, GATE1_WAITERS_FLAG, deadline, [&]
+                              { return try_acquire_shared(seen_phase); }))
+    {
+      stats_recorder::record_acquire(lock_mode::shared, !fast);
+      order_checker::note_acquire(lock_mode::shared);
+      return true;
+    }
+    if constexpr (fairness_policy::alternates_phases)
+    {
+      // We may have been the last reader a writer was yielding its turn to.
+      if (state_.load(std::memory_order_relaxed) & GATE2_WAITERS_FLAG)
+        notify_gate2(false);
+    }
+    return false;
+  }
+
+  template <typename... Policies>
+  template <typename Rep, typename Period>
+  inline bool basic_upgrade_mutex<Policies...>::try_lock_upgrade_for(const std::chrono::duration<Rep, Period> &timeout)
+  {
+    return try_lock_upgrade_until(std::chrono::steady_clock::now() + timeout);
+  }
+
+  template <typename... Policies>
+  template <typename Clock, typename Duration>
+  inline bool basic_upgrade_mutex<Policies...>::try_lock_upgrade_until(const std::chrono::time_point<Clock, Duration> &deadline)
+  {
+    static_assert(upgrade_policy::enabled, "try_lock_upgrade_until() is not available under no_upgrade");
+    order_checker::check_acquire(lock_mode::upgrade);
+    state_type seen_phase = current_phase();
+    bool fast = try_acquire_upgrade(seen_phase);
+    if (fast || acquire_until(GATE1, GATE1_WAITERS_FLAG, deadline, [&]
+                              { return try_acquire_upgrade(seen_phase); }))
+    {
+      stats_recorder::record_acquire(lock_mode::upgrade, !fast);
+      stats_recorder::record_upgrade_start();
+      order_checker::note_acquire(lock_mode::upgrade);
+      return true;
+    }
+    if constexpr (fairness_policy::alternates_phases)
+    {
+      if (state_.load(std::memory_order_relaxed) & GATE2_WAITERS_FLAG)
+        notify_gate2(false);
+    }
+    return false;
+  }
+
+  template <typename... Policies>
+  inline bool basic_upgrade_mutex<Policies...>::try_upgrade_from_shared()
+  {
+    static_assert(upgrade_policy::enabled, "try_upgrade_from_shared() is not available under no_upgrade");
+    // Trade our reader for the upgrade flag. Readers never block the upgrade
+    // lock, so only another upgrader (and, as for try_lock_upgrade(), a
+    // waiting writer outside a readers' turn) refuses it, and the upgrader
+    // ends the readers' turn. If we were the last reader, waiters on gate2 are
+    // still blocked by the upgrade flag, so nobody needs to be notified.
+    state_type current_state = state_.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      state_type blocked_by = UPGRADE_LOCKED_FLAG;
+      if constexpr (fairness_policy::blocks_new_readers)
+      {
+        if (!(current_state & READER_TURN_FLAG))
+          blocked_by |= WRITE_PENDING_FLAG;
+      }
+      if (current_state & blocked_by)
+        return false;
+      if (state_.compare_exchange_weak(current_state, ((current_state - ONE_READER) | UPGRADE_LOCKED_FLAG) & ~READER_TURN_FLAG, std::memory_order_acquire, std::memory_order_relaxed))
+      {
+        if constexpr (reader_limit_policy::bounded)
+        {
+          if ((current_state & READER_COUNT_MASK) == reader_limit_policy::max_readers && (current_state & GATE1_WAITERS_FLAG))
+            notify_gate1();
+        }
+        stats_recorder::record_acquire(lock_mode::upgrade, false);
+        stats_recorder::record_upgrade_start();
+        order_checker::note_convert(lock_mode::shared, lock_mode::upgrade);
+        return true;
+      }
+    }
+  }
+
+  // --- Optimistic Reads ---
+  // The reader loads the version, then the state. The writer sets
+  // WRITE_LOCKED_FLAG before (release fence) its data stores, and bumps the
+  // version before (release RMW) clearing the flag. A reader that observed any
+  // data store therefore sees either the flag or the bumped version when it
+  // validates.
+
+  template <typename... Policies>
+  inline uint32_t basic_upgrade_mutex<Policies...>::read_begin()
+  {
+    static_assert(optimistic_read_policy::enabled, "read_begin() requires the optimistic_reads policy");
+    for (;;)
+    {
+      uint32_t version = this->version_.load(std::memory_order_acquire);
+      if ((state_.load(std::memory_order_acquire) & WRITE_LOCKED_FLAG) == 0)
+        return version;
+
+      // A writer is active. Wait for it like a reader would; if the spin
+      // budget runs out, park behind it with a shared lock round trip.
+      if (!wait_policy::spin_until([this]
+                                   { return (state_.load(std::memory_order_relaxed) & WRITE_LOCKED_FLAG) == 0; }))
+        wait_out_writer();
+    }
+  }
+
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::wait_out_writer()
+  {
+    // The round trip is a real shared acquisition, so that under phase_fair
+    // it ends the readers' turn and the release wakes a parked writer, like
+    // any reader's would. It is just not reported as one.
+    state_type seen_phase = current_phase();
+    auto try_acquire = [&]
+    { return try_acquire_shared(seen_phase, false); };
+    if (!try_acquire())
+      park_backend::park(state_, GATE1, GATE1_WAITERS_FLAG, try_acquire);
+    release_shared();
+  }
+
+  template <typename... Policies>
+  inline bool basic_upgrade_mutex<Policies...>::read_validate(uint32_t token) const
+  {
+    static_assert(optimistic_read_policy::enabled, "read_validate() requires the optimistic_reads policy");
+    // Keep the reader's data loads from moving past the checks below.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (state_.load(std::memory_order_acquire) & WRITE_LOCKED_FLAG)
+      return false;
+    return this->version_.load(std::memory_order_relaxed) == token;
+  }
+
+  // --- Statistics ---
+
+  template <typename... Policies>
+  inline lock_stats basic_upgrade_mutex<Policies...>::stats() const
+  {
+    static_assert(instrumentation_policy::enabled, "stats() requires the instrumented policy");
+    return stats_recorder::snapshot();
+  }
+
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::reset_stats()
+  {
+    static_assert(instrumentation_policy::enabled, "reset_stats() requires the instrumented policy");
+    stats_recorder::clear();
   }
 
   // --- Internal Transition Method Implementations ---
 
-  void upgrade_mutex::upgrade_to_unique()
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::upgrade_to_unique()
   {
-    std::unique_lock<std::mutex> internal_lock(internal_mutex_);
+    static_assert(upgrade_policy::enabled, "Upgrading to exclusive is not available under no_upgrade");
+    order_checker::check_convert();
     // Signal that an upgrade is pending to block new readers
-    state_.fetch_or(UPGRADE_PENDING_FLAG, std::memory_order_acquire);
+    auto pending_since = stats_recorder::stamp();
+    state_.fetch_or(UPGRADE_PENDING_FLAG, std::memory_order_relaxed);
 
     // Wait until all current readers are finished
-    gate2_.wait(internal_lock, [this]
-                { return (state_.load(std::memory_order_relaxed) & READER_COUNT_MASK) == 0; });
+    if (!wait_policy::spin_until([this]
+                                 { return readers_drained(); }))
+    {
+      auto parked_at = stats_recorder::stamp();
+      park_backend::park(state_, GATE2, GATE2_WAITERS_FLAG, [this]
+                         { return readers_drained(); });
+      stats_recorder::record_park(GATE2, parked_at);
+    }
 
     // Atomically swap upgrade and pending flags for the write flag
-    state_.store(WRITE_LOCKED_FLAG, std::memory_order_release);
+    state_.fetch_xor(UPGRADE_LOCKED_FLAG | UPGRADE_PENDING_FLAG | WRITE_LOCKED_FLAG, std::memory_order_acquire);
+    sequence_counter::publish_exclusive();
+    record_upgraded(pending_since, true);
+    order_checker::note_convert(lock_mode::upgrade, lock_mode::exclusive);
+  }
+
+  template <typename... Policies>
+  inline bool basic_upgrade_mutex<Policies...>::try_upgrade_to_unique()
+  {
+    static_assert(upgrade_policy::enabled, "Upgrading to exclusive is not available under no_upgrade");
+    // Succeeds only if no readers are present right now. The pending flag is
+    // never set, so a failed attempt leaves readers and the upgrade lock alone.
+    auto started_at = stats_recorder::stamp();
+    state_type current_state = state_.load(std::memory_order_relaxed);
+    while ((current_state & READER_COUNT_MASK) == 0)
+    {
+      if (state_.compare_exchange_weak(current_state, current_state ^ (UPGRADE_LOCKED_FLAG | WRITE_LOCKED_FLAG), std::memory_order_acquire, std::memory_order_relaxed))
+      {
+        sequence_counter::publish_exclusive();
+        record_upgraded(started_at, true, false);
+        order_checker::note_convert(lock_mode::upgrade, lock_mode::exclusive);
+        return true;
+      }
+    }
+    record_upgraded(started_at, false, false);
+    return false;
   }
 
-  void upgrade_mutex::unique_to_upgrade()
+  template <typename... Policies>
+  template <typename Clock, typename Duration>
+  inline bool basic_upgrade_mutex<Policies...>::try_upgrade_to_unique_until(const std::chrono::time_point<Clock, Duration> &deadline)
   {
+    static_assert(upgrade_policy::enabled, "Upgrading to exclusive is not available under no_upgrade");
+    order_checker::check_convert();
+    // Signal that an upgrade is pending to block new readers
+    auto pending_since = stats_recorder::stamp();
+    state_.fetch_or(UPGRADE_PENDING_FLAG, std::memory_order_relaxed);
+
+    if (readers_drained() || acquire_until(GATE2, GATE2_WAITERS_FLAG, deadline, [this]
+                                           { return readers_drained(); }))
+    {
+      state_.fetch_xor(UPGRADE_LOCKED_FLAG | UPGRADE_PENDING_FLAG | WRITE_LOCKED_FLAG, std::memory_order_acquire);
+      sequence_counter::publish_exclusive();
+      record_upgraded(pending_since, true);
+      order_checker::note_convert(lock_mode::upgrade, lock_mode::exclusive);
+      return true;
+    }
+
+    // Abandon the upgrade. Readers that blocked on the pending flag must not
+    // stay starved, so let them in again.
+    state_type old_state = state_.fetch_and(~UPGRADE_PENDING_FLAG, std::memory_order_release);
+    record_upgraded(pending_since, false);
+    if (old_state & GATE1_WAITERS_FLAG)
+      notify_gate1();
+    return false;
+  }
+
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::unique_to_upgrade()
+  {
+    static_assert(upgrade_policy::enabled, "Downgrading to upgrade is not available under no_upgrade");
     // Atomically swap write flag for upgrade flag
-    state_.store(UPGRADE_LOCKED_FLAG, std::memory_order_release);
+    order_checker::note_convert(lock_mode::exclusive, lock_mode::upgrade);
+    stats_recorder::record_exclusive_end();
+    stats_recorder::record_upgrade_start();
+    state_type old_state = release_exclusive(UPGRADE_LOCKED_FLAG);
     // Wake up any waiting readers
-    gate1_.notify_all();
+    if (old_state & GATE1_WAITERS_FLAG)
+      notify_gate1();
   }
 
-  void upgrade_mutex::unique_to_shared()
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::unique_to_shared()
   {
     // Atomically swap write flag for a single reader
-    state_.store(ONE_READER, std::memory_order_release);
+    order_checker::note_convert(lock_mode::exclusive, lock_mode::shared);
+    stats_recorder::record_exclusive_end();
+    state_type old_state = release_exclusive(ONE_READER);
     // Wake up any waiting readers
-    gate1_.notify_all();
+    if (old_state & GATE1_WAITERS_FLAG)
+      notify_gate1();
   }
 
-  void upgrade_mutex::scoped_upgrade_entry()
+  template <typename... Policies>
+  inline bool basic_upgrade_mutex<Policies...>::try_shared_to_unique()
+  {
+    // Succeeds only while our reader is the only holder, on the same terms as
+    // try_acquire_exclusive(): under phase_fair, readers released by the
+    // previous writer and still parked on gate1 keep their turn.
+    state_type current_state = state_.load(std::memory_order_relaxed);
+    while ((current_state & ~(WAITER_FLAGS | FAIRNESS_FLAGS)) == ONE_READER)
+    {
+      if constexpr (fairness_policy::alternates_phases)
+      {
+        if ((current_state & READER_TURN_FLAG) && (current_state & GATE1_WAITERS_FLAG))
+          return false;
+      }
+      state_type desired = ((current_state - ONE_READER) & ~(WRITE_PENDING_FLAG | READER_TURN_FLAG)) | WRITE_LOCKED_FLAG;
+      if (state_.compare_exchange_weak(current_state, desired, std::memory_order_acquire, std::memory_order_relaxed))
+      {
+        sequence_counter::publish_exclusive();
+        stats_recorder::record_acquire(lock_mode::exclusive, false);
+        stats_recorder::record_exclusive_start();
+        order_checker::note_convert(lock_mode::shared, lock_mode::exclusive);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::scoped_upgrade_entry()
   {
     // This is identical to a full upgrade
     upgrade_to_unique();
   }
 
-  void upgrade_mutex::scoped_upgrade_exit()
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::scoped_upgrade_exit()
   {
     // This is identical to a downgrade to upgradeable
     unique_to_upgrade();
   }
 
+  // --- Single-Attempt Acquisition ---
+  // Each helper loads the state first and only issues a CAS when the lock is
+  // actually available, so spinning threads do not bounce the cache line.
+
+  template <typename... Policies>
+  inline bool basic_upgrade_mutex<Policies...>::try_acquire_exclusive(bool announce)
+  {
+    // Can acquire if no other locks are held. Parked waiters may be present,
+    // and the fairness bits do not count as holders, except that under
+    // phase_fair the readers released by the previous writer go first.
+    state_type current_state = state_.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      state_type holders = current_state & ~(WAITER_FLAGS | FAIRNESS_FLAGS);
+      if constexpr (fairness_policy::alternates_phases)
+      {
+        if ((current_state & READER_TURN_FLAG) && (current_state & GATE1_WAITERS_FLAG))
+          holders |= READER_TURN_FLAG;
+      }
+      if (holders == 0)
+      {
+        state_type desired = (current_state & ~(WRITE_PENDING_FLAG | READER_TURN_FLAG)) | WRITE_LOCKED_FLAG;
+        if (state_.compare_exchange_strong(current_state, desired, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+          sequence_counter::publish_exclusive();
+          return true;
+        }
+        continue;
+      }
+
+      // Busy. A waiting writer announces itself so that new readers hold off.
+      if (!fairness_policy::blocks_new_readers || !announce || (current_state & WRITE_PENDING_FLAG))
+        return false;
+      if (state_.compare_exchange_weak(current_state, current_state | WRITE_PENDING_FLAG, std::memory_order_relaxed, std::memory_order_relaxed))
+        return false;
+    }
+  }
+
+  template <typename... Policies>
+  inline bool basic_upgrade_mutex<Policies...>::try_acquire_shared()
+  {
+    state_type seen_phase = current_phase();
+    return try_acquire_shared(seen_phase);
+  }
+
+  template <typename... Policies>
+  inline bool basic_upgrade_mutex<Policies...>::try_acquire_shared(state_type &seen_phase, bool record_peak)
+  {
+    // Can acquire a read lock if there's no write lock and no pending upgrade
+    // (nor, with writer_preferring / phase_fair, a pending writer).
+    // Retry while only the reader count or waiter flags are changing.
+    state_type current_state = state_.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      state_type blocked_by = WRITE_LOCKED_FLAG | UPGRADE_PENDING_FLAG;
+      if constexpr (fairness_policy::blocks_new_readers)
+      {
+        // Under phase_fair, a reader that queued behind a writer which has
+        // since finished belongs to the batch that goes before the next one.
+        bool readers_turn = (current_state & READER_TURN_FLAG) || (current_state & PHASE_FLAG) != seen_phase;
+        if (!readers_turn)
+          blocked_by |= WRITE_PENDING_FLAG;
+      }
+      if (current_state & blocked_by)
+      {
+        if (current_state & WRITE_LOCKED_FLAG)
+          seen_phase = current_state & PHASE_FLAG;
+        return false;
+      }
+      if constexpr (reader_limit_policy::bounded)
+      {
+        // Wait on gate1 until a reader leaves; unlock_shared() wakes us.
+        if ((current_state & READER_COUNT_MASK) >= reader_limit_policy::max_readers)
+          return false;
+      }
+      assert((current_state & READER_COUNT_MASK) != READER_COUNT_MASK && "reader count overflow");
+      // The first reader in ends the readers' turn; the rest of its batch
+      // still gets past a pending writer through the phase parity.
+      state_type desired = (current_state + ONE_READER) & ~READER_TURN_FLAG;
+      if (state_.compare_exchange_weak(current_state, desired, std::memory_order_acquire, std::memory_order_relaxed))
+      {
+        if (record_peak)
+        {
+          state_type readers = desired & READER_COUNT_MASK;
+          stats_recorder::record_readers(readers < UINT32_MAX ? static_cast<uint32_t>(readers) : UINT32_MAX);
+        }
+        return true;
+      }
+    }
+  }
+
+  template <typename... Policies>
+  inline bool basic_upgrade_mutex<Policies...>::try_acquire_upgrade()
+  {
+    state_type seen_phase = current_phase();
+    return try_acquire_upgrade(seen_phase);
+  }
+
+  template <typename... Policies>
+  inline bool basic_upgrade_mutex<Policies...>::try_acquire_upgrade(state_type &seen_phase)
+  {
+    // Can acquire if no write lock and no other upgrade lock is held (and, as
+    // for readers, no writer is pending unless it is the readers' turn).
+    state_type current_state = state_.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      state_type blocked_by = WRITE_LOCKED_FLAG | UPGRADE_LOCKED_FLAG;
+      if constexpr (fairness_policy::blocks_new_readers)
+      {
+        bool readers_turn = (current_state & READER_TURN_FLAG) || (current_state & PHASE_FLAG) != seen_phase;
+        if (!readers_turn)
+          blocked_by |= WRITE_PENDING_FLAG;
+      }
+      if (current_state & blocked_by)
+      {
+        if (current_state & WRITE_LOCKED_FLAG)
+          seen_phase = current_state & PHASE_FLAG;
+        return false;
+      }
+      // Like the first reader, the upgrader ends the readers' turn.
+      state_type desired = (current_state | UPGRADE_LOCKED_FLAG) & ~READER_TURN_FLAG;
+      if (state_.compare_exchange_weak(current_state, desired, std::memory_order_acquire, std::memory_order_relaxed))
+        return true;
+    }
+  }
+
+  template <typename... Policies>
+  inline bool basic_upgrade_mutex<Policies...>::readers_drained() const
+  {
+    return (state_.load(std::memory_order_relaxed) & READER_COUNT_MASK) == 0;
+  }
+
+  template <typename... Policies>
+  inline typename basic_upgrade_mutex<Policies...>::state_type basic_upgrade_mutex<Policies...>::current_phase() const
+  {
+    if constexpr (fairness_policy::alternates_phases)
+      return state_.load(std::memory_order_relaxed) & PHASE_FLAG;
+    else
+      return 0;
+  }
+
+  // --- Exclusive Release ---
+
+  template <typename... Policies>
+  inline typename basic_upgrade_mutex<Policies...>::state_type basic_upgrade_mutex<Policies...>::release_exclusive(state_type replacement)
+  {
+    sequence_counter::bump_version();
+    if constexpr (!fairness_policy::alternates_phases)
+    {
+      return state_.fetch_add(replacement - WRITE_LOCKED_FLAG, std::memory_order_release);
+    }
+    else
+    {
+      // End the writer phase: flip the parity, so readers that queued behind
+      // this writer get past a pending one, and if any of them are parked,
+      // hold writers off until they have left the gate.
+      state_type current_state = state_.load(std::memory_order_relaxed);
+      state_type desired;
+      do
+      {
+        desired = (current_state + replacement - WRITE_LOCKED_FLAG) ^ PHASE_FLAG;
+        if (current_state & GATE1_WAITERS_FLAG)
+          desired |= READER_TURN_FLAG;
+      } while (!state_.compare_exchange_weak(current_state, desired, std::memory_order_release, std::memory_order_relaxed));
+      return current_state;
+    }
+  }
+
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::abandon_write_pending()
+  {
+    // A timed-out writer withdraws its announcement and lets in the readers it
+    // blocked. Other waiting writers announce themselves again on their next
+    // attempt.
+    if constexpr (fairness_policy::blocks_new_readers)
+    {
+      state_type old_state = state_.fetch_and(~WRITE_PENDING_FLAG, std::memory_order_relaxed);
+      if ((old_state & WRITE_PENDING_FLAG) && (old_state & GATE1_WAITERS_FLAG))
+        notify_gate1();
+    }
+  }
+
+  // --- Statistics Helpers ---
+
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::record_upgraded(typename stats_recorder::stamp_t since, bool converted, bool pending)
+  {
+    stats_recorder::record_upgrade_result(since, converted, pending);
+    if (converted)
+    {
+      stats_recorder::record_upgrade_end();
+      stats_recorder::record_exclusive_start();
+    }
+  }
+
+  // --- Direct Handoff ---
+
+  template <typename... Policies>
+  inline bool basic_upgrade_mutex<Policies...>::hand_off_exclusive()
+  {
+    // WRITE_LOCKED_FLAG stays set throughout, so barging threads keep failing.
+    // The new owner synchronizes with us through the backend's internal mutex;
+    // its caller then runs publish_exclusive() for the optimistic readers.
+    return park_backend::hand_off(state_, GATE2, [this]
+                                  {
+      // Everything an exclusive release does except clearing the flag: end
+      // the optimistic readers' version, withdraw the writers' announcement
+      // (other parked writers renew it when they next retry) and, under
+      // phase_fair, end the writer phase. No reader is parked, so there is
+      // no readers' turn to grant.
+      sequence_counter::bump_version();
+      if constexpr (fairness_policy::blocks_new_readers)
+        state_.fetch_and(~WRITE_PENDING_FLAG, std::memory_order_relaxed);
+      if constexpr (fairness_policy::alternates_phases)
+        state_.fetch_xor(PHASE_FLAG, std::memory_order_relaxed); });
+  }
+
+  // --- Timed Waiting ---
+
+  template <typename... Policies>
+  template <typename Clock, typename Duration, typename TryAcquire>
+  inline bool basic_upgrade_mutex<Policies...>::acquire_until(int gate, state_type waiters_flag, const std::chrono::time_point<Clock, Duration> &deadline, TryAcquire try_acquire)
+  {
+    // Spin under the wait policy, but treat the deadline as an exit condition
+    // too, so that even pure_spin gives up in time.
+    bool acquired = false;
+    if (wait_policy::spin_until([&]
+                                { return (acquired = try_acquire()) || Clock::now() >= deadline; }))
+      return acquired;
+    auto parked_at = stats_recorder::stamp();
+    bool parked_acquired = park_backend::park_until(state_, gate, waiters_flag, deadline, try_acquire);
+    stats_recorder::record_park(gate, parked_at);
+    return parked_acquired;
+  }
+
+  // --- Notification Helpers ---
+
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::notify_gate1()
+  {
+    park_backend::notify(state_, GATE1, GATE1_WAITERS_FLAG, true);
+  }
+
+  template <typename... Policies>
+  inline void basic_upgrade_mutex<Policies...>::notify_gate2(bool all)
+  {
+    park_backend::notify(state_, GATE2, GATE2_WAITERS_FLAG, all);
+  }
+
 } // namespace sync_prim
@@ -0,0 +1,183 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <thread>
+#include <type_traits>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace sync_prim
+{
+
+  // --- Policy Selection ---
+
+  /**
+   * @brief Category tag shared by all wait policies.
+   *
+   * Every policy accepted by basic_upgrade_mutex exposes a `policy_category`
+   * typedef, which lets the mutex pick out the policies it cares about
+   * regardless of the order in which they were listed.
+   */
+  struct wait_policy_tag
+  {
+  };
+
+  namespace detail
+  {
+    template <typename T>
+    struct type_identity
+    {
+      using type = T;
+    };
+
+    template <typename Category, typename Default, typename... Policies>
+    struct select_policy : type_identity<Default>
+    {
+    };
+
+    template <typename Category, typename Default, typename First, typename... Rest>
+    struct select_policy<Category, Default, First, Rest...>
+        : std::conditional_t<std::is_same_v<typename First::policy_category, Category>,
+                             type_identity<First>,
+                             select_policy<Category, Default, Rest...>>
+    {
+    };
+
+    // The first policy of the given category, or Default if none was listed.
+    template <typename Category, typename Default, typename... Policies>
+    using select_policy_t = typename select_policy<Category, Default, Policies...>::type;
+
+    /**
+     * @brief Hints to the CPU that we are in a spin-wait loop.
+     */
+    inline void cpu_relax() noexcept
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+      _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+      asm volatile("yield" ::: "memory");
+#endif
+    }
+
+    /**
+     * @brief Exponential backoff: pauses 2^round times.
+     */
+    inline void backoff(unsigned round) noexcept
+    {
+      for (unsigned i = 0, n = 1u << round; i < n; ++i)
+        cpu_relax();
+    }
+  } // namespace detail
+
+  // --- Wait Policies ---
+  // A wait policy decides what a thread does between a failed fast-path
+  // attempt and parking on the mutex's gates. It provides:
+  //   - `parks`: whether the mutex may ever put the thread to sleep.
+  //   - `spin_until(try_acquire)`: retries `try_acquire` and returns true as
+  //     soon as it succeeds, or false once the spin budget is exhausted.
+
+  /**
+   * @brief Never parks. Spins with exponential backoff, then keeps yielding
+   * the CPU until the lock is acquired.
+   *
+   * Best for very short critical sections with fewer threads than cores.
+   */
+  template <unsigned MaxBackoffRound = 8>
+  struct pure_spin_policy
+  {
+    using policy_category = wait_policy_tag;
+    static constexpr bool parks = false;
+
+    template <typename TryAcquire>
+    static bool spin_until(TryAcquire try_acquire)
+    {
+      for (unsigned round = 0; !try_acquire();)
+      {
+        if (round < MaxBackoffRound)
+          detail::backoff(round++);
+        else
+          std::this_thread::yield();
+      }
+      return true;
+    }
+  };
+
+  /**
+   * @brief Spins with exponential backoff for SpinRounds rounds, yields for
+   * YieldRounds rounds, and only then parks.
+   *
+   * This is the default: short handoffs never pay for a context switch, while
+   * long waits still release the CPU.
+   */
+  template <unsigned SpinRounds = 8, unsigned YieldRounds = 4>
+  struct spin_then_park_policy
+  {
+    using policy_category = wait_policy_tag;
+    static constexpr bool parks = true;
+
+    template <typename TryAcquire>
+    static bool spin_until(TryAcquire try_acquire)
+    {
+      for (unsigned round = 0; round < SpinRounds; ++round)
+      {
+        if (try_acquire())
+          return true;
+        detail::backoff(round);
+      }
+      for (unsigned round = 0; round < YieldRounds; ++round)
+      {
+        if (try_acquire())
+          return true;
+        std::this_thread::yield();
+      }
+      return try_acquire();
+    }
+  };
+
+  /**
+   * @brief Parks as soon as the fast path fails. This was the behavior of
+   * upgrade_mutex before wait policies were introduced.
+   */
+  struct immediate_park_policy
+  {
+    using policy_category = wait_policy_tag;
+    static constexpr bool parks = true;
+
+    template <typename TryAcquire>
+    static bool spin_until(TryAcquire try_acquire)
+    {
+      return try_acquire();
+    }
+  };
+
+  using pure_spin = pure_spin_policy<>;
+  using spin_then_park = spin_then_park_policy<>;
+  using immediate_park = immediate_park_policy;
+
+} // namespace sync_prim
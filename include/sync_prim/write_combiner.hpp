@@ -0,0 +1,213 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "sync_prim/cache_line.hpp"
+#include "sync_prim/upgrade_mutex.hpp"
+
+namespace sync_prim
+{
+
+  namespace detail
+  {
+    // A queued mutation. It lives in the submitting thread's stack frame, and
+    // the combiner must not touch it after setting `done`.
+    struct combined_write
+    {
+      void (*run)(combined_write *) noexcept = nullptr;
+      combined_write *next = nullptr;
+      std::atomic<bool> done{false};
+    };
+
+    template <typename F, typename R>
+    struct combined_write_op : combined_write
+    {
+      explicit combined_write_op(F &fn) noexcept : fn_(fn) { run = &invoke; }
+
+      static void invoke(combined_write *base) noexcept
+      {
+        auto *self = static_cast<combined_write_op *>(base);
+        try
+        {
+          if constexpr (std::is_void_v<R>)
+            self->fn_();
+          else
+            self->result_.emplace(self->fn_());
+        }
+        catch (...)
+        {
+          self->error_ = std::current_exception();
+        }
+      }
+
+      R take()
+      {
+        if (error_)
+          std::rethrow_exception(error_);
+        if constexpr (!std::is_void_v<R>)
+          return std::move(*result_);
+      }
+
+      F &fn_;
+      std::conditional_t<std::is_void_v<R>, char, std::optional<R>> result_{};
+      std::exception_ptr error_;
+    };
+  } // namespace detail
+
+  /**
+   * @class write_combiner
+   * @brief Coalesces writes from many threads into one exclusive section.
+   *
+   * submit_write(fn) pushes fn onto a lock-free stack and waits for the
+   * upgrade lock. Whichever thread gets it first takes every queued write,
+   * upgrades once, runs them in arrival order, and downgrades again. The
+   * other submitters then find their writes done and return at once with
+   * the results. N threads that saw the same stale data pay one reader
+   * drain instead of N.
+   *
+   *   sync_prim::write_combiner<> combiner(mtx);
+   *   int version = combiner.submit_write([&] { return cache.refresh(); });
+   *
+   * The caller must not hold a lock on the mutex. Writes run on whichever
+   * thread combines, so they must not depend on thread-local state.
+   * Exceptions are rethrown in the thread that submitted the write.
+   */
+  template <typename Mutex = upgrade_mutex>
+  class write_combiner
+  {
+  public:
+    using mutex_type = Mutex;
+
+    // Passes made while exclusive. Writes submitted during the last pass wait
+    // for the next combiner, so a steady stream cannot starve readers.
+    static constexpr int max_passes = 4;
+
+    explicit write_combiner(Mutex &mtx) noexcept : mutex_(mtx) {}
+
+    write_combiner(const write_combiner &) = delete;
+    write_combiner &operator=(const write_combiner &) = delete;
+
+    /**
+     * @brief Runs fn() under the exclusive lock, possibly on another thread,
+     * and returns its result.
+     */
+    template <typename F>
+    std::invoke_result_t<F &> submit_write(F &&fn);
+
+    /**
+     * @brief Runs every queued write under one exclusive section.
+     *
+     * `lock` must own the upgrade lock and still owns it on return. Returns
+     * the number of writes applied; with none queued, the lock is not
+     * converted.
+     */
+    std::size_t combine(upgrade_lock<Mutex> &lock);
+
+    Mutex &mutex() const noexcept { return mutex_; }
+
+  private:
+    static std::size_t run_all(detail::combined_write *head) noexcept;
+
+    Mutex &mutex_;
+    alignas(cache_line_size) std::atomic<detail::combined_write *> pending_{nullptr};
+  };
+
+  // --- write_combiner Method Implementations ---
+
+  template <typename Mutex>
+  template <typename F>
+  inline std::invoke_result_t<F &> write_combiner<Mutex>::submit_write(F &&fn)
+  {
+    using result_type = std::invoke_result_t<F &>;
+    static_assert(!std::is_reference_v<result_type>, "submit_write: fn must return by value; the lock is gone when it returns");
+
+    detail::combined_write_op<std::remove_reference_t<F>, result_type> op(fn);
+    detail::combined_write *head = pending_.load(std::memory_order_relaxed);
+    do
+    {
+      op.next = head;
+    } while (!pending_.compare_exchange_weak(head, &op, std::memory_order_release, std::memory_order_relaxed));
+
+    // A combiner holds the upgrade lock from taking the stack until it has
+    // finished every write on it, so once we own the lock our write is
+    // either done or still queued.
+    {
+      upgrade_lock<Mutex> lock(mutex_);
+      if (!op.done.load(std::memory_order_acquire))
+        combine(lock);
+    }
+    return op.take();
+  }
+
+  template <typename Mutex>
+  inline std::size_t write_combiner<Mutex>::combine(upgrade_lock<Mutex> &lock)
+  {
+    detail::combined_write *head = pending_.exchange(nullptr, std::memory_order_acquire);
+    if (!head)
+      return 0;
+
+    std::size_t applied = 0;
+    unique_lock<Mutex> x_lock(std::move(lock));
+    for (int pass = 0; head && pass < max_passes; ++pass)
+    {
+      applied += run_all(head);
+      head = pass + 1 < max_passes ? pending_.exchange(nullptr, std::memory_order_acquire) : nullptr;
+    }
+    lock = upgrade_lock<Mutex>(std::move(x_lock));
+    return applied;
+  }
+
+  template <typename Mutex>
+  inline std::size_t write_combiner<Mutex>::run_all(detail::combined_write *head) noexcept
+  {
+    // The stack is newest first; reverse it to run in arrival order
+    detail::combined_write *fifo = nullptr;
+    while (head)
+    {
+      detail::combined_write *next = head->next;
+      head->next = fifo;
+      fifo = head;
+      head = next;
+    }
+
+    std::size_t count = 0;
+    while (fifo)
+    {
+      detail::combined_write *next = fifo->next;
+      fifo->run(fifo);
+      fifo->done.store(true, std::memory_order_release);
+      fifo = next;
+      ++count;
+    }
+    return count;
+  }
+
+} // namespace sync_prim
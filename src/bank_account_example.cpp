@@ -22,6 +22,7 @@
  */
 
 #include "sync_prim/upgrade_mutex.hpp"
+#include "sync_prim/lock_all.hpp"
 #include <iostream>
 #include <vector>
 #include <thread>
@@ -114,6 +115,27 @@ public:
     // the upgrade_lock is simply released.
   }
 
+  /**
+   * @brief Moves money between two accounts atomically.
+   * Uses a scoped_lock over both mutexes, which acquires them without
+   * deadlock whichever order concurrent transfers name the accounts in.
+   */
+  static bool transfer(BankAccount &from, BankAccount &to, double amount)
+  {
+    sync_prim::scoped_lock lock(from.mtx_, to.mtx_);
+    if (from.balance_ < amount)
+    {
+      std::cout << "Transfer of $" << amount << " from '" << from.account_name_ << "' to '" << to.account_name_
+                << "' failed. Insufficient funds." << std::endl;
+      return false;
+    }
+    from.balance_ -= amount;
+    to.balance_ += amount;
+    std::cout << "Transferred $" << amount << " from '" << from.account_name_ << "' to '" << to.account_name_
+              << "'." << std::endl;
+    return true;
+  }
+
 private:
   std::string account_name_;
   double balance_;
@@ -123,6 +145,7 @@ private:
 int main()
 {
   BankAccount my_account("Robotics Vision Fund", 1000.00);
+  BankAccount savings("Savings", 500.00);
 
   std::vector<std::thread> threads;
   std::mt19937 rng(std::random_device{}());
@@ -149,6 +172,12 @@ int main()
             my_account.log_large_purchase_if_possible(1200.00); });
   }
 
+  // Spawn threads that transfer in opposite directions at the same time
+  threads.emplace_back([&]()
+                       { BankAccount::transfer(my_account, savings, 100.00); });
+  threads.emplace_back([&]()
+                       { BankAccount::transfer(savings, my_account, 40.00); });
+
   // Spawn a thread that just reads the balance
   threads.emplace_back([&]()
                        {
@@ -167,6 +196,7 @@ int main()
             << "Robotics Vision Fund"
             << "': $"
             << my_account.get_balance() << std::endl;
+  std::cout << "Final balance of 'Savings': $" << savings.get_balance() << std::endl;
 
   return 0;
 }
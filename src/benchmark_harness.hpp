@@ -0,0 +1,449 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+// A parameterized throughput/latency harness shared by the benchmark
+// executables. Each trial spawns the worker threads, lets them warm up, then
+// counts completed operations over a fixed window and times 1 in
+// `latency_sample` of them individually.
+
+#include "sync_prim/upgrade_mutex.hpp"
+#include "sync_prim/cache_line.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace bench
+{
+
+  // Pins the calling thread to one CPU. Returns false where pinning is unsupported.
+  inline bool pin_to_cpu(unsigned cpu)
+  {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+  }
+
+  // True for every sync_prim mutex that supports the shared/upgrade lock
+  // guards. Specialized next to each variant the benchmarks include.
+  template <typename Mutex>
+  struct is_upgrade_mutex : std::false_type
+  {
+  };
+
+  template <typename... Policies>
+  struct is_upgrade_mutex<sync_prim::basic_upgrade_mutex<Policies...>> : std::true_type
+  {
+  };
+
+  template <typename Mutex>
+  constexpr bool is_upgrade_mutex_v = is_upgrade_mutex<Mutex>::value;
+
+  // --- Configuration ---
+
+  // An operation mix, in percent. Whatever is left after reads and upgrades
+  // is plain writes.
+  struct workload
+  {
+    std::string name;
+    unsigned read_pct = 100;
+    unsigned upgrade_pct = 0;
+
+    unsigned write_pct() const { return 100 - read_pct - upgrade_pct; }
+  };
+
+  struct options
+  {
+    std::vector<unsigned> threads;
+    std::vector<workload> workloads;
+    std::vector<std::string> mutex_filters; // Substrings; empty runs every variant
+    std::chrono::milliseconds warmup{20};
+    std::chrono::milliseconds duration{100};
+    unsigned trials = 5;
+    unsigned cs_work = 0;    // Spin iterations inside each critical section
+    unsigned think_work = 0; // Spin iterations between operations
+    unsigned latency_sample = 8;
+  };
+
+  // 1, 2, 4, ... up to and including hardware_concurrency().
+  inline std::vector<unsigned> default_thread_sweep()
+  {
+    unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned n = 1; n < hw; n *= 2)
+      counts.push_back(n);
+    counts.push_back(hw);
+    return counts;
+  }
+
+  // --- Results ---
+
+  struct result_row
+  {
+    std::string mutex;
+    std::string workload;
+    unsigned threads = 0;
+    unsigned read_pct = 0;
+    unsigned upgrade_pct = 0;
+    unsigned write_pct = 0;
+    unsigned cs_work = 0;
+    unsigned think_work = 0;
+    unsigned trials = 0;
+    double ops_per_sec_median = 0;
+    double ops_per_sec_stddev = 0;
+    uint64_t latency_samples = 0;
+    uint64_t p50_ns = 0;
+    uint64_t p90_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t p999_ns = 0;
+    uint64_t max_ns = 0;
+  };
+
+  // The value at quantile p of an ascending vector, or 0 if it is empty.
+  inline uint64_t percentile(const std::vector<uint64_t> &sorted, double p)
+  {
+    if (sorted.empty())
+      return 0;
+    return sorted[static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1))];
+  }
+
+  inline double median(std::vector<double> values)
+  {
+    if (values.empty())
+      return 0;
+    std::sort(values.begin(), values.end());
+    std::size_t mid = values.size() / 2;
+    return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2;
+  }
+
+  inline double stddev(const std::vector<double> &values)
+  {
+    if (values.size() < 2)
+      return 0;
+    double mean = 0;
+    for (double v : values)
+      mean += v;
+    mean /= static_cast<double>(values.size());
+    double sq = 0;
+    for (double v : values)
+      sq += (v - mean) * (v - mean);
+    return std::sqrt(sq / static_cast<double>(values.size() - 1));
+  }
+
+  // --- Operations ---
+
+  inline void spin_work(unsigned iterations)
+  {
+    for (unsigned i = 0; i < iterations; ++i)
+    {
+      volatile unsigned sink = i;
+      (void)sink;
+    }
+  }
+
+  struct alignas(sync_prim::cache_line_size) protected_data
+  {
+    long long counter = 0;
+  };
+
+  // Shared mode where the mutex has one, exclusive otherwise.
+  template <typename Mutex>
+  void read_op(Mutex &mtx, protected_data &data, unsigned cs_work)
+  {
+    if constexpr (is_upgrade_mutex_v<Mutex>)
+    {
+      sync_prim::shared_lock<Mutex> lock(mtx);
+      volatile long long val = data.counter;
+      (void)val;
+      spin_work(cs_work);
+    }
+    else if constexpr (std::is_same_v<Mutex, std::shared_mutex>)
+    {
+      std::shared_lock lock(mtx);
+      volatile long long val = data.counter;
+      (void)val;
+      spin_work(cs_work);
+    }
+    else
+    {
+      std::lock_guard lock(mtx);
+      volatile long long val = data.counter;
+      (void)val;
+      spin_work(cs_work);
+    }
+  }
+
+  template <typename Mutex>
+  void write_op(Mutex &mtx, protected_data &data, unsigned cs_work)
+  {
+    std::unique_lock lock(mtx);
+    data.counter++;
+    spin_work(cs_work);
+  }
+
+  // Read under an upgrade lock, then convert and write. Mutexes without an
+  // upgradeable mode do the whole operation exclusively.
+  template <typename Mutex>
+  void upgrade_op(Mutex &mtx, protected_data &data, unsigned cs_work)
+  {
+    if constexpr (is_upgrade_mutex_v<Mutex>)
+    {
+      sync_prim::upgrade_lock<Mutex> u_lock(mtx);
+      volatile long long val = data.counter;
+      (void)val;
+      spin_work(cs_work);
+      sync_prim::unique_lock<Mutex> x_lock(std::move(u_lock));
+      data.counter++;
+    }
+    else
+    {
+      std::unique_lock lock(mtx);
+      volatile long long val = data.counter;
+      (void)val;
+      spin_work(cs_work);
+      data.counter++;
+    }
+  }
+
+  // --- Trial Runner ---
+
+  struct trial_result
+  {
+    double ops_per_sec = 0;
+    std::vector<uint64_t> latencies_ns;
+  };
+
+  template <typename Mutex>
+  trial_result run_trial(const workload &mix, unsigned num_threads, const options &opt)
+  {
+    enum phase_t : int
+    {
+      WARMUP,
+      MEASURE,
+      STOP
+    };
+    auto mtx = std::make_unique<Mutex>();
+    protected_data data;
+    std::atomic<unsigned> ready{0};
+    std::atomic<bool> go{false};
+    std::atomic<int> phase{WARMUP};
+    std::vector<uint64_t> ops(num_threads);
+    std::vector<std::vector<uint64_t>> latencies(num_threads);
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < num_threads; ++t)
+    {
+      threads.emplace_back([&, t]()
+                           {
+        uint64_t rng = 0x9e3779b97f4a7c15ull * (t + 1);
+        uint64_t count = 0;
+        unsigned tick = 0;
+        std::vector<uint64_t> &lat = latencies[t];
+        ready.fetch_add(1);
+        while (!go.load(std::memory_order_acquire))
+          std::this_thread::yield();
+        for (;;)
+        {
+          int p = phase.load(std::memory_order_relaxed);
+          if (p == STOP)
+            break;
+          rng ^= rng << 13;
+          rng ^= rng >> 7;
+          rng ^= rng << 17;
+          unsigned roll = static_cast<unsigned>(rng % 100);
+          bool timed = p == MEASURE && ++tick % opt.latency_sample == 0;
+          auto start = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+          if (roll < mix.read_pct)
+            read_op(*mtx, data, opt.cs_work);
+          else if (roll < mix.read_pct + mix.upgrade_pct)
+            upgrade_op(*mtx, data, opt.cs_work);
+          else
+            write_op(*mtx, data, opt.cs_work);
+          if (p == MEASURE)
+          {
+            ++count;
+            if (timed)
+              lat.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                      std::chrono::steady_clock::now() - start)
+                                                      .count()));
+          }
+          spin_work(opt.think_work);
+        }
+        ops[t] = count; });
+    }
+
+    while (ready.load() < num_threads)
+      std::this_thread::yield();
+    go.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(opt.warmup);
+    auto begin = std::chrono::steady_clock::now();
+    phase.store(MEASURE, std::memory_order_relaxed);
+    std::this_thread::sleep_for(opt.duration);
+    phase.store(STOP, std::memory_order_relaxed);
+    auto end = std::chrono::steady_clock::now();
+    for (auto &t : threads)
+      t.join();
+
+    trial_result result;
+    uint64_t total = 0;
+    for (uint64_t n : ops)
+      total += n;
+    result.ops_per_sec = static_cast<double>(total) / std::chrono::duration<double>(end - begin).count();
+    for (auto &lat : latencies)
+      result.latencies_ns.insert(result.latencies_ns.end(), lat.begin(), lat.end());
+    return result;
+  }
+
+  // Runs opt.trials trials and summarizes them into one row.
+  template <typename Mutex>
+  result_row run_point(const std::string &name, const workload &mix, unsigned num_threads, const options &opt)
+  {
+    std::vector<double> rates;
+    std::vector<uint64_t> latencies;
+    for (unsigned i = 0; i < opt.trials; ++i)
+    {
+      trial_result trial = run_trial<Mutex>(mix, num_threads, opt);
+      rates.push_back(trial.ops_per_sec);
+      latencies.insert(latencies.end(), trial.latencies_ns.begin(), trial.latencies_ns.end());
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    result_row row;
+    row.mutex = name;
+    row.workload = mix.name;
+    row.threads = num_threads;
+    row.read_pct = mix.read_pct;
+    row.upgrade_pct = mix.upgrade_pct;
+    row.write_pct = mix.write_pct();
+    row.cs_work = opt.cs_work;
+    row.think_work = opt.think_work;
+    row.trials = opt.trials;
+    row.ops_per_sec_median = median(rates);
+    row.ops_per_sec_stddev = stddev(rates);
+    row.latency_samples = latencies.size();
+    row.p50_ns = percentile(latencies, 0.50);
+    row.p90_ns = percentile(latencies, 0.90);
+    row.p99_ns = percentile(latencies, 0.99);
+    row.p999_ns = percentile(latencies, 0.999);
+    row.max_ns = latencies.empty() ? 0 : latencies.back();
+    return row;
+  }
+
+  // A named mutex type, erased so the variants can be listed in a table.
+  struct variant
+  {
+    std::string name;
+    std::function<result_row(const workload &, unsigned, const options &)> run;
+  };
+
+  template <typename Mutex>
+  variant make_variant(std::string name)
+  {
+    return {name, [name](const workload &mix, unsigned num_threads, const options &opt)
+            { return run_point<Mutex>(name, mix, num_threads, opt); }};
+  }
+
+  inline bool selected(const variant &v, const options &opt)
+  {
+    if (opt.mutex_filters.empty())
+      return true;
+    return std::any_of(opt.mutex_filters.begin(), opt.mutex_filters.end(), [&](const std::string &f)
+                       { return v.name.find(f) != std::string::npos; });
+  }
+
+  // --- Output ---
+
+  inline void write_table_header(std::ostream &out)
+  {
+    out << std::left << std::setw(38) << "mutex" << std::setw(15) << "workload" << std::right << std::setw(4) << "thr"
+        << std::setw(14) << "ops/s" << std::setw(8) << "+/-%" << std::setw(10) << "p50 ns" << std::setw(10) << "p90 ns"
+        << std::setw(10) << "p99 ns" << std::setw(11) << "p99.9 ns" << "\n";
+  }
+
+  inline void write_table_row(std::ostream &out, const result_row &row)
+  {
+    double rel = row.ops_per_sec_median > 0 ? 100.0 * row.ops_per_sec_stddev / row.ops_per_sec_median : 0;
+    out << std::left << std::setw(38) << row.mutex << std::setw(15) << row.workload << std::right << std::setw(4) << row.threads
+        << std::setw(14) << std::fixed << std::setprecision(0) << row.ops_per_sec_median << std::setw(8) << std::setprecision(1) << rel
+        << std::setw(10) << row.p50_ns << std::setw(10) << row.p90_ns << std::setw(10) << row.p99_ns << std::setw(11) << row.p999_ns
+        << std::endl;
+  }
+
+  inline void write_csv(std::ostream &out, const std::vector<result_row> &rows)
+  {
+    out << "mutex,workload,threads,read_pct,upgrade_pct,write_pct,cs_work,think_work,trials,"
+           "ops_per_sec_median,ops_per_sec_stddev,latency_samples,p50_ns,p90_ns,p99_ns,p999_ns,max_ns\n";
+    for (const result_row &r : rows)
+    {
+      out << '"' << r.mutex << "\"," << r.workload << ',' << r.threads << ',' << r.read_pct << ',' << r.upgrade_pct << ','
+          << r.write_pct << ',' << r.cs_work << ',' << r.think_work << ',' << r.trials << ',' << std::fixed << std::setprecision(1)
+          << r.ops_per_sec_median << ',' << r.ops_per_sec_stddev << ',' << r.latency_samples << ',' << r.p50_ns << ','
+          << r.p90_ns << ',' << r.p99_ns << ',' << r.p999_ns << ',' << r.max_ns << "\n";
+    }
+  }
+
+  inline void write_json(std::ostream &out, const std::vector<result_row> &rows, const options &opt)
+  {
+    out << "{\n  \"config\": {\"warmup_ms\": " << opt.warmup.count() << ", \"duration_ms\": " << opt.duration.count()
+        << ", \"trials\": " << opt.trials << ", \"cs_work\": " << opt.cs_work << ", \"think_work\": " << opt.think_work
+        << ", \"latency_sample\": " << opt.latency_sample << ", \"hardware_concurrency\": " << std::thread::hardware_concurrency()
+        << "},\n  \"results\": [";
+    for (std::size_t i = 0; i < rows.size(); ++i)
+    {
+      const result_row &r = rows[i];
+      out << (i ? "," : "") << "\n    {\"mutex\": \"" << r.mutex << "\", \"workload\": \"" << r.workload << "\", \"threads\": "
+          << r.threads << ", \"read_pct\": " << r.read_pct << ", \"upgrade_pct\": " << r.upgrade_pct << ", \"write_pct\": "
+          << r.write_pct << ", \"cs_work\": " << r.cs_work << ", \"think_work\": " << r.think_work << ", \"trials\": " << r.trials
+          << std::fixed << std::setprecision(1) << ", \"ops_per_sec_median\": " << r.ops_per_sec_median
+          << ", \"ops_per_sec_stddev\": " << r.ops_per_sec_stddev << ", \"latency_samples\": " << r.latency_samples
+          << ", \"latency_ns\": {\"p50\": " << r.p50_ns << ", \"p90\": " << r.p90_ns << ", \"p99\": " << r.p99_ns
+          << ", \"p999\": " << r.p999_ns << ", \"max\": " << r.max_ns << "}}";
+    }
+    out << "\n  ]\n}\n";
+  }
+
+} // namespace bench
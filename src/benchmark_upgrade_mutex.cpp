@@ -22,7 +22,17 @@
  */
 
 #include "sync_prim/upgrade_mutex.hpp"
+#include "sync_prim/distributed_upgrade_mutex.hpp"
+#include "sync_prim/numa_upgrade_mutex.hpp"
+#include "sync_prim/queued_upgrade_mutex.hpp"
+#include "sync_prim/synchronized.hpp"
+#include "sync_prim/write_combiner.hpp"
+#include "benchmark_harness.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <thread>
 #include <chrono>
@@ -30,6 +40,7 @@
 #include <shared_mutex>
 #include <iomanip>
 #include <functional>
+#include <type_traits>
 
 // A simple data structure to be protected by the mutexes
 struct ProtectedData
@@ -37,10 +48,51 @@ struct ProtectedData
   long long counter = 0;
 };
 
+// The wait-policy variants under test
+using pure_spin_mutex = sync_prim::basic_upgrade_mutex<sync_prim::pure_spin>;
+using spin_then_park_mutex = sync_prim::basic_upgrade_mutex<sync_prim::spin_then_park>;
+using immediate_park_mutex = sync_prim::basic_upgrade_mutex<sync_prim::immediate_park>;
+using futex_mutex = sync_prim::basic_upgrade_mutex<sync_prim::futex_backend>;
+using distributed_mutex = sync_prim::distributed_upgrade_mutex<>;
+using queued_mutex = sync_prim::queued_upgrade_mutex<>;
+using numa_mutex = sync_prim::numa_upgrade_mutex<>;
+
+// The fairness variants under test
+using writer_preferring_mutex = sync_prim::basic_upgrade_mutex<sync_prim::writer_preferring>;
+using phase_fair_mutex = sync_prim::basic_upgrade_mutex<sync_prim::phase_fair>;
+using handoff_mutex = sync_prim::basic_upgrade_mutex<sync_prim::direct_handoff>;
+using instrumented_mutex = sync_prim::basic_upgrade_mutex<sync_prim::instrumented>;
+using optimistic_mutex = sync_prim::basic_upgrade_mutex<sync_prim::optimistic_reads>;
+
+using bench::is_upgrade_mutex_v;
+
+namespace bench
+{
+  template <std::size_t SlotCount, typename... Policies>
+  struct is_upgrade_mutex<sync_prim::distributed_upgrade_mutex<SlotCount, Policies...>> : std::true_type
+  {
+  };
+
+  template <typename... Policies>
+  struct is_upgrade_mutex<sync_prim::queued_upgrade_mutex<Policies...>> : std::true_type
+  {
+  };
+
+  template <std::size_t NodeCount, typename... Policies>
+  struct is_upgrade_mutex<sync_prim::numa_upgrade_mutex<NodeCount, Policies...>> : std::true_type
+  {
+  };
+
+  template <typename Mutex>
+  struct is_upgrade_mutex<sync_prim::padded_upgrade_mutex<Mutex>> : is_upgrade_mutex<Mutex>
+  {
+  };
+} // namespace bench
+
 // --- Benchmark Runner ---
 void run_benchmark(const std::string &name, std::function<void()> benchmark_func)
 {
-  std::cout << "Running benchmark: " << std::left << std::setw(45) << name << "... " << std::flush;
+  std::cout << "Running benchmark: " << std::left << std::setw(50) << name << "... " << std::flush;
   auto start = std::chrono::high_resolution_clock::now();
   benchmark_func();
   auto end = std::chrono::high_resolution_clock::now();
@@ -48,42 +100,108 @@ void run_benchmark(const std::string &name, std::function<void()> benchmark_func
   std::cout << "Finished in " << std::fixed << std::setprecision(4) << duration.count() << "s" << std::endl;
 }
 
+// Prints an instrumented mutex's counters below its benchmark line.
+void print_stats(const sync_prim::lock_stats &stats)
+{
+  auto mode = [](const char *name, const sync_prim::lock_stats::mode_stats &m)
+  { std::cout << "  " << std::left << std::setw(10) << name << " fast=" << m.fast_acquisitions << " slow=" << m.slow_acquisitions << std::endl; };
+  mode("shared", stats.shared);
+  mode("upgrade", stats.upgrade);
+  mode("exclusive", stats.exclusive);
+  std::cout << "  gate1 parks=" << stats.gate1.parks << " wait=" << stats.gate1.wait_ns / 1000 << "us"
+            << ", gate2 parks=" << stats.gate2.parks << " wait=" << stats.gate2.wait_ns / 1000 << "us" << std::endl;
+  std::cout << "  avg hold: exclusive=" << stats.exclusive_hold.average_ns() << "ns upgrade=" << stats.upgrade_hold.average_ns()
+            << "ns, upgrades=" << stats.upgrade_attempts << " (failed " << stats.upgrade_failures << ", avg pending "
+            << stats.upgrade_pending.average_ns() << "ns), max readers=" << stats.max_concurrent_readers << std::endl;
+}
+
 // ===================================================================
 //                        BENCHMARK SCENARIOS
 // ===================================================================
 
-// --- Scenario 1: Read-Heavy Workload (95% reads, 5% writes) ---
-template <typename Mutex>
-void read_heavy_benchmark(Mutex &mtx, ProtectedData &data)
+// --- Scenario 1: Throughput Sweep ---
+// Every variant, every workload and every thread count, through the harness.
+std::vector<bench::variant> all_variants()
+{
+  return {
+      bench::make_variant<std::mutex>("std::mutex"),
+      bench::make_variant<std::shared_mutex>("std::shared_mutex"),
+      bench::make_variant<spin_then_park_mutex>("upgrade_mutex"),
+      bench::make_variant<pure_spin_mutex>("upgrade_mutex<pure_spin>"),
+      bench::make_variant<immediate_park_mutex>("upgrade_mutex<immediate_park>"),
+      bench::make_variant<futex_mutex>("upgrade_mutex<futex_backend>"),
+      bench::make_variant<writer_preferring_mutex>("upgrade_mutex<writer_preferring>"),
+      bench::make_variant<phase_fair_mutex>("upgrade_mutex<phase_fair>"),
+      bench::make_variant<handoff_mutex>("upgrade_mutex<direct_handoff>"),
+      bench::make_variant<optimistic_mutex>("upgrade_mutex<optimistic_reads>"),
+      bench::make_variant<distributed_mutex>("distributed_upgrade_mutex"),
+      bench::make_variant<numa_mutex>("numa_upgrade_mutex"),
+      bench::make_variant<queued_mutex>("queued_upgrade_mutex"),
+  };
+}
+
+std::vector<bench::workload> default_workloads()
+{
+  return {
+      {"read-heavy", 95, 0},
+      {"mixed", 50, 0},
+      {"write-heavy", 10, 0},
+      {"upgrade-heavy", 70, 25},
+  };
+}
+
+std::vector<bench::result_row> sweep(const bench::options &opt, std::ostream &progress)
+{
+  std::vector<bench::result_row> rows;
+  bench::write_table_header(progress);
+  for (const bench::workload &mix : opt.workloads)
+  {
+    for (const bench::variant &v : all_variants())
+    {
+      if (!bench::selected(v, opt))
+        continue;
+      for (unsigned n : opt.threads)
+      {
+        rows.push_back(v.run(mix, n, opt));
+        bench::write_table_row(progress, rows.back());
+      }
+    }
+  }
+  return rows;
+}
+
+// --- Scenario 2: False Sharing (each thread locks only its own object) ---
+// The threads never contend for a lock, so any slowdown of the packed layout
+// over the padded one is the cost of neighbouring objects sharing a line.
+struct PackedCounter
+{
+  futex_mutex mtx;
+  long long counter = 0;
+};
+
+struct PaddedCounter
+{
+  sync_prim::padded_upgrade_mutex<futex_mutex> mtx;
+  long long counter = 0;
+};
+
+template <typename Slot>
+void false_sharing_benchmark(std::vector<Slot> &slots)
 {
-  const int num_threads = 16;
-  const int ops_per_thread = 10000;
+  const int ops_per_thread = 200000;
   std::vector<std::thread> threads;
 
-  for (int i = 0; i < num_threads; ++i)
+  for (std::size_t i = 0; i < slots.size(); ++i)
   {
     threads.emplace_back([&, i]()
                          {
             for (int op = 0; op < ops_per_thread; ++op) {
-                if (i == 0 && op % 20 == 0) { // 1 writer thread, 5% of its ops are writes
-                    if constexpr (std::is_same_v<Mutex, sync_prim::upgrade_mutex> || std::is_same_v<Mutex, std::shared_mutex>) {
-                        std::unique_lock lock(mtx);
-                        data.counter++;
-                    } else { // std::mutex
-                        std::lock_guard lock(mtx);
-                        data.counter++;
-                    }
-                } else { // All other ops are reads
-                    if constexpr (std::is_same_v<Mutex, sync_prim::upgrade_mutex>) {
-                        sync_prim::shared_lock<sync_prim::upgrade_mutex> lock(mtx);
-                        volatile long long val = data.counter; (void)val;
-                    } else if constexpr (std::is_same_v<Mutex, std::shared_mutex>) {
-                        std::shared_lock lock(mtx);
-                        volatile long long val = data.counter; (void)val;
-                    } else { // std::mutex
-                        std::lock_guard lock(mtx);
-                        volatile long long val = data.counter; (void)val;
-                    }
+                if (op % 4 == 0) {
+                    std::unique_lock lock(slots[i].mtx);
+                    slots[i].counter++;
+                } else {
+                    sync_prim::shared_lock<decltype(slots[i].mtx)> lock(slots[i].mtx);
+                    volatile long long val = slots[i].counter; (void)val;
                 }
             } });
   }
@@ -91,38 +209,142 @@ void read_heavy_benchmark(Mutex &mtx, ProtectedData &data)
     t.join();
 }
 
-// --- Scenario 2: Write-Heavy Workload (50% reads, 50% writes) ---
+void synchronized_false_sharing_benchmark(std::vector<sync_prim::synchronized<long long, futex_mutex>> &slots)
+{
+  const int ops_per_thread = 200000;
+  std::vector<std::thread> threads;
+
+  for (std::size_t i = 0; i < slots.size(); ++i)
+  {
+    threads.emplace_back([&, i]()
+                         {
+            for (int op = 0; op < ops_per_thread; ++op) {
+                if (op % 4 == 0) {
+                    ++*slots[i].wlock();
+                } else {
+                    volatile long long val = *slots[i].rlock(); (void)val;
+                }
+            } });
+  }
+  for (auto &t : threads)
+    t.join();
+}
+
+// --- Scenario 3: Writer Wait Time under a Continuous Read Load ---
+// Readers hold the lock back to back, so under reader preference there is
+// hardly ever a moment with no reader present. Reports how long lock() took;
+// attempts still waiting after the cap count as starved (and as the cap).
 template <typename Mutex>
-void write_heavy_benchmark(Mutex &mtx, ProtectedData &data)
+void writer_wait_benchmark(const std::string &name)
+{
+  const int num_readers = 7;
+  const int num_writes = 100;
+  const auto wait_cap = std::chrono::milliseconds(20);
+  std::atomic<bool> done = false;
+  ProtectedData data;
+  Mutex mtx;
+
+  std::vector<std::thread> readers;
+  for (int i = 0; i < num_readers; ++i)
+  {
+    readers.emplace_back([&]()
+                         {
+            while (!done) {
+                sync_prim::shared_lock<Mutex> lock(mtx);
+                for (int spin = 0; spin < 100; ++spin) {
+                    volatile long long val = data.counter; (void)val;
+                }
+            } });
+  }
+
+  std::vector<double> waits_us;
+  int starved = 0;
+  for (int i = 0; i < num_writes; ++i)
+  {
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock lock(mtx, wait_cap);
+    waits_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    if (lock.owns_lock())
+      data.counter++;
+    else
+      starved++;
+    lock = {};
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  done = true;
+  for (auto &t : readers)
+    t.join();
+
+  std::sort(waits_us.begin(), waits_us.end());
+  auto percentile = [&](double p)
+  { return waits_us[static_cast<std::size_t>(p * (waits_us.size() - 1))]; };
+  std::cout << "Writer wait: " << std::left << std::setw(37) << name << std::fixed << std::setprecision(1)
+            << " p50=" << std::setw(9) << percentile(0.50) << " p90=" << std::setw(9) << percentile(0.90)
+            << " p99=" << std::setw(9) << percentile(0.99) << " us, starved " << starved << "/" << num_writes << std::endl;
+}
+
+// --- Scenario 4: Cross-node Writes ---
+// The usable CPUs, ordered so that consecutive entries alternate between NUMA
+// nodes: thread i of the benchmark runs on entry i, and the threads end up
+// spread evenly over the nodes.
+std::vector<unsigned> cpus_interleaved_by_node(std::size_t &node_count)
 {
-  const int num_threads = 8;
-  const int ops_per_thread = 10000;
+  std::vector<std::vector<unsigned>> by_node;
+  std::thread([&]()
+              {
+        for (unsigned cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu) {
+            if (!bench::pin_to_cpu(cpu))
+                continue;
+            std::size_t node = sync_prim::detail::current_numa_node();
+            if (by_node.size() <= node)
+                by_node.resize(node + 1);
+            by_node[node].push_back(cpu);
+        } })
+      .join();
+
+  std::vector<unsigned> cpus;
+  node_count = 0;
+  for (const auto &node : by_node)
+    node_count += !node.empty();
+  for (std::size_t i = 0;; ++i)
+  {
+    bool any = false;
+    for (const auto &node : by_node)
+    {
+      if (i < node.size())
+      {
+        cpus.push_back(node[i]);
+        any = true;
+      }
+    }
+    if (!any)
+      break;
+  }
+  return cpus;
+}
+
+// 90% writes from threads pinned across all nodes. Each sync_prim node hint is
+// taken after pinning, so the cohorts match the real topology.
+template <typename Mutex>
+void cross_node_benchmark(Mutex &mtx, ProtectedData &data, const std::vector<unsigned> &cpus)
+{
+  const std::size_t num_threads = std::max<std::size_t>(cpus.size(), 4);
+  const int ops_per_thread = 20000;
   std::vector<std::thread> threads;
 
-  for (int i = 0; i < num_threads; ++i)
+  for (std::size_t i = 0; i < num_threads; ++i)
   {
     threads.emplace_back([&, i]()
                          {
+            if (!cpus.empty())
+                bench::pin_to_cpu(cpus[i % cpus.size()]);
             for (int op = 0; op < ops_per_thread; ++op) {
-                if (op % 2 == 0) { // 50% writes
-                    if constexpr (std::is_same_v<Mutex, sync_prim::upgrade_mutex> || std::is_same_v<Mutex, std::shared_mutex>) {
-                        std::unique_lock lock(mtx);
-                        data.counter++;
-                    } else {
-                        std::lock_guard lock(mtx);
-                        data.counter++;
-                    }
-                } else { // 50% reads
-                     if constexpr (std::is_same_v<Mutex, sync_prim::upgrade_mutex>) {
-                        sync_prim::shared_lock<sync_prim::upgrade_mutex> lock(mtx);
-                        volatile long long val = data.counter; (void)val;
-                    } else if constexpr (std::is_same_v<Mutex, std::shared_mutex>) {
-                        std::shared_lock lock(mtx);
-                        volatile long long val = data.counter; (void)val;
-                    } else {
-                        std::lock_guard lock(mtx);
-                        volatile long long val = data.counter; (void)val;
-                    }
+                if (op % 10 != 0) {
+                    std::unique_lock lock(mtx);
+                    data.counter++;
+                } else {
+                    sync_prim::shared_lock<Mutex> lock(mtx);
+                    volatile long long val = data.counter; (void)val;
                 }
             } });
   }
@@ -130,21 +352,203 @@ void write_heavy_benchmark(Mutex &mtx, ProtectedData &data)
     t.join();
 }
 
-// --- Scenario 3: Upgrade-Heavy Workload (Read, then maybe write) ---
-void upgrade_heavy_benchmark(sync_prim::upgrade_mutex &mtx, ProtectedData &data)
+// --- Scenario 5: Contention Statistics ---
+// The upgrade-heavy mix on an instrumented mutex, followed by its counters.
+void stats_scenario(const bench::options &opt)
+{
+  const unsigned num_threads = opt.threads.back();
+  const int ops_per_thread = 20000;
+  instrumented_mutex mtx;
+  bench::protected_data data;
+  run_benchmark("upgrade_mutex<instrumented> (upgrade-heavy)", [&]()
+                {
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < num_threads; ++t)
+    {
+      threads.emplace_back([&]()
+                           {
+        for (int op = 0; op < ops_per_thread; ++op)
+        {
+          if (op % 4 == 0)
+            bench::upgrade_op(mtx, data, opt.cs_work);
+          else
+            bench::read_op(mtx, data, opt.cs_work);
+        } });
+    }
+    for (auto &t : threads)
+      t.join(); });
+  print_stats(mtx.stats());
+}
+
+// --- Scenario 6: Upgrade Contention ---
+// Continuous readers, one upgrader converting through scoped_upgrade every
+// 100us, and one writer calling lock() every 200us. A pending upgrade blocks
+// new readers until the current ones leave; this measures that window from
+// both sides. Reader stalls are lock_shared() times; "stalled" counts those
+// over 10us. Upgrade latency runs from requesting the upgrade lock to
+// holding it exclusively, and "convert" is the scoped_upgrade entry alone.
+// Writer attempts still waiting after 20ms count as starved.
+struct latency_summary
+{
+  uint64_t p50 = 0, p99 = 0, p999 = 0, max = 0;
+  std::size_t count = 0;
+};
+
+latency_summary summarize(std::vector<uint64_t> &ns)
 {
-  const int num_threads = 8;
-  const int ops_per_thread = 10000;
+  std::sort(ns.begin(), ns.end());
+  return {bench::percentile(ns, 0.50), bench::percentile(ns, 0.99), bench::percentile(ns, 0.999), ns.empty() ? 0 : ns.back(), ns.size()};
+}
+
+void print_upgrade_contention_header()
+{
+  std::cout << std::left << std::setw(34) << "mutex" << std::right << std::setw(28) << "reader stall p50/p99/p99.9/max"
+            << std::setw(10) << "stalled" << std::setw(20) << "upgrade p50/p99" << std::setw(14) << "convert p99"
+            << std::setw(18) << "writer p50/p99" << std::setw(10) << "starved" << "  (us)" << std::endl;
+}
+
+template <typename Mutex>
+void upgrade_contention_benchmark(const std::string &name, unsigned num_readers, std::chrono::milliseconds duration)
+{
+  using clock = std::chrono::steady_clock;
+  const auto stall_threshold = std::chrono::microseconds(10);
+  const auto writer_cap = std::chrono::milliseconds(20);
+  auto since = [](clock::time_point start)
+  { return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count()); };
+
+  Mutex mtx;
+  ProtectedData data;
+  std::atomic<bool> done = false;
+  std::vector<std::vector<uint64_t>> stalls(num_readers);
+  std::vector<std::size_t> stalled(num_readers);
+  std::vector<uint64_t> upgrades, converts, writes;
+  int starved = 0;
+
   std::vector<std::thread> threads;
+  for (unsigned r = 0; r < num_readers; ++r)
+  {
+    threads.emplace_back([&, r]()
+                         {
+            while (!done) {
+                auto start = clock::now();
+                sync_prim::shared_lock<Mutex> lock(mtx);
+                uint64_t wait = since(start);
+                stalls[r].push_back(wait);
+                stalled[r] += wait > static_cast<uint64_t>(std::chrono::nanoseconds(stall_threshold).count());
+                for (int spin = 0; spin < 50; ++spin) {
+                    volatile long long val = data.counter; (void)val;
+                }
+            } });
+  }
+  threads.emplace_back([&]()
+                       {
+        while (!done) {
+            auto start = clock::now();
+            sync_prim::upgrade_lock<Mutex> u_lock(mtx);
+            auto convert_start = clock::now();
+            {
+                sync_prim::scoped_upgrade<Mutex> x_scope(u_lock);
+                converts.push_back(since(convert_start));
+                upgrades.push_back(since(start));
+                data.counter++;
+            }
+            u_lock.unlock();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        } });
+  threads.emplace_back([&]()
+                       {
+        while (!done) {
+            auto start = clock::now();
+            std::unique_lock lock(mtx, writer_cap);
+            if (lock.owns_lock()) {
+                writes.push_back(since(start));
+                data.counter++;
+            } else {
+                writes.push_back(since(start));
+                starved++;
+            }
+            lock = {};
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        } });
+
+  std::this_thread::sleep_for(duration);
+  done = true;
+  for (auto &t : threads)
+    t.join();
 
-  for (int i = 0; i < num_threads; ++i)
+  std::vector<uint64_t> all_stalls;
+  std::size_t total_stalled = 0;
+  for (unsigned r = 0; r < num_readers; ++r)
+  {
+    all_stalls.insert(all_stalls.end(), stalls[r].begin(), stalls[r].end());
+    total_stalled += stalled[r];
+  }
+  latency_summary read = summarize(all_stalls);
+  latency_summary upgrade = summarize(upgrades);
+  latency_summary convert = summarize(converts);
+  latency_summary write = summarize(writes);
+
+  auto us = [](uint64_t ns)
+  {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << static_cast<double>(ns) / 1000;
+    return out.str();
+  };
+  std::cout << std::left << std::setw(34) << name << std::right
+            << std::setw(28) << (us(read.p50) + "/" + us(read.p99) + "/" + us(read.p999) + "/" + us(read.max))
+            << std::setw(9) << std::fixed << std::setprecision(2) << (read.count ? 100.0 * total_stalled / read.count : 0.0) << "%"
+            << std::setw(20) << (us(upgrade.p50) + "/" + us(upgrade.p99)) << std::setw(14) << us(convert.p99)
+            << std::setw(18) << (us(write.p50) + "/" + us(write.p99))
+            << std::setw(10) << (std::to_string(starved) + "/" + std::to_string(write.count)) << std::endl;
+}
+
+void upgrade_contention_scenario(const bench::options &opt)
+{
+  const unsigned num_readers = std::max(2u, opt.threads.back());
+  const auto duration = std::max(opt.duration * 3, std::chrono::milliseconds(60));
+  std::cout << "\n--- SCENARIO: UPGRADE CONTENTION (" << num_readers << " Continuous Readers, 1 Upgrader, 1 Writer, "
+            << duration.count() << "ms) ---" << std::endl;
+  print_upgrade_contention_header();
+  upgrade_contention_benchmark<sync_prim::upgrade_mutex>("upgrade_mutex<reader_preferring>", num_readers, duration);
+  upgrade_contention_benchmark<writer_preferring_mutex>("upgrade_mutex<writer_preferring>", num_readers, duration);
+  upgrade_contention_benchmark<phase_fair_mutex>("upgrade_mutex<phase_fair>", num_readers, duration);
+  upgrade_contention_benchmark<handoff_mutex>("upgrade_mutex<direct_handoff>", num_readers, duration);
+  upgrade_contention_benchmark<futex_mutex>("upgrade_mutex<futex_backend>", num_readers, duration);
+  upgrade_contention_benchmark<distributed_mutex>("distributed_upgrade_mutex", num_readers, duration);
+  upgrade_contention_benchmark<numa_mutex>("numa_upgrade_mutex", num_readers, duration);
+  upgrade_contention_benchmark<queued_mutex>("queued_upgrade_mutex", num_readers, duration);
+}
+
+// --- Scenario 7: Write Combining ---
+// The cache-refresh pattern: each thread reads, finds the data stale every
+// 4th time, and writes. Each writer either upgrades on its own or submits the
+// write to a write_combiner, which applies queued writes in one exclusive
+// section.
+template <typename Mutex>
+void refresh_benchmark(bool combined, unsigned num_threads)
+{
+  const int ops_per_thread = 20000;
+  Mutex mtx;
+  sync_prim::write_combiner<Mutex> combiner(mtx);
+  ProtectedData data;
+  std::vector<std::thread> threads;
+
+  for (unsigned i = 0; i < num_threads; ++i)
   {
     threads.emplace_back([&]()
                          {
             for (int op = 0; op < ops_per_thread; ++op) {
-                sync_prim::upgrade_lock<sync_prim::upgrade_mutex> u_lock(mtx);
-                if (data.counter % 10 == 0) {
-                    sync_prim::scoped_upgrade<sync_prim::upgrade_mutex> s_lock(u_lock);
+                {
+                    sync_prim::shared_lock<Mutex> lock(mtx);
+                    volatile long long val = data.counter; (void)val;
+                }
+                if (op % 4 != 0)
+                    continue;
+                if (combined) {
+                    combiner.submit_write([&] { data.counter++; });
+                } else {
+                    sync_prim::upgrade_lock<Mutex> u_lock(mtx);
+                    sync_prim::scoped_upgrade<Mutex> x_scope(u_lock);
                     data.counter++;
                 }
             } });
@@ -153,62 +557,267 @@ void upgrade_heavy_benchmark(sync_prim::upgrade_mutex &mtx, ProtectedData &data)
     t.join();
 }
 
-int main()
+void write_combining_scenario(const bench::options &opt)
 {
-  std::cout << "--- Starting Mutex Performance Benchmarks ---" << std::endl;
+  const unsigned num_threads = std::max(2u, opt.threads.back());
+  std::cout << "\n--- SCENARIO: WRITE COMBINING (" << num_threads << " Threads, Read Then Write 25%) ---" << std::endl;
+  run_benchmark("upgrade_mutex, upgrade per write", [&]()
+                { refresh_benchmark<sync_prim::upgrade_mutex>(false, num_threads); });
+  run_benchmark("upgrade_mutex, write_combiner", [&]()
+                { refresh_benchmark<sync_prim::upgrade_mutex>(true, num_threads); });
+  run_benchmark("distributed_upgrade_mutex, upgrade per write", [&]()
+                { refresh_benchmark<distributed_mutex>(false, num_threads); });
+  run_benchmark("distributed_upgrade_mutex, write_combiner", [&]()
+                { refresh_benchmark<distributed_mutex>(true, num_threads); });
+}
+
+// ===================================================================
+//                        COMMAND LINE
+// ===================================================================
+
+void print_usage()
+{
+  std::cout << "Usage: run_benchmarks [options]\n"
+               "  --scenarios=LIST      sweep,false-sharing,writer-wait,upgrade-contention,\n"
+               "                        write-combining,cross-node,stats (default: all)\n"
+               "  --threads=LIST        Thread counts for the sweep (default: 1,2,4,... hardware_concurrency)\n"
+               "  --workloads=LIST      read-heavy,mixed,write-heavy,upgrade-heavy (default: all)\n"
+               "  --mix=R:U             Add a custom workload: R% reads, U% upgrades, the rest writes\n"
+               "  --mutex=LIST          Only variants whose name contains one of these substrings\n"
+               "  --warmup-ms=N         Warmup before each trial (default: 20)\n"
+               "  --duration-ms=N       Measured window of each trial (default: 100)\n"
+               "  --trials=N            Trials per point; ops/s is their median (default: 5)\n"
+               "  --cs-work=N           Spin iterations inside each critical section (default: 0)\n"
+               "  --think-work=N        Spin iterations between operations (default: 0)\n"
+               "  --latency-sample=N    Time 1 in N operations (default: 8)\n"
+               "  --format=FMT          Sweep results as table, csv or json (default: table)\n"
+               "  --output=PATH         Write the csv/json results to PATH instead of stdout\n"
+               "  --quick               1 trial of 20ms per point\n"
+               "  --list                List the mutex variants and exit\n";
+}
+
+std::vector<std::string> split(const std::string &list, char sep = ',')
+{
+  std::vector<std::string> items;
+  std::stringstream in(list);
+  for (std::string item; std::getline(in, item, sep);)
+    if (!item.empty())
+      items.push_back(item);
+  return items;
+}
 
-  // --- Read-Heavy ---
-  std::cout << "\n--- SCENARIO: READ-HEAVY (95% Reads) ---" << std::endl;
+unsigned to_unsigned(const std::string &value, const std::string &flag)
+{
+  char *end = nullptr;
+  unsigned long n = std::strtoul(value.c_str(), &end, 10);
+  if (value.empty() || *end != '\0')
+  {
+    std::cerr << "Invalid value for " << flag << ": " << value << std::endl;
+    std::exit(2);
+  }
+  return static_cast<unsigned>(n);
+}
+
+int main(int argc, char **argv)
+{
+  bench::options opt;
+  std::vector<std::string> scenarios = {"sweep", "false-sharing", "writer-wait", "upgrade-contention", "write-combining", "cross-node", "stats"};
+  std::vector<std::string> workload_names;
+  std::vector<bench::workload> custom;
+  std::string format = "table";
+  std::string output;
+
+  for (int i = 1; i < argc; ++i)
   {
-    sync_prim::upgrade_mutex mtx;
-    ProtectedData data;
-    run_benchmark("upgrade_mutex (read-heavy)", [&]()
-                  { read_heavy_benchmark(mtx, data); });
+    std::string arg = argv[i];
+    std::size_t eq = arg.find('=');
+    std::string flag = arg.substr(0, eq);
+    std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+    if (flag == "--help" || flag == "-h")
+    {
+      print_usage();
+      return 0;
+    }
+    else if (flag == "--list")
+    {
+      for (const bench::variant &v : all_variants())
+        std::cout << v.name << std::endl;
+      return 0;
+    }
+    else if (flag == "--scenarios")
+      scenarios = split(value);
+    else if (flag == "--threads")
+    {
+      opt.threads.clear();
+      for (const std::string &n : split(value))
+        opt.threads.push_back(std::max(1u, to_unsigned(n, flag)));
+    }
+    else if (flag == "--workloads")
+      workload_names = split(value);
+    else if (flag == "--mix")
+    {
+      std::vector<std::string> parts = split(value, ':');
+      unsigned reads = parts.size() > 0 ? to_unsigned(parts[0], flag) : 100;
+      unsigned upgrades = parts.size() > 1 ? to_unsigned(parts[1], flag) : 0;
+      if (reads + upgrades > 100)
+      {
+        std::cerr << "--mix percentages exceed 100: " << value << std::endl;
+        return 2;
+      }
+      bench::workload mix{"", reads, upgrades};
+      mix.name = "mix-" + std::to_string(reads) + ":" + std::to_string(upgrades) + ":" + std::to_string(mix.write_pct());
+      custom.push_back(mix);
+    }
+    else if (flag == "--mutex")
+      opt.mutex_filters = split(value);
+    else if (flag == "--warmup-ms")
+      opt.warmup = std::chrono::milliseconds(to_unsigned(value, flag));
+    else if (flag == "--duration-ms")
+      opt.duration = std::chrono::milliseconds(std::max(1u, to_unsigned(value, flag)));
+    else if (flag == "--trials")
+      opt.trials = std::max(1u, to_unsigned(value, flag));
+    else if (flag == "--cs-work")
+      opt.cs_work = to_unsigned(value, flag);
+    else if (flag == "--think-work")
+      opt.think_work = to_unsigned(value, flag);
+    else if (flag == "--latency-sample")
+      opt.latency_sample = std::max(1u, to_unsigned(value, flag));
+    else if (flag == "--format")
+      format = value;
+    else if (flag == "--output")
+      output = value;
+    else if (flag == "--quick")
+    {
+      opt.trials = 1;
+      opt.warmup = std::chrono::milliseconds(5);
+      opt.duration = std::chrono::milliseconds(20);
+    }
+    else
+    {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      print_usage();
+      return 2;
+    }
   }
+  if (format != "table" && format != "csv" && format != "json")
   {
-    std::shared_mutex mtx;
-    ProtectedData data;
-    run_benchmark("std::shared_mutex (read-heavy)", [&]()
-                  { read_heavy_benchmark(mtx, data); });
+    std::cerr << "Unknown format: " << format << std::endl;
+    return 2;
   }
+
+  if (opt.threads.empty())
+    opt.threads = bench::default_thread_sweep();
+  for (const bench::workload &mix : default_workloads())
+    if (workload_names.empty() ? custom.empty() : std::find(workload_names.begin(), workload_names.end(), mix.name) != workload_names.end())
+      opt.workloads.push_back(mix);
+  opt.workloads.insert(opt.workloads.end(), custom.begin(), custom.end());
+
+  auto wants = [&](const char *name)
+  { return std::find(scenarios.begin(), scenarios.end(), name) != scenarios.end(); };
+  // Machine-readable results on stdout push the human-readable progress to stderr
+  std::streambuf *stdout_buf = std::cout.rdbuf();
+  if (format != "table" && output.empty())
+    std::cout.rdbuf(std::cerr.rdbuf());
+
+  std::cout << "--- Starting Mutex Performance Benchmarks ---" << std::endl;
+
+  if (wants("sweep"))
   {
-    std::mutex mtx;
-    ProtectedData data;
-    run_benchmark("std::mutex (read-heavy)", [&]()
-                  { read_heavy_benchmark(mtx, data); });
+    std::cout << "\n--- SCENARIO: THROUGHPUT SWEEP (" << opt.trials << " x " << opt.duration.count() << "ms trials, cs_work="
+        << opt.cs_work << ", think_work=" << opt.think_work << ") ---" << std::endl;
+    std::vector<bench::result_row> rows = sweep(opt, std::cout);
+    if (format != "table")
+    {
+      std::ofstream file;
+      std::ostream stdout_stream(stdout_buf);
+      if (!output.empty())
+      {
+        file.open(output);
+        if (!file)
+        {
+          std::cerr << "Cannot open " << output << std::endl;
+          return 1;
+        }
+      }
+      std::ostream &out = output.empty() ? stdout_stream : file;
+      if (format == "csv")
+        bench::write_csv(out, rows);
+      else
+        bench::write_json(out, rows, opt);
+    }
   }
 
-  // --- Write-Heavy ---
-  std::cout << "\n--- SCENARIO: WRITE-HEAVY (50% Writes) ---" << std::endl;
+  if (wants("false-sharing"))
   {
-    sync_prim::upgrade_mutex mtx;
-    ProtectedData data;
-    run_benchmark("upgrade_mutex (write-heavy)", [&]()
-                  { write_heavy_benchmark(mtx, data); });
+    const std::size_t num_slots = std::max(2u, std::thread::hardware_concurrency());
+    std::cout << "\n--- SCENARIO: FALSE SHARING (" << num_slots << " Threads, One Lock Each) ---" << std::endl;
+    {
+      std::vector<PackedCounter> slots(num_slots);
+      run_benchmark("packed {futex_mutex, counter} (false-sharing)", [&]()
+                    { false_sharing_benchmark(slots); });
+    }
+    {
+      std::vector<PaddedCounter> slots(num_slots);
+      run_benchmark("padded_upgrade_mutex<futex_mutex> (false-sharing)", [&]()
+                    { false_sharing_benchmark(slots); });
+    }
+    {
+      std::vector<sync_prim::synchronized<long long, futex_mutex>> slots(num_slots);
+      run_benchmark("synchronized<..., futex_mutex> (false-sharing)", [&]()
+                    { synchronized_false_sharing_benchmark(slots); });
+    }
   }
+
+  if (wants("writer-wait"))
   {
-    std::shared_mutex mtx;
-    ProtectedData data;
-    run_benchmark("std::shared_mutex (write-heavy)", [&]()
-                  { write_heavy_benchmark(mtx, data); });
+    std::cout << "\n--- SCENARIO: WRITER WAIT TIME (7 Continuous Readers, 1 Writer) ---" << std::endl;
+    writer_wait_benchmark<sync_prim::upgrade_mutex>("upgrade_mutex<reader_preferring>");
+    writer_wait_benchmark<writer_preferring_mutex>("upgrade_mutex<writer_preferring>");
+    writer_wait_benchmark<phase_fair_mutex>("upgrade_mutex<phase_fair>");
+    writer_wait_benchmark<handoff_mutex>("upgrade_mutex<direct_handoff>");
+    writer_wait_benchmark<distributed_mutex>("distributed_upgrade_mutex");
+    writer_wait_benchmark<queued_mutex>("queued_upgrade_mutex");
   }
+
+  if (wants("upgrade-contention"))
+    upgrade_contention_scenario(opt);
+
+  if (wants("write-combining"))
+    write_combining_scenario(opt);
+
+  if (wants("cross-node"))
   {
-    std::mutex mtx;
-    ProtectedData data;
-    run_benchmark("std::mutex (write-heavy)", [&]()
-                  { write_heavy_benchmark(mtx, data); });
+    std::size_t node_count = 0;
+    const std::vector<unsigned> cpus = cpus_interleaved_by_node(node_count);
+    std::cout << "\n--- SCENARIO: CROSS-NODE WRITES (" << cpus.size() << " Pinned CPUs on " << node_count << " NUMA Nodes) ---" << std::endl;
+    {
+      spin_then_park_mutex mtx;
+      ProtectedData data;
+      run_benchmark("upgrade_mutex (cross-node)", [&]()
+                    { cross_node_benchmark(mtx, data, cpus); });
+    }
+    {
+      distributed_mutex mtx;
+      ProtectedData data;
+      run_benchmark("distributed_upgrade_mutex (cross-node)", [&]()
+                    { cross_node_benchmark(mtx, data, cpus); });
+    }
+    {
+      numa_mutex mtx;
+      ProtectedData data;
+      run_benchmark("numa_upgrade_mutex (cross-node)", [&]()
+                    { cross_node_benchmark(mtx, data, cpus); });
+    }
   }
 
-  // --- Upgrade-Heavy ---
-  std::cout << "\n--- SCENARIO: UPGRADE-HEAVY (Read, Conditionally Write) ---" << std::endl;
+  if (wants("stats"))
   {
-    sync_prim::upgrade_mutex mtx;
-    ProtectedData data;
-    run_benchmark("upgrade_mutex (upgrade-heavy)", [&]()
-                  { upgrade_heavy_benchmark(mtx, data); });
+    std::cout << "\n--- SCENARIO: CONTENTION STATISTICS (" << opt.threads.back() << " Threads, Upgrade-Heavy) ---" << std::endl;
+    stats_scenario(opt);
   }
 
   std::cout << "\n--- Benchmarks Complete ---" << std::endl;
+  std::cout.rdbuf(stdout_buf);
 
   return 0;
 }
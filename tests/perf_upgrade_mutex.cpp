@@ -0,0 +1,318 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Performance regression suite. Each metric is a cost, timed against std::mutex
+// lock()/unlock() measured in the same run, so the baseline carries over
+// between machines better than raw nanoseconds would. Fails when a metric
+// exceeds its baseline by more than the baseline's tolerance.
+//
+//   perf_tests --baseline=tests/perf_baseline.csv            Check
+//   perf_tests --baseline=tests/perf_baseline.csv --update   Re-record
+
+#include "sync_prim/upgrade_mutex.hpp"
+#include "benchmark_harness.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using perf_mutex = sync_prim::upgrade_mutex;
+
+// ===================================================================
+//                        MEASUREMENT
+// ===================================================================
+
+struct settings
+{
+  unsigned repeats = 7;               // Timed batches per micro-benchmark; the fastest counts
+  unsigned batch = 200000;            // Operations per batch
+  std::vector<unsigned> threads{1, 4}; // Thread counts for the scaling metrics
+  bench::options scaling;             // Harness options for the scaling metrics
+};
+
+// Nanoseconds per call of `op`, the minimum over `repeats` batches. The
+// minimum filters out preemption and frequency ramps, which only add time.
+template <typename Op>
+double ns_per_op(const settings &cfg, Op op)
+{
+  for (unsigned i = 0; i < cfg.batch / 10; ++i)
+    op();
+  double best = 0;
+  for (unsigned r = 0; r < cfg.repeats; ++r)
+  {
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < cfg.batch; ++i)
+      op();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / cfg.batch;
+    if (r == 0 || ns < best)
+      best = ns;
+  }
+  return best;
+}
+
+struct metric
+{
+  std::string name;
+  double ratio = 0; // Cost relative to the calibration
+  double raw_ns = 0;
+};
+
+template <typename Add>
+void single_threaded_metrics(const settings &cfg, Add &add)
+{
+  // --- Uncontended acquire/release per mode ---
+  perf_mutex mtx;
+  add("uncontended.exclusive", ns_per_op(cfg, [&]
+                                         { mtx.lock(); mtx.unlock(); }));
+  add("uncontended.shared", ns_per_op(cfg, [&]
+                                      { mtx.lock_shared(); mtx.unlock_shared(); }));
+  add("uncontended.upgrade", ns_per_op(cfg, [&]
+                                       { mtx.lock_upgrade(); mtx.unlock_upgrade(); }));
+  add("uncontended.try_lock", ns_per_op(cfg, [&]
+                                        { if (mtx.try_lock()) mtx.unlock(); }));
+
+  // --- Transitions, each as a round trip from a held lock ---
+  {
+    sync_prim::upgrade_lock<perf_mutex> u_lock(mtx);
+    add("transition.upgrade_to_unique", ns_per_op(cfg, [&]
+                                                  { sync_prim::scoped_upgrade<perf_mutex> write(u_lock); }));
+  }
+  add("transition.unique_to_shared", ns_per_op(cfg, [&]
+                                               {
+    sync_prim::unique_lock<perf_mutex> x_lock(mtx);
+    sync_prim::shared_lock<perf_mutex> s_lock(std::move(x_lock)); }));
+  add("transition.shared_to_upgrade", ns_per_op(cfg, [&]
+                                                {
+    sync_prim::shared_lock<perf_mutex> s_lock(mtx);
+    sync_prim::upgrade_lock<perf_mutex> u_lock(std::move(s_lock), std::try_to_lock); }));
+}
+
+std::vector<metric> measure(const settings &cfg)
+{
+  std::vector<metric> out;
+  double calibration = 0;
+  auto add = [&](const std::string &name, double ns)
+  { out.push_back({name, ns / calibration, ns}); };
+
+  // The single-threaded metrics run on a thread pinned to one CPU, so that
+  // the scaling threads below do not inherit the affinity.
+  std::thread([&]()
+              {
+    bench::pin_to_cpu(0);
+    std::mutex calibration_mtx;
+    calibration = ns_per_op(cfg, [&]
+                            { calibration_mtx.lock(); calibration_mtx.unlock(); });
+    single_threaded_metrics(cfg, add); })
+      .join();
+
+  // --- N-thread scaling: time per completed operation, all threads together ---
+  for (const bench::workload &mix : {bench::workload{"read_heavy", 95, 0}, bench::workload{"mixed", 70, 10}})
+  {
+    for (unsigned n : cfg.threads)
+    {
+      bench::result_row row = bench::run_point<perf_mutex>("upgrade_mutex", mix, n, cfg.scaling);
+      add("scaling." + mix.name + ".t" + std::to_string(n), row.ops_per_sec_median > 0 ? 1e9 / row.ops_per_sec_median : 0);
+    }
+  }
+
+  add("calibration.std_mutex", calibration);
+  return out;
+}
+
+// ===================================================================
+//                        BASELINE
+// ===================================================================
+
+// One line per metric: `name,ratio,tolerance`. `#` starts a comment.
+struct baseline_entry
+{
+  double ratio = 0;
+  double tolerance = 0;
+};
+
+bool read_baseline(const std::string &path, std::map<std::string, baseline_entry> &entries)
+{
+  std::ifstream in(path);
+  if (!in)
+    return false;
+  for (std::string line; std::getline(in, line);)
+  {
+    if (line.empty() || line[0] == '#')
+      continue;
+    std::stringstream fields(line);
+    std::string name, ratio, tolerance;
+    std::getline(fields, name, ',');
+    std::getline(fields, ratio, ',');
+    std::getline(fields, tolerance, ',');
+    if (name.empty() || ratio.empty() || tolerance.empty())
+    {
+      std::cerr << "Malformed baseline line: " << line << std::endl;
+      return false;
+    }
+    entries[name] = {std::strtod(ratio.c_str(), nullptr), std::strtod(tolerance.c_str(), nullptr)};
+  }
+  return true;
+}
+
+bool write_baseline(const std::string &path, const std::vector<metric> &metrics,
+                    const std::map<std::string, baseline_entry> &previous, double default_tolerance)
+{
+  std::ofstream out(path);
+  if (!out)
+    return false;
+  out << "# perf_tests baseline: metric, cost relative to calibration.std_mutex, allowed relative increase.\n"
+         "# Re-record with: perf_tests --baseline=<this file> --update\n";
+  for (const metric &m : metrics)
+  {
+    if (m.name.rfind("calibration.", 0) == 0)
+      continue;
+    auto it = previous.find(m.name);
+    double tolerance = it != previous.end() ? it->second.tolerance : default_tolerance;
+    out << m.name << ',' << std::fixed << std::setprecision(3) << m.ratio << ',' << std::setprecision(2) << tolerance << "\n";
+  }
+  return true;
+}
+
+// ===================================================================
+//                        COMMAND LINE
+// ===================================================================
+
+void print_usage()
+{
+  std::cout << "Usage: perf_tests [options]\n"
+               "  --baseline=PATH       Baseline to check against (or to write with --update)\n"
+               "  --update              Record the current results as the baseline\n"
+               "  --tolerance=X         Override every baseline tolerance (0.5 allows +50%)\n"
+               "  --repeats=N           Timed batches per micro-benchmark (default: 7)\n"
+               "  --threads=LIST        Thread counts for the scaling metrics (default: 1,4)\n";
+}
+
+int main(int argc, char **argv)
+{
+  settings cfg;
+  cfg.scaling.warmup = std::chrono::milliseconds(10);
+  cfg.scaling.duration = std::chrono::milliseconds(50);
+  cfg.scaling.trials = 5;
+  std::string baseline_path;
+  bool update = false;
+  double tolerance_override = -1;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    std::size_t eq = arg.find('=');
+    std::string flag = arg.substr(0, eq);
+    std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+    if (flag == "--help" || flag == "-h")
+    {
+      print_usage();
+      return 0;
+    }
+    else if (flag == "--baseline")
+      baseline_path = value;
+    else if (flag == "--update")
+      update = true;
+    else if (flag == "--tolerance")
+      tolerance_override = std::strtod(value.c_str(), nullptr);
+    else if (flag == "--repeats")
+      cfg.repeats = std::max(1u, static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10)));
+    else if (flag == "--threads")
+    {
+      cfg.threads.clear();
+      std::stringstream list(value);
+      for (std::string n; std::getline(list, n, ',');)
+        if (!n.empty())
+          cfg.threads.push_back(std::max(1u, static_cast<unsigned>(std::strtoul(n.c_str(), nullptr, 10))));
+    }
+    else
+    {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      print_usage();
+      return 2;
+    }
+  }
+
+  std::map<std::string, baseline_entry> baseline;
+  bool have_baseline = !baseline_path.empty() && read_baseline(baseline_path, baseline);
+  if (!baseline_path.empty() && !have_baseline && !update)
+  {
+    std::cerr << "Cannot read baseline " << baseline_path << std::endl;
+    return 2;
+  }
+
+  std::cout << "--- Running Performance Regression Tests ---" << std::endl;
+  std::vector<metric> metrics = measure(cfg);
+
+  int regressions = 0;
+  std::cout << std::left << std::setw(34) << "metric" << std::right << std::setw(10) << "ns" << std::setw(10) << "ratio"
+            << std::setw(10) << "baseline" << std::setw(8) << "limit" << "\n";
+  for (const metric &m : metrics)
+  {
+    std::cout << std::left << std::setw(34) << m.name << std::right << std::fixed << std::setprecision(1) << std::setw(10) << m.raw_ns
+              << std::setprecision(3) << std::setw(10) << m.ratio;
+    auto it = baseline.find(m.name);
+    if (update || it == baseline.end())
+    {
+      std::cout << (update || m.name.rfind("calibration.", 0) == 0 ? "" : "  (not in baseline)") << "\n";
+      continue;
+    }
+    double tolerance = tolerance_override >= 0 ? tolerance_override : it->second.tolerance;
+    double limit = it->second.ratio * (1 + tolerance);
+    std::cout << std::setw(10) << it->second.ratio << std::setprecision(0) << std::setw(7) << tolerance * 100 << "%";
+    if (m.ratio > limit)
+    {
+      std::cout << "  [FAIL] regression";
+      ++regressions;
+    }
+    else if (m.ratio < it->second.ratio / (1 + tolerance))
+      std::cout << "  (faster; consider --update)";
+    std::cout << "\n";
+  }
+
+  if (update)
+  {
+    if (baseline_path.empty() || !write_baseline(baseline_path, metrics, baseline, 0.5))
+    {
+      std::cerr << "Cannot write baseline " << baseline_path << std::endl;
+      return 2;
+    }
+    std::cout << "Baseline written to " << baseline_path << std::endl;
+    return 0;
+  }
+  if (regressions)
+  {
+    std::cerr << regressions << " metric(s) regressed beyond tolerance" << std::endl;
+    return 1;
+  }
+  std::cout << (have_baseline ? "[PASS] No regressions" : "[PASS] No baseline given; measured only") << std::endl;
+  return 0;
+}
@@ -0,0 +1,545 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Randomized stress test for every mutex variant. Each thread runs a random
+// mix of blocking, try and timed acquisitions and guard transitions. Shadow
+// counters, updated inside the critical sections, check the exclusion rules
+// on every entry: a writer excludes everything, a reader excludes writers,
+// and there is at most one upgrader. Plain (non-atomic) data, written only
+// under exclusive locks, checks the memory ordering, and ThreadSanitizer
+// reports any access the locks fail to order:
+//
+// - readers and upgraders see the two halves of every write equal;
+// - nothing is written between an upgrader's read and its conversion;
+// - no exclusive section is lost, by the final total.
+//
+// Violations are counted, not asserted, so optimized builds check them too.
+// --perturb adds random yields and short sleeps inside and between critical
+// sections to shake out rare interleavings; --seconds runs for a fixed time.
+// A watchdog fails the run if no operation completes for --stall seconds.
+
+#include "sync_prim/upgrade_mutex.hpp"
+#include "sync_prim/distributed_upgrade_mutex.hpp"
+#include "sync_prim/numa_upgrade_mutex.hpp"
+#include "sync_prim/queued_upgrade_mutex.hpp"
+#include "sync_prim/recursive_upgrade_mutex.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ===================================================================
+//                        CONFIGURATION
+// ===================================================================
+
+struct stress_options
+{
+  unsigned threads = std::max(8u, 2 * std::thread::hardware_concurrency());
+  uint64_t ops = 200000; // Per thread, unless `seconds` is set
+  unsigned seconds = 0;
+  unsigned stall_seconds = 10; // Watchdog: fail if no operation completes for this long
+  uint64_t seed = 1;
+  bool perturb = false;
+  std::vector<std::string> mutex_filters;
+};
+
+// A per-thread xorshift generator.
+struct rng
+{
+  uint64_t state;
+
+  uint64_t next()
+  {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  }
+  unsigned below(unsigned n) { return static_cast<unsigned>(next() % n); }
+};
+
+// ===================================================================
+//                        INVARIANT CHECKER
+// ===================================================================
+
+// Counters are raised just after a mode is acquired and lowered just before
+// it is released, so they never under-report the true holders.
+class checker
+{
+public:
+  explicit checker(const stress_options &opt) : perturb_(opt.perturb) {}
+
+  void enter_shared(rng &r)
+  {
+    readers_.fetch_add(1, std::memory_order_seq_cst);
+    if (writers_.load(std::memory_order_seq_cst))
+      fail("reader admitted while a writer holds the lock");
+    long long a = a_;
+    pause(r);
+    if (a != b_)
+      fail("reader saw a torn write");
+  }
+  void exit_shared() { readers_.fetch_sub(1, std::memory_order_seq_cst); }
+
+  // Returns the value the upgrader read, to be checked at conversion.
+  long long enter_upgrade(rng &r)
+  {
+    if (upgraders_.fetch_add(1, std::memory_order_seq_cst))
+      fail("two upgraders at once");
+    if (writers_.load(std::memory_order_seq_cst))
+      fail("upgrader admitted while a writer holds the lock");
+    long long a = a_;
+    pause(r);
+    if (a != b_)
+      fail("upgrader saw a torn write");
+    return a;
+  }
+  void exit_upgrade() { upgraders_.fetch_sub(1, std::memory_order_seq_cst); }
+
+  void enter_exclusive()
+  {
+    if (writers_.fetch_add(1, std::memory_order_seq_cst))
+      fail("two writers at once");
+    if (readers_.load(std::memory_order_seq_cst))
+      fail("writer admitted while readers hold the lock");
+    if (upgraders_.load(std::memory_order_seq_cst))
+      fail("writer admitted while an upgrader holds the lock");
+  }
+  void exit_exclusive() { writers_.fetch_sub(1, std::memory_order_seq_cst); }
+
+  // Called by the upgrader once it holds the exclusive lock.
+  void convert(long long seen)
+  {
+    exit_upgrade();
+    enter_exclusive();
+    if (a_ != seen)
+      fail("a write slipped in between the upgrade lock and its conversion");
+  }
+
+  void write(rng &r)
+  {
+    ++a_;
+    pause(r);
+    ++b_;
+    writes_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void pause(rng &r)
+  {
+    if (!perturb_)
+      return;
+    unsigned roll = r.below(64);
+    if (roll == 0)
+      std::this_thread::sleep_for(std::chrono::microseconds(20));
+    else if (roll < 8)
+      std::this_thread::yield();
+  }
+
+  bool finish(uint64_t &writes)
+  {
+    writes = writes_.load();
+    if (a_ != b_ || a_ != static_cast<long long>(writes))
+      fail("lost exclusive section: total does not match the writes made");
+    return violations_.load() == 0;
+  }
+
+  void fail(const char *what)
+  {
+    if (violations_.fetch_add(1) < 10)
+      std::cerr << "  violation: " << what << std::endl;
+  }
+
+private:
+  bool perturb_;
+  std::atomic<int> readers_{0};
+  std::atomic<int> upgraders_{0};
+  std::atomic<int> writers_{0};
+  std::atomic<uint64_t> violations_{0};
+  std::atomic<uint64_t> writes_{0};
+  long long a_ = 0; // Written only under an exclusive lock, a_ then b_
+  long long b_ = 0;
+};
+
+// ===================================================================
+//                        OPERATIONS
+// ===================================================================
+
+template <typename Mutex>
+class stress_worker
+{
+public:
+  stress_worker(Mutex &mtx, checker &check, uint64_t seed) : mtx_(mtx), check_(check), rng_{seed} {}
+
+  // One random operation. Failed try and timed acquisitions do nothing.
+  void step()
+  {
+    switch (rng_.below(12))
+    {
+    case 0:
+      return read(sync_prim::shared_lock<Mutex>(mtx_));
+    case 1:
+      return read(sync_prim::shared_lock<Mutex>(mtx_, std::try_to_lock));
+    case 2:
+      return read(sync_prim::shared_lock<Mutex>(mtx_, timeout()));
+    case 3:
+      return write(sync_prim::unique_lock<Mutex>(mtx_));
+    case 4:
+      return write(rng_.below(2) ? sync_prim::unique_lock<Mutex>(mtx_, std::try_to_lock) : sync_prim::unique_lock<Mutex>(mtx_, timeout()));
+    case 5:
+    case 6:
+      return upgrade(sync_prim::upgrade_lock<Mutex>(mtx_));
+    case 7:
+      return upgrade(rng_.below(2) ? sync_prim::upgrade_lock<Mutex>(mtx_, std::try_to_lock) : sync_prim::upgrade_lock<Mutex>(mtx_, timeout()));
+    case 8:
+      return write_then_downgrade();
+    case 9:
+    case 10:
+      return escalate_from_shared();
+    default:
+      check_.pause(rng_);
+      return;
+    }
+  }
+
+private:
+  std::chrono::microseconds timeout() { return std::chrono::microseconds(rng_.below(500)); }
+
+  void read(sync_prim::shared_lock<Mutex> s_lock)
+  {
+    if (!s_lock.owns_lock())
+      return;
+    check_.enter_shared(rng_);
+    check_.exit_shared();
+  }
+
+  void write(sync_prim::unique_lock<Mutex> x_lock)
+  {
+    if (!x_lock.owns_lock())
+      return;
+    check_.enter_exclusive();
+    check_.write(rng_);
+    check_.exit_exclusive();
+  }
+
+  // Read under the upgrade lock, then convert by one of the four routes and
+  // write, sometimes twice by way of a downgrade.
+  void upgrade(sync_prim::upgrade_lock<Mutex> u_lock)
+  {
+    if (!u_lock.owns_lock())
+      return;
+    long long seen = check_.enter_upgrade(rng_);
+    sync_prim::unique_lock<Mutex> x_lock;
+    switch (rng_.below(4))
+    {
+    case 0:
+      x_lock = sync_prim::unique_lock<Mutex>(std::move(u_lock));
+      break;
+    case 1:
+      x_lock = sync_prim::unique_lock<Mutex>(std::move(u_lock), std::try_to_lock);
+      break;
+    case 2:
+      x_lock = sync_prim::unique_lock<Mutex>(std::move(u_lock), timeout());
+      break;
+    default:
+    {
+      sync_prim::scoped_upgrade<Mutex> s_upgrade(u_lock);
+      check_.convert(seen);
+      check_.write(rng_);
+      check_.exit_exclusive();
+      // Destructor downgrades back to upgrade
+      seen = check_.enter_upgrade(rng_);
+      break;
+    }
+    }
+    if (!x_lock.owns_lock())
+    {
+      // The conversion failed or was scoped: still upgradeable
+      check_.exit_upgrade();
+      return;
+    }
+    check_.convert(seen);
+    check_.write(rng_);
+    if (rng_.below(2))
+    {
+      check_.exit_exclusive();
+      sync_prim::upgrade_lock<Mutex> again(std::move(x_lock));
+      check_.enter_upgrade(rng_);
+      check_.exit_upgrade();
+      return;
+    }
+    check_.exit_exclusive();
+  }
+
+  void write_then_downgrade()
+  {
+    sync_prim::unique_lock<Mutex> x_lock(mtx_);
+    check_.enter_exclusive();
+    check_.write(rng_);
+    check_.exit_exclusive();
+    read(sync_prim::shared_lock<Mutex>(std::move(x_lock)));
+  }
+
+  // Read, then try to escalate in place to upgrade or exclusive.
+  void escalate_from_shared()
+  {
+    sync_prim::shared_lock<Mutex> s_lock(mtx_);
+    check_.enter_shared(rng_);
+    if (rng_.below(2))
+    {
+      sync_prim::upgrade_lock<Mutex> u_lock(std::move(s_lock), std::try_to_lock);
+      check_.exit_shared();
+      if (!u_lock.owns_lock())
+        return;
+      long long seen = check_.enter_upgrade(rng_);
+      sync_prim::scoped_upgrade<Mutex> s_upgrade(u_lock);
+      check_.convert(seen);
+      check_.write(rng_);
+      check_.exit_exclusive();
+      check_.enter_upgrade(rng_);
+      check_.exit_upgrade();
+      return;
+    }
+    sync_prim::unique_lock<Mutex> x_lock(std::move(s_lock), std::try_to_lock);
+    check_.exit_shared();
+    if (!x_lock.owns_lock())
+      return;
+    check_.enter_exclusive();
+    check_.write(rng_);
+    check_.exit_exclusive();
+  }
+
+  Mutex &mtx_;
+  checker &check_;
+  rng rng_;
+};
+
+// ===================================================================
+//                        RUNNER
+// ===================================================================
+
+// Each worker counts its finished operations in its own cache line, so the
+// watchdog can tell a deadlock or a lost wakeup from a slow run.
+struct alignas(64) progress_slot
+{
+  std::atomic<uint64_t> done{0};
+};
+
+template <typename Mutex>
+bool run_stress(const std::string &name, const stress_options &opt)
+{
+  Mutex mtx;
+  checker check(opt);
+  std::atomic<bool> go{false};
+  std::atomic<unsigned> finished{0};
+  std::vector<progress_slot> progress(opt.threads);
+  std::chrono::steady_clock::time_point stop_at;
+
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < opt.threads; ++t)
+  {
+    threads.emplace_back([&, t]()
+                         {
+      stress_worker<Mutex> worker(mtx, check, opt.seed * 0x9e3779b97f4a7c15ull + t + 1);
+      while (!go.load(std::memory_order_acquire))
+        std::this_thread::yield();
+      for (uint64_t done = 0;; ++done)
+      {
+        if (opt.seconds ? (done % 1024 == 0 && std::chrono::steady_clock::now() >= stop_at) : done >= opt.ops)
+          break;
+        worker.step();
+        progress[t].done.store(done + 1, std::memory_order_relaxed);
+      }
+      finished.fetch_add(1, std::memory_order_release); });
+  }
+  auto begin = std::chrono::steady_clock::now();
+  stop_at = begin + std::chrono::seconds(opt.seconds);
+  go.store(true, std::memory_order_release);
+
+  auto total_ops = [&]
+  {
+    uint64_t total = 0;
+    for (const progress_slot &slot : progress)
+      total += slot.done.load(std::memory_order_relaxed);
+    return total;
+  };
+  uint64_t last_total = 0;
+  auto last_change = begin;
+  while (finished.load(std::memory_order_acquire) < opt.threads)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    uint64_t total = total_ops();
+    auto now = std::chrono::steady_clock::now();
+    if (total != last_total)
+    {
+      last_total = total;
+      last_change = now;
+    }
+    else if (now - last_change >= std::chrono::seconds(opt.stall_seconds))
+    {
+      // The workers are stuck in the mutex, so they cannot be joined
+      std::cout << "[FAIL] " << name << ": no progress for " << opt.stall_seconds << " s after " << total
+                << " ops (deadlock or lost wakeup)" << std::endl;
+      std::_Exit(1);
+    }
+  }
+  for (auto &t : threads)
+    t.join();
+  double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+  uint64_t writes = 0;
+  bool ok = check.finish(writes);
+  std::cout << (ok ? "[PASS] " : "[FAIL] ") << name << ": " << total_ops() << " ops, " << writes << " writes, "
+            << opt.threads << " threads in " << secs << " s" << std::endl;
+  return ok;
+}
+
+struct stress_variant
+{
+  std::string name;
+  std::function<bool(const stress_options &)> run;
+};
+
+template <typename Mutex>
+stress_variant make_variant(std::string name)
+{
+  return {name, [name](const stress_options &opt)
+          { return run_stress<Mutex>(name, opt); }};
+}
+
+// ===================================================================
+//                        COMMAND LINE
+// ===================================================================
+
+void print_usage()
+{
+  std::cout << "Usage: stress_tests [options]\n"
+               "  --threads=N           Worker threads (default: max(8, 2 x hardware_concurrency))\n"
+               "  --ops=N               Operations per thread (default: 200000)\n"
+               "  --seconds=N           Run each variant for N seconds instead of a fixed count\n"
+               "  --stall=N             Fail if no operation completes for N seconds (default: 10)\n"
+               "  --seed=N              Seed for the operation mix (default: 1)\n"
+               "  --perturb             Random yields and sleeps inside and between critical sections\n"
+               "  --mutex=LIST          Only variants whose name contains one of these substrings\n"
+               "  --list                List the mutex variants and exit\n";
+}
+
+uint64_t to_number(const std::string &value, const std::string &flag)
+{
+  char *end = nullptr;
+  unsigned long long n = std::strtoull(value.c_str(), &end, 10);
+  if (value.empty() || *end != '\0')
+  {
+    std::cerr << "Invalid value for " << flag << ": " << value << std::endl;
+    std::exit(2);
+  }
+  return n;
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<stress_variant> variants = {
+      make_variant<sync_prim::upgrade_mutex>("upgrade_mutex"),
+      make_variant<sync_prim::basic_upgrade_mutex<sync_prim::pure_spin>>("upgrade_mutex<pure_spin>"),
+      make_variant<sync_prim::basic_upgrade_mutex<sync_prim::immediate_park>>("upgrade_mutex<immediate_park>"),
+      make_variant<sync_prim::basic_upgrade_mutex<sync_prim::futex_backend>>("upgrade_mutex<futex_backend>"),
+      make_variant<sync_prim::basic_upgrade_mutex<sync_prim::writer_preferring>>("upgrade_mutex<writer_preferring>"),
+      make_variant<sync_prim::basic_upgrade_mutex<sync_prim::phase_fair>>("upgrade_mutex<phase_fair>"),
+      make_variant<sync_prim::basic_upgrade_mutex<sync_prim::direct_handoff>>("upgrade_mutex<direct_handoff>"),
+      make_variant<sync_prim::basic_upgrade_mutex<sync_prim::optimistic_reads>>("upgrade_mutex<optimistic_reads>"),
+      make_variant<sync_prim::basic_upgrade_mutex<sync_prim::wide_state>>("upgrade_mutex<wide_state>"),
+      make_variant<sync_prim::basic_upgrade_mutex<sync_prim::bounded_readers<2>>>("upgrade_mutex<bounded_readers<2>>"),
+      make_variant<sync_prim::distributed_upgrade_mutex<>>("distributed_upgrade_mutex"),
+      make_variant<sync_prim::numa_upgrade_mutex<>>("numa_upgrade_mutex"),
+      make_variant<sync_prim::queued_upgrade_mutex<>>("queued_upgrade_mutex"),
+      make_variant<sync_prim::recursive_upgrade_mutex<>>("recursive_upgrade_mutex"),
+  };
+
+  stress_options opt;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    std::size_t eq = arg.find('=');
+    std::string flag = arg.substr(0, eq);
+    std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+    if (flag == "--help" || flag == "-h")
+    {
+      print_usage();
+      return 0;
+    }
+    else if (flag == "--list")
+    {
+      for (const stress_variant &v : variants)
+        std::cout << v.name << "\n";
+      return 0;
+    }
+    else if (flag == "--threads")
+      opt.threads = std::max<unsigned>(1, static_cast<unsigned>(to_number(value, flag)));
+    else if (flag == "--ops")
+      opt.ops = to_number(value, flag);
+    else if (flag == "--seconds")
+      opt.seconds = static_cast<unsigned>(to_number(value, flag));
+    else if (flag == "--stall")
+      opt.stall_seconds = std::max<unsigned>(1, static_cast<unsigned>(to_number(value, flag)));
+    else if (flag == "--seed")
+      opt.seed = to_number(value, flag);
+    else if (flag == "--perturb")
+      opt.perturb = true;
+    else if (flag == "--mutex")
+    {
+      std::stringstream list(value);
+      for (std::string item; std::getline(list, item, ',');)
+        if (!item.empty())
+          opt.mutex_filters.push_back(item);
+    }
+    else
+    {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      print_usage();
+      return 2;
+    }
+  }
+
+  std::cout << "--- Running Stress Tests ---" << std::endl;
+  int failures = 0;
+  for (const stress_variant &v : variants)
+  {
+    bool selected = opt.mutex_filters.empty() ||
+                    std::any_of(opt.mutex_filters.begin(), opt.mutex_filters.end(), [&](const std::string &f)
+                                { return v.name.find(f) != std::string::npos; });
+    if (selected && !v.run(opt))
+      ++failures;
+  }
+  if (failures)
+  {
+    std::cerr << failures << " variant(s) violated an invariant" << std::endl;
+    return 1;
+  }
+  return 0;
+}
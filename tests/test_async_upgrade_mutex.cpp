@@ -0,0 +1,263 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sync_prim/async_upgrade_mutex.hpp"
+#include "test_utils.hpp"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using mutex_type = sync_prim::async_upgrade_mutex<>;
+using x_guard = sync_prim::unique_lock<mutex_type>;
+using s_guard = sync_prim::shared_lock<mutex_type>;
+using u_guard = sync_prim::upgrade_lock<mutex_type>;
+
+// ===================================================================
+//                     CONTINUATION TESTS
+// ===================================================================
+
+void test_fast_path_runs_inline()
+{
+  mutex_type mtx;
+  bool ran = false;
+  mtx.async_lock_shared([&](s_guard lock)
+                        { ran = lock.owns_lock(); });
+  assert(ran);
+  assert(mtx.async_waiters() == 0);
+  assert(mtx.try_lock());
+  mtx.unlock();
+}
+
+void test_release_grants_in_order()
+{
+  mutex_type mtx;
+  std::vector<std::string> order;
+  std::vector<s_guard> readers;
+  mtx.lock();
+  mtx.async_lock_shared([&](s_guard lock)
+                        { order.push_back("r1"); readers.push_back(std::move(lock)); });
+  mtx.async_lock_shared([&](s_guard lock)
+                        { order.push_back("r2"); readers.push_back(std::move(lock)); });
+  mtx.async_lock([&](x_guard)
+                 { order.push_back("w"); });
+  mtx.async_lock_shared([&](s_guard)
+                        { order.push_back("r3"); });
+  assert(order.empty() && mtx.async_waiters() == 4);
+
+  // Both leading readers are granted together; the writer waits for them,
+  // and the reader behind it waits for the writer.
+  mtx.unlock();
+  assert((order == std::vector<std::string>{"r1", "r2"}));
+  assert(mtx.async_waiters() == 2);
+  readers.clear();
+  assert((order == std::vector<std::string>{"r1", "r2", "w", "r3"}));
+  assert(mtx.async_waiters() == 0);
+  assert(mtx.try_lock());
+  mtx.unlock();
+}
+
+void test_async_upgrade()
+{
+  mutex_type mtx;
+  bool converted = false;
+  u_guard u_lock(mtx);
+  mtx.lock_shared();
+  mtx.async_upgrade(std::move(u_lock), [&](x_guard lock)
+                    {
+    converted = lock.owns_lock();
+    bool blocked = true;
+    std::thread([&] { blocked = !mtx.try_lock_shared(); }).join();
+    assert(blocked); });
+  assert(!u_lock.owns_lock() && !converted);
+
+  // The pending conversion holds back queued readers.
+  bool read = false;
+  mtx.async_lock_shared([&](s_guard)
+                        { read = true; });
+  assert(!read && mtx.async_waiters() == 2);
+
+  mtx.unlock_shared();
+  assert(converted && read);
+  assert(mtx.async_waiters() == 0);
+  assert(mtx.try_lock());
+  mtx.unlock();
+}
+
+void test_executor()
+{
+  std::deque<mutex_type::task> pending;
+  mutex_type mtx([&](mutex_type::task t)
+                 { pending.push_back(std::move(t)); });
+  bool ran = false;
+  mtx.lock_upgrade();
+  mtx.async_lock_upgrade([&](u_guard)
+                         { ran = true; });
+  mtx.unlock_upgrade();
+
+  // Granted at the release, but run only when the executor gets to it.
+  assert(!ran && pending.size() == 1 && mtx.async_waiters() == 0);
+  assert(!mtx.try_lock_upgrade());
+  pending.front()();
+  pending.pop_front();
+  assert(ran);
+  assert(mtx.try_lock());
+  mtx.unlock();
+}
+
+void test_guard_transitions_wake_waiters()
+{
+  mutex_type mtx;
+  bool read = false;
+  x_guard x_lock(mtx);
+  mtx.async_lock_shared([&](s_guard)
+                        { read = true; });
+  assert(!read);
+  s_guard s_lock(std::move(x_lock));
+  assert(read);
+}
+
+// ===================================================================
+//                        CONTENTION TESTS
+// ===================================================================
+
+void test_mixed_sync_and_async_writers()
+{
+  mutex_type mtx;
+  long counter = 0;
+  std::atomic<int> done{0};
+  const int threads = 4;
+  const int iterations = 2000;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t)
+  {
+    workers.emplace_back([&, t]()
+                         {
+      for (int i = 0; i < iterations; ++i)
+      {
+        if ((i + t) % 2 == 0)
+        {
+          mtx.async_lock([&](x_guard) { ++counter; ++done; });
+        }
+        else
+        {
+          x_guard lock(mtx);
+          ++counter;
+          ++done;
+        }
+      } });
+  }
+  for (auto &w : workers)
+    w.join();
+  // Every queued continuation has been granted by some release.
+  assert(done == threads * iterations);
+  assert(mtx.async_waiters() == 0);
+  assert(counter == threads * iterations);
+}
+
+#if SYNC_PRIM_HAS_COROUTINES
+// ===================================================================
+//                        COROUTINE TESTS
+// ===================================================================
+
+// A coroutine that starts eagerly and frees itself when it finishes.
+struct detached
+{
+  struct promise_type
+  {
+    detached get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+detached read_then_write(mutex_type &mtx, std::vector<std::string> &log)
+{
+  {
+    u_guard u_lock = co_await mtx.async_lock_upgrade();
+    log.push_back("upgrade");
+    x_guard x_lock = co_await mtx.async_upgrade(u_lock);
+    log.push_back("exclusive");
+  }
+  s_guard s_lock = co_await mtx.async_lock_shared();
+  log.push_back("shared");
+}
+
+void test_coroutine_fast_path()
+{
+  mutex_type mtx;
+  std::vector<std::string> log;
+  read_then_write(mtx, log);
+  // Never suspended, so it has already run to completion.
+  assert((log == std::vector<std::string>{"upgrade", "exclusive", "shared"}));
+  assert(mtx.try_lock());
+  mtx.unlock();
+}
+
+void test_coroutine_suspends()
+{
+  mutex_type mtx;
+  std::vector<std::string> log;
+  mtx.lock_upgrade();
+  read_then_write(mtx, log);
+  assert(log.empty() && mtx.async_waiters() == 1);
+  mtx.unlock_upgrade();
+  assert((log == std::vector<std::string>{"upgrade", "exclusive", "shared"}));
+
+  log.clear();
+  mtx.lock_shared();
+  read_then_write(mtx, log);
+  // Upgrade granted alongside our reader; the conversion waits for it.
+  assert((log == std::vector<std::string>{"upgrade"}));
+  mtx.unlock_shared();
+  assert((log == std::vector<std::string>{"upgrade", "exclusive", "shared"}));
+  assert(mtx.async_waiters() == 0);
+}
+#endif
+
+int main()
+{
+  std::cout << "--- Running Async Continuation Tests ---" << std::endl;
+  run_test(test_fast_path_runs_inline, "Uncontended acquisition completes synchronously");
+  run_test(test_release_grants_in_order, "Releases grant queued waiters in arrival order");
+  run_test(test_async_upgrade, "Async upgrade converts once the readers leave");
+  run_test(test_executor, "Granted waiters run through the executor");
+  run_test(test_guard_transitions_wake_waiters, "Guard downgrades wake queued readers");
+
+  std::cout << "\n--- Running Async Contention Tests ---" << std::endl;
+  run_test(test_mixed_sync_and_async_writers, "Async and blocking writers interleave without lost wakeups");
+
+#if SYNC_PRIM_HAS_COROUTINES
+  std::cout << "\n--- Running Async Coroutine Tests ---" << std::endl;
+  run_test(test_coroutine_fast_path, "co_await completes without suspending when free");
+  run_test(test_coroutine_suspends, "co_await suspends and is resumed by the release");
+#endif
+
+  return 0;
+}
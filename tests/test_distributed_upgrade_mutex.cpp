@@ -0,0 +1,271 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sync_prim/distributed_upgrade_mutex.hpp"
+#include "test_utils.hpp"
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+using dist_mutex = sync_prim::distributed_upgrade_mutex<8>;
+
+// ===================================================================
+//                        CORE LOGIC TESTS
+// ===================================================================
+
+void test_shared_lock()
+{
+  dist_mutex mtx;
+  sync_prim::shared_lock<dist_mutex> lock1(mtx);
+  sync_prim::shared_lock<dist_mutex> lock2(mtx);
+  assert(lock1.owns_lock());
+  assert(lock2.owns_lock());
+}
+
+void test_exclusive_waits_for_readers()
+{
+  dist_mutex mtx;
+  sync_prim::shared_lock<dist_mutex> s_lock(mtx);
+
+  std::atomic<bool> thread_finished = false;
+  std::thread t([&]()
+                {
+        sync_prim::unique_lock<dist_mutex> x_lock(mtx);
+        thread_finished = true; });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(!thread_finished); // The writer must wait for the reader's slot to drain
+
+  s_lock.release();
+  mtx.unlock_shared();
+
+  t.join();
+  assert(thread_finished);
+}
+
+void test_exclusive_blocks_readers()
+{
+  dist_mutex mtx;
+  sync_prim::unique_lock<dist_mutex> x_lock(mtx);
+
+  std::atomic<bool> thread_finished = false;
+  std::thread t([&]()
+                {
+        sync_prim::shared_lock<dist_mutex> s_lock(mtx);
+        thread_finished = true; });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(!thread_finished);
+
+  x_lock.release();
+  mtx.unlock();
+
+  t.join();
+  assert(thread_finished);
+}
+
+void test_upgrade_allows_readers()
+{
+  dist_mutex mtx;
+  sync_prim::upgrade_lock<dist_mutex> u_lock(mtx);
+  sync_prim::shared_lock<dist_mutex> s_lock(mtx);
+  assert(u_lock.owns_lock());
+  assert(s_lock.owns_lock());
+}
+
+void test_try_lock()
+{
+  dist_mutex mtx;
+  assert(mtx.try_lock_shared());
+  assert(!mtx.try_lock()); // A reader is present
+  assert(mtx.try_lock_upgrade());
+
+  sync_prim::upgrade_lock<dist_mutex> u_lock(mtx, std::adopt_lock);
+  sync_prim::unique_lock<dist_mutex> x_lock(std::move(u_lock), std::try_to_lock);
+  assert(!x_lock.owns_lock());
+  assert(u_lock.owns_lock());
+  assert(mtx.try_lock_shared()); // The failed upgrade must not block readers
+  mtx.unlock_shared();
+
+  mtx.unlock_shared();
+  sync_prim::unique_lock<dist_mutex> x_lock2(std::move(u_lock), std::try_to_lock);
+  assert(x_lock2.owns_lock());
+  assert(!mtx.try_lock_shared());
+}
+
+void test_timed_lock()
+{
+  using namespace std::chrono_literals;
+  dist_mutex mtx;
+  sync_prim::shared_lock<dist_mutex> s_lock(mtx);
+  sync_prim::upgrade_lock<dist_mutex> u_lock(mtx);
+
+  std::thread t([&]()
+                {
+        // The reader never leaves, so the writer must time out and undo its claim
+        assert(!mtx.try_lock_for(20ms));
+        assert(!mtx.try_lock_upgrade_for(10ms)); });
+  t.join();
+  assert(mtx.try_lock_shared_for(10ms)); // The abandoned claim must not block readers
+  mtx.unlock_shared();
+
+  sync_prim::scoped_upgrade<dist_mutex> s_upgrade(u_lock, 20ms);
+  assert(!s_upgrade.owns_lock());
+  assert(mtx.try_lock_shared());
+  mtx.unlock_shared();
+}
+
+// ===================================================================
+//                        TRANSITION TESTS
+// ===================================================================
+
+void test_upgrade_downgrade_cycle()
+{
+  dist_mutex mtx;
+  sync_prim::upgrade_lock<dist_mutex> u_lock(mtx);
+  sync_prim::unique_lock<dist_mutex> x_lock(std::move(u_lock));
+  assert(x_lock.owns_lock());
+
+  u_lock = sync_prim::upgrade_lock<dist_mutex>(std::move(x_lock));
+  assert(u_lock.owns_lock());
+
+  // Readers may join again once we are back to upgradeable
+  sync_prim::shared_lock<dist_mutex> s_lock(mtx);
+  assert(s_lock.owns_lock());
+}
+
+void test_downgrade_to_shared()
+{
+  dist_mutex mtx;
+  sync_prim::unique_lock<dist_mutex> x_lock(mtx);
+  sync_prim::shared_lock<dist_mutex> s_lock(std::move(x_lock));
+  assert(s_lock.owns_lock());
+
+  sync_prim::shared_lock<dist_mutex> s_lock2(mtx);
+  assert(s_lock2.owns_lock());
+}
+
+void test_pending_upgrade_blocks_new_readers()
+{
+  dist_mutex mtx;
+  sync_prim::upgrade_lock<dist_mutex> u_lock(mtx);
+  sync_prim::shared_lock<dist_mutex> old_reader(mtx);
+
+  std::atomic<bool> upgraded = false;
+  std::atomic<bool> new_reader_done = false;
+  std::thread upgrader([&]()
+                       {
+        sync_prim::scoped_upgrade<dist_mutex> s_upgrade(u_lock);
+        upgraded = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        assert(!new_reader_done); // Still exclusive
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(!upgraded); // Waiting for old_reader
+
+  std::thread new_reader([&]()
+                         {
+        sync_prim::shared_lock<dist_mutex> s_lock(mtx);
+        new_reader_done = true; });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(!new_reader_done); // Blocked by the pending upgrade
+
+  old_reader.release();
+  mtx.unlock_shared();
+
+  upgrader.join();
+  new_reader.join();
+  assert(upgraded && new_reader_done);
+}
+
+void test_contended_counter()
+{
+  dist_mutex mtx;
+  long long counter = 0;
+  std::vector<std::thread> threads;
+
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([&, i]()
+                         {
+        for (int op = 0; op < 500; ++op) {
+            if (i % 2 == 0) {
+                sync_prim::unique_lock<dist_mutex> x_lock(mtx);
+                ++counter;
+            } else {
+                sync_prim::upgrade_lock<dist_mutex> u_lock(mtx);
+                sync_prim::scoped_upgrade<dist_mutex> s_upgrade(u_lock);
+                ++counter;
+            }
+            sync_prim::shared_lock<dist_mutex> s_lock(mtx);
+            volatile long long val = counter; (void)val;
+        } });
+  }
+  for (auto &t : threads)
+    t.join();
+
+  assert(counter == 4 * 500);
+}
+
+void test_futex_backend()
+{
+  using futex_dist_mutex = sync_prim::distributed_upgrade_mutex<4, sync_prim::futex_backend>;
+  futex_dist_mutex mtx;
+  sync_prim::shared_lock<futex_dist_mutex> s_lock(mtx);
+
+  std::atomic<bool> thread_finished = false;
+  std::thread t([&]()
+                {
+        sync_prim::unique_lock<futex_dist_mutex> x_lock(mtx);
+        thread_finished = true; });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(!thread_finished);
+  s_lock.release();
+  mtx.unlock_shared();
+  t.join();
+  assert(thread_finished);
+}
+
+int main()
+{
+  std::cout << "--- Running Distributed Core Logic Tests ---" << std::endl;
+  run_test(test_shared_lock, "Shared lock acquisition");
+  run_test(test_exclusive_waits_for_readers, "Exclusive lock drains reader slots");
+  run_test(test_exclusive_blocks_readers, "Exclusive lock blocks new readers");
+  run_test(test_upgrade_allows_readers, "Upgrade lock allows readers");
+  run_test(test_contended_counter, "Contended mixed workload");
+  run_test(test_futex_backend, "Futex backend drain wake-up");
+  run_test(test_try_lock, "Non-blocking acquisition and upgrade");
+  run_test(test_timed_lock, "Timed acquisition and upgrade");
+
+  std::cout << "\n--- Running Distributed Transition Tests ---" << std::endl;
+  run_test(test_upgrade_downgrade_cycle, "Upgrade -> Unique -> Upgrade cycle");
+  run_test(test_downgrade_to_shared, "Unique -> Shared downgrade");
+  run_test(test_pending_upgrade_blocks_new_readers, "Pending upgrade blocks new readers");
+
+  return 0;
+}
@@ -0,0 +1,185 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sync_prim/lock_all.hpp"
+#include "sync_prim/distributed_upgrade_mutex.hpp"
+#include "test_utils.hpp"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using sync_prim::as_exclusive;
+using sync_prim::as_shared;
+using sync_prim::as_upgrade;
+using mutex_type = sync_prim::upgrade_mutex;
+
+// What another thread could take on `mtx` right now: 0 nothing, 1 shared,
+// 2 shared and upgrade, 3 everything.
+template <typename Mutex>
+int available(Mutex &mtx)
+{
+  int level = 0;
+  std::thread([&]()
+              {
+    if (mtx.try_lock()) { mtx.unlock(); level = 3; return; }
+    if (mtx.try_lock_upgrade()) { mtx.unlock_upgrade(); level = 2; return; }
+    if (mtx.try_lock_shared()) { mtx.unlock_shared(); level = 1; } })
+      .join();
+  return level;
+}
+
+// ===================================================================
+//                        CORE TESTS
+// ===================================================================
+
+void test_mixed_modes()
+{
+  mutex_type a, b, c;
+  sync_prim::lock(as_exclusive(a), as_shared(b), as_upgrade(c));
+  assert(available(a) == 0);
+  assert(available(b) == 2);
+  assert(available(c) == 1);
+  a.unlock();
+  b.unlock_shared();
+  c.unlock_upgrade();
+  assert(available(a) == 3 && available(b) == 3 && available(c) == 3);
+}
+
+void test_scoped_lock()
+{
+  mutex_type a, b;
+  std::mutex plain;
+  sync_prim::distributed_upgrade_mutex<> d;
+  {
+    sync_prim::scoped_lock guard(a, as_shared(b), plain, as_upgrade(d));
+    assert(available(a) == 0);
+    assert(available(b) == 2);
+    assert(!plain.try_lock());
+    assert(available(d) == 1);
+  }
+  assert(available(a) == 3 && available(b) == 3 && available(d) == 3);
+  assert(plain.try_lock());
+  plain.unlock();
+
+  a.lock();
+  b.lock_shared();
+  {
+    sync_prim::scoped_lock adopted(std::adopt_lock, a, as_shared(b));
+  }
+  assert(available(a) == 3 && available(b) == 3);
+}
+
+void test_try_lock()
+{
+  mutex_type a, b, c;
+  b.lock_shared();
+  // Shared requests coexist with the reader; the exclusive one does not
+  assert(sync_prim::try_lock(as_shared(a), as_shared(b), as_upgrade(c)) == -1);
+  a.unlock_shared();
+  b.unlock_shared();
+  c.unlock_upgrade();
+
+  assert(sync_prim::try_lock(as_upgrade(a), as_exclusive(b), c) == 1);
+  assert(available(a) == 3 && available(c) == 3); // Nothing left behind
+  b.unlock_shared();
+}
+
+// ===================================================================
+//                        CONTENTION TESTS
+// ===================================================================
+
+void test_waits_while_holding_nothing()
+{
+  mutex_type a, b;
+  std::atomic<bool> holding{false}, release{false}, acquired{false};
+  std::thread holder([&]()
+                     {
+    b.lock();
+    holding = true;
+    while (!release)
+      std::this_thread::yield();
+    b.unlock(); });
+  while (!holding)
+    std::this_thread::yield();
+
+  std::thread locker([&]()
+                     {
+    sync_prim::scoped_lock guard(a, b);
+    acquired = true; });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(!acquired);
+  // The waiting thread backed off a rather than sitting on it
+  assert(available(a) == 3);
+
+  release = true;
+  holder.join();
+  locker.join();
+  assert(acquired);
+}
+
+void test_opposite_orders_do_not_deadlock()
+{
+  mutex_type a, b;
+  sync_prim::distributed_upgrade_mutex<> c;
+  long shared_total = 0;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&, t]()
+                         {
+      for (int i = 0; i < 2000; ++i)
+      {
+        if (t % 2 == 0)
+        {
+          sync_prim::scoped_lock guard(a, as_upgrade(b), as_shared(c));
+          ++shared_total;
+        }
+        else
+        {
+          sync_prim::scoped_lock guard(as_shared(c), as_upgrade(b), a);
+          ++shared_total;
+        }
+      } });
+  }
+  for (auto &t : threads)
+    t.join();
+  assert(shared_total == 8000);
+}
+
+int main()
+{
+  std::cout << "--- Running Multi-lock Core Tests ---" << std::endl;
+  run_test(test_mixed_modes, "lock() takes each mutex in its own mode");
+  run_test(test_scoped_lock, "scoped_lock over mixed mutex types and adopt_lock");
+  run_test(test_try_lock, "try_lock() reports the failing request");
+
+  std::cout << "\n--- Running Multi-lock Contention Tests ---" << std::endl;
+  run_test(test_waits_while_holding_nothing, "Blocked acquisition holds nothing");
+  run_test(test_opposite_orders_do_not_deadlock, "Opposite acquisition orders do not deadlock");
+
+  return 0;
+}
@@ -0,0 +1,242 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sync_prim/lock_registry.hpp"
+#include "sync_prim/distributed_upgrade_mutex.hpp"
+#include "test_utils.hpp"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using sync_prim::lock_registry;
+using sync_prim::log_histogram;
+using profiled = sync_prim::profiled_mutex<>;
+
+// ===================================================================
+//                        HISTOGRAM TESTS
+// ===================================================================
+
+void test_histogram_buckets()
+{
+  for (uint64_t v : {0ull, 1ull, 7ull, 8ull, 9ull, 15ull, 16ull, 1000ull, 123456789ull, ~0ull})
+  {
+    std::size_t b = log_histogram::bucket_of(v);
+    assert(b < log_histogram::BUCKET_COUNT);
+    uint64_t low = log_histogram::lower_bound_of(b);
+    assert(low <= v);
+    // Within one sub-bucket (12.5%) of the true value
+    assert(v - low <= v / log_histogram::SUB_BUCKETS);
+    if (b + 1 < log_histogram::BUCKET_COUNT)
+      assert(log_histogram::lower_bound_of(b + 1) > v);
+  }
+}
+
+void test_histogram_percentiles()
+{
+  log_histogram h;
+  assert(h.percentile(0.5) == 0);
+  for (uint64_t v = 1; v <= 1000; ++v)
+    h.record(v);
+  assert(h.count() == 1000);
+  assert(h.sum() == 500500);
+  assert(h.max() == 1000);
+
+  uint64_t p50 = h.percentile(0.50);
+  uint64_t p99 = h.percentile(0.99);
+  assert(p50 >= 440 && p50 <= 500);
+  assert(p99 >= 870 && p99 <= 990);
+  assert(h.percentile(0.0) == 1);
+  assert(h.percentile(1.0) <= 1000);
+}
+
+// ===================================================================
+//                        REGISTRY TESTS
+// ===================================================================
+
+void test_registration_follows_lifetime()
+{
+  lock_registry registry(1);
+  {
+    profiled a("a", registry);
+    profiled b("b", registry);
+    assert(registry.report().size() == 2);
+    assert(a.profile().name == "a");
+  }
+  assert(registry.report().empty());
+}
+
+void test_sampling_rate()
+{
+  lock_registry registry(4);
+  profiled mtx("sampled", registry);
+  for (int i = 0; i < 400; ++i)
+  {
+    mtx.lock();
+    mtx.unlock();
+  }
+  // Per-thread counters: exactly one in four acquisitions is timed
+  assert(mtx.profile().wait.count() == 100);
+  assert(mtx.profile().hold.count() == 100);
+
+  registry.set_sample_rate(1);
+  for (int i = 0; i < 10; ++i)
+  {
+    mtx.lock_shared();
+    mtx.unlock_shared();
+  }
+  assert(mtx.profile().wait.count() == 110);
+  assert(mtx.profile().hold.count() == 100); // Shared holds are not timed
+}
+
+void test_guards_and_transitions()
+{
+  lock_registry registry(1);
+  profiled mtx("transitions", registry);
+  {
+    sync_prim::upgrade_lock<profiled> u_lock(mtx);
+    assert(mtx.try_lock_shared());
+    mtx.unlock_shared();
+    {
+      sync_prim::scoped_upgrade<profiled> scope(u_lock);
+      assert(!mtx.try_lock_shared());
+    }
+    sync_prim::unique_lock<profiled> x_lock(std::move(u_lock));
+    sync_prim::shared_lock<profiled> s_lock(std::move(x_lock));
+    assert(!mtx.try_lock());
+  }
+  assert(mtx.try_lock());
+  mtx.unlock();
+
+  // lock_upgrade, scoped entry, upgrade_to_unique: three timed waits
+  assert(mtx.profile().wait.count() == 3);
+  // The scoped exclusive section and the upgraded lock
+  assert(mtx.profile().hold.count() == 2);
+
+  sync_prim::profiled_mutex<sync_prim::distributed_upgrade_mutex<>> other("distributed", registry);
+  {
+    sync_prim::upgrade_lock<decltype(other)> u_lock(other);
+    sync_prim::unique_lock<decltype(other)> x_lock(std::move(u_lock));
+    assert(!other.try_lock_shared());
+  }
+  assert(other.try_lock_shared_for(std::chrono::milliseconds(1)));
+  other.unlock_shared();
+}
+
+void test_report_ranks_contended_locks()
+{
+  lock_registry registry(1);
+  profiled quiet("quiet", registry);
+  profiled hot("hot", registry);
+
+  quiet.lock();
+  quiet.unlock();
+
+  hot.lock();
+  std::thread waiter([&]()
+                     { hot.lock(); hot.unlock(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  hot.unlock();
+  waiter.join();
+
+  std::vector<sync_prim::lock_report_entry> rows = registry.report();
+  assert(rows.size() == 2);
+  assert(rows[0].name == "hot");
+  assert(rows[0].samples == 2);
+  assert(rows[0].wait_max_ns >= 10'000'000);
+  assert(rows[0].hold_max_ns >= 10'000'000);
+  assert(registry.report(1).size() == 1);
+
+  std::ostringstream text;
+  registry.write_text_report(text, 1);
+  assert(text.str().find("hot") != std::string::npos);
+  assert(text.str().find("quiet") == std::string::npos);
+}
+
+void test_json_report()
+{
+  lock_registry registry(1);
+  profiled mtx("cache \"main\"\n", registry);
+  mtx.lock();
+  mtx.unlock();
+
+  std::ostringstream json;
+  registry.write_json_report(json);
+  std::string s = json.str();
+  assert(s.find("{\"sample_rate\":1,\"locks\":[{\"name\":\"cache \\\"main\\\"\\u000a\"") == 0);
+  assert(s.find("\"samples\":1") != std::string::npos);
+  assert(s.find("\"hold_ns\":{\"p50\":") != std::string::npos);
+  assert(s.substr(s.size() - 3) == "]}\n");
+}
+
+void test_contended_workload()
+{
+  lock_registry registry(8);
+  profiled mtx("workload", registry);
+  long counter = 0;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&, t]()
+                         {
+      for (int i = 0; i < 2000; ++i)
+      {
+        if ((i + t) % 4 == 0)
+        {
+          sync_prim::upgrade_lock<profiled> u_lock(mtx);
+          sync_prim::unique_lock<profiled> x_lock(std::move(u_lock));
+          ++counter;
+        }
+        else
+        {
+          sync_prim::shared_lock<profiled> s_lock(mtx);
+          (void)counter;
+        }
+      } });
+  }
+  for (auto &t : threads)
+    t.join();
+  assert(counter == 2000);
+  assert(mtx.profile().wait.count() > 0);
+}
+
+int main()
+{
+  std::cout << "--- Running Histogram Tests ---" << std::endl;
+  run_test(test_histogram_buckets, "Log buckets bound values within 12.5%");
+  run_test(test_histogram_percentiles, "Percentiles from log buckets");
+
+  std::cout << "\n--- Running Registry Tests ---" << std::endl;
+  run_test(test_registration_follows_lifetime, "Mutexes register for their lifetime");
+  run_test(test_sampling_rate, "One in N acquisitions is sampled");
+  run_test(test_guards_and_transitions, "Guards and transitions on profiled mutexes");
+  run_test(test_report_ranks_contended_locks, "Report ranks locks by wait time");
+  run_test(test_json_report, "JSON report escapes names");
+  run_test(test_contended_workload, "Contended mixed-mode workload");
+
+  return 0;
+}
@@ -0,0 +1,316 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sync_prim/upgrade_mutex.hpp"
+#include "sync_prim/lock_validator.hpp"
+#include "test_utils.hpp"
+#include <iostream>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using checked_mutex = sync_prim::basic_upgrade_mutex<sync_prim::lock_validation>;
+using kind = sync_prim::lock_violation_kind;
+
+// Collects violations instead of aborting. With `throwing`, the violation is
+// also thrown, before the offending acquisition touches the mutex.
+struct recorder
+{
+  struct violation_error : std::runtime_error
+  {
+    using std::runtime_error::runtime_error;
+  };
+
+  explicit recorder(bool throwing = false)
+  {
+    sync_prim::lock_validator::global().clear_order();
+    sync_prim::lock_validator::global().set_handler([this, throwing](const sync_prim::lock_violation &v)
+                                                    {
+      std::lock_guard<std::mutex> lock(mutex);
+      seen.push_back(v);
+      if (throwing)
+        throw violation_error(v.message); });
+  }
+  ~recorder() { sync_prim::lock_validator::global().set_handler({}); }
+
+  std::size_t count()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return seen.size();
+  }
+
+  std::mutex mutex;
+  std::vector<sync_prim::lock_violation> seen;
+};
+
+// Whether another thread could take `mtx` in upgrade mode right now.
+bool upgrade_available(checked_mutex &mtx)
+{
+  bool free = false;
+  std::thread([&]
+              {
+    free = mtx.try_lock_upgrade();
+    if (free)
+      mtx.unlock_upgrade(); })
+      .join();
+  return free;
+}
+
+// ===================================================================
+//                        ORDER TESTS
+// ===================================================================
+
+void test_disabled_adds_nothing()
+{
+  using plain = sync_prim::basic_upgrade_mutex<sync_prim::futex_backend>;
+  static_assert(sizeof(plain) == sizeof(uint32_t), "validation must not add storage when disabled");
+  static_assert(!plain::lock_validation_policy::enabled);
+  plain mtx;
+  mtx.set_debug_name("ignored");
+  mtx.lock_shared();
+  mtx.unlock_shared();
+}
+
+void test_order_cycle()
+{
+  recorder r;
+  checked_mutex accounts, ledger;
+  accounts.set_debug_name("accounts");
+  ledger.set_debug_name("ledger");
+  {
+    sync_prim::unique_lock<checked_mutex> a(accounts);
+    sync_prim::unique_lock<checked_mutex> b(ledger);
+  }
+  assert(r.count() == 0);
+  {
+    sync_prim::unique_lock<checked_mutex> b(ledger);
+    sync_prim::unique_lock<checked_mutex> a(accounts);
+  }
+  assert(r.count() == 1);
+  const sync_prim::lock_violation &v = r.seen[0];
+  assert(v.kind == kind::order_cycle);
+  assert((v.locks == std::vector<std::string>{"ledger", "accounts", "ledger"}));
+  assert(v.message.find("\"accounts\" while holding \"ledger\"") != std::string::npos);
+}
+
+void test_order_across_modes()
+{
+  // The upgrade of one mutex and a shared lock on another, taken in opposite
+  // orders by two code paths.
+  recorder r;
+  checked_mutex index, cache;
+  std::thread([&]
+              {
+    sync_prim::upgrade_lock<checked_mutex> u(index);
+    sync_prim::shared_lock<checked_mutex> s(cache); })
+      .join();
+  std::thread([&]
+              {
+    sync_prim::shared_lock<checked_mutex> s(cache);
+    sync_prim::upgrade_lock<checked_mutex> u(index); })
+      .join();
+  assert(r.count() == 1 && r.seen[0].kind == kind::order_cycle);
+}
+
+void test_conversion_is_ordered()
+{
+  // Converting `a` waits for a's readers, which may be waiting for `b`.
+  recorder r;
+  checked_mutex a, b;
+  sync_prim::upgrade_lock<checked_mutex> u(a);
+  {
+    sync_prim::unique_lock<checked_mutex> x_b(b);
+    assert(r.count() == 0);
+    sync_prim::scoped_upgrade<checked_mutex> x_a(u);
+  }
+  assert(r.count() == 1 && r.seen[0].kind == kind::order_cycle);
+}
+
+void test_try_lock_adds_no_order()
+{
+  recorder r;
+  checked_mutex a, b;
+  b.lock();
+  assert(a.try_lock_shared());
+  a.unlock_shared();
+  b.unlock();
+  a.lock();
+  b.lock();
+  b.unlock();
+  a.unlock();
+  assert(r.count() == 0);
+}
+
+void test_optimistic_read_adds_no_order()
+{
+  // read_begin() parks behind the writer without acquiring anything, so it
+  // must not order `seq` after the locks its caller holds.
+  using seq_mutex = sync_prim::basic_upgrade_mutex<sync_prim::lock_validation, sync_prim::optimistic_reads, sync_prim::immediate_park>;
+  recorder r;
+  checked_mutex held;
+  seq_mutex seq;
+  std::atomic<bool> writing = false;
+  std::thread writer([&]
+                     {
+    sync_prim::unique_lock<seq_mutex> x(seq);
+    writing = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50)); });
+  while (!writing)
+    std::this_thread::yield();
+  {
+    sync_prim::unique_lock<checked_mutex> h(held);
+    uint32_t token = seq.read_begin(); // Parks until the writer leaves
+    assert(seq.read_validate(token));
+  }
+  writer.join();
+  {
+    sync_prim::unique_lock<seq_mutex> x(seq);
+    sync_prim::unique_lock<checked_mutex> h(held);
+  }
+  assert(r.count() == 0);
+}
+
+// ===================================================================
+//                        TRANSITION TESTS
+// ===================================================================
+
+void test_double_upgrade()
+{
+  recorder r(true);
+  checked_mutex mtx;
+  mtx.set_debug_name("orders");
+  sync_prim::upgrade_lock<checked_mutex> u(mtx);
+  bool thrown = false;
+  try
+  {
+    mtx.lock_upgrade();
+  }
+  catch (const recorder::violation_error &e)
+  {
+    thrown = std::string(e.what()).find("\"orders\"") != std::string::npos;
+  }
+  assert(thrown && r.seen[0].kind == kind::double_upgrade);
+  assert((r.seen[0].locks == std::vector<std::string>{"orders"}));
+}
+
+void test_upgrade_from_shared()
+{
+  recorder r(true);
+  checked_mutex mtx;
+  sync_prim::shared_lock<checked_mutex> s(mtx);
+  for (int attempt = 0; attempt < 2; ++attempt)
+  {
+    bool thrown = false;
+    try
+    {
+      if (attempt == 0)
+        mtx.lock_upgrade();
+      else
+        mtx.lock();
+    }
+    catch (const recorder::violation_error &)
+    {
+      thrown = true;
+    }
+    assert(thrown);
+  }
+  assert(r.count() == 2);
+  assert(r.seen[0].kind == kind::upgrade_from_shared && r.seen[1].kind == kind::upgrade_from_shared);
+  // Reported before acquiring: the mutex was not touched.
+  assert(upgrade_available(mtx));
+}
+
+void test_recursive_shared()
+{
+  recorder r(true);
+  checked_mutex mtx;
+  sync_prim::shared_lock<checked_mutex> s(mtx);
+  bool thrown = false;
+  try
+  {
+    mtx.lock_shared();
+  }
+  catch (const recorder::violation_error &)
+  {
+    thrown = true;
+  }
+  assert(thrown && r.seen[0].kind == kind::recursive_acquire);
+}
+
+void test_release_by_other_thread()
+{
+  recorder r;
+  checked_mutex mtx;
+  std::thread([&]
+              { mtx.lock_shared(); })
+      .join();
+  mtx.unlock_shared();
+  assert(r.count() == 1 && r.seen[0].kind == kind::unheld_release);
+  assert(upgrade_available(mtx));
+}
+
+void test_clean_transitions()
+{
+  recorder r;
+  checked_mutex a, b;
+  for (int round = 0; round < 3; ++round)
+  {
+    sync_prim::upgrade_lock<checked_mutex> u(a);
+    {
+      sync_prim::scoped_upgrade<checked_mutex> x(u);
+    }
+    sync_prim::unique_lock<checked_mutex> x(std::move(u));
+    sync_prim::shared_lock<checked_mutex> s(std::move(x));
+    sync_prim::upgrade_lock<checked_mutex> u_b(b);
+    sync_prim::unique_lock<checked_mutex> x_b(std::move(u_b), std::chrono::milliseconds(10));
+    assert(x_b.owns_lock());
+    sync_prim::upgrade_lock<checked_mutex> back(std::move(x_b));
+  }
+  assert(r.count() == 0);
+}
+
+int main()
+{
+  std::cout << "--- Running Lock Order Tests ---" << std::endl;
+  run_test(test_disabled_adds_nothing, "Disabled validation adds no storage or checks");
+  run_test(test_order_cycle, "Opposite acquisition orders are reported with names");
+  run_test(test_order_across_modes, "Upgrade/shared order inversion across threads is reported");
+  run_test(test_conversion_is_ordered, "Upgrade conversions are ordered after held locks");
+  run_test(test_try_lock_adds_no_order, "try_lock does not record an order");
+  run_test(test_optimistic_read_adds_no_order, "read_begin() waiting for a writer records no order");
+
+  std::cout << "\n--- Running Lock Transition Tests ---" << std::endl;
+  run_test(test_double_upgrade, "Double upgrade is reported before acquiring");
+  run_test(test_upgrade_from_shared, "Upgrading from a held shared lock is reported");
+  run_test(test_recursive_shared, "Recursive shared acquisition is reported");
+  run_test(test_release_by_other_thread, "Releasing a lock held by another thread is reported");
+  run_test(test_clean_transitions, "Guard transitions are tracked without violations");
+
+  return 0;
+}
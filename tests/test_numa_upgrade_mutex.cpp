@@ -0,0 +1,183 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sync_prim/numa_upgrade_mutex.hpp"
+#include "test_utils.hpp"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using numa_mutex = sync_prim::numa_upgrade_mutex<>;
+
+// ===================================================================
+//                        CORE TESTS
+// ===================================================================
+
+void test_node_hint_is_stable()
+{
+  std::size_t node = sync_prim::detail::numa_node_hint();
+  std::thread([]()
+              { (void)sync_prim::detail::numa_node_hint(); })
+      .join();
+  assert(sync_prim::detail::numa_node_hint() == node);
+  assert(sync_prim::numa_node_slots::slot_hint() == node);
+}
+
+void test_basic_modes()
+{
+  numa_mutex mtx;
+  {
+    sync_prim::unique_lock<numa_mutex> x_lock(mtx);
+    assert(!mtx.try_lock());
+    assert(!mtx.try_lock_shared());
+    assert(!mtx.try_lock_upgrade());
+  }
+  {
+    sync_prim::shared_lock<numa_mutex> s_lock(mtx);
+    assert(mtx.try_lock_shared());
+    assert(mtx.try_lock_upgrade());
+    assert(!mtx.try_lock());
+    mtx.unlock_upgrade();
+    mtx.unlock_shared();
+  }
+  assert(mtx.try_lock());
+  mtx.unlock();
+}
+
+void test_transitions()
+{
+  numa_mutex mtx;
+  sync_prim::upgrade_lock<numa_mutex> u_lock(mtx);
+  {
+    sync_prim::scoped_upgrade<numa_mutex> s_upgrade(u_lock);
+    assert(!mtx.try_lock_shared());
+  }
+  assert(mtx.try_lock_shared());
+  {
+    // try_to_lock fails while a reader is present, and keeps the upgrade lock
+    sync_prim::unique_lock<numa_mutex> x_lock(std::move(u_lock), std::try_to_lock);
+    assert(!x_lock.owns_lock() && u_lock.owns_lock());
+  }
+  mtx.unlock_shared();
+
+  // unique (via upgrade) -> shared, then a cohort writer -> upgrade -> shared
+  sync_prim::unique_lock<numa_mutex> x_lock(std::move(u_lock));
+  sync_prim::shared_lock<numa_mutex> s_lock(std::move(x_lock));
+  assert(!mtx.try_lock());
+  s_lock.unlock();
+
+  sync_prim::unique_lock<numa_mutex> x_lock2(mtx);
+  sync_prim::upgrade_lock<numa_mutex> u_lock2(std::move(x_lock2));
+  assert(mtx.try_lock_shared());
+  mtx.unlock_shared();
+  u_lock2.unlock();
+  assert(mtx.try_lock());
+  mtx.unlock();
+}
+
+void test_contended_workload()
+{
+  numa_mutex mtx;
+  contended_counter_workload(mtx);
+  numa_mutex no_batching(1);
+  contended_counter_workload(no_batching);
+  sync_prim::numa_upgrade_mutex<2, sync_prim::futex_backend> futex_mtx;
+  contended_counter_workload(futex_mtx);
+}
+
+// ===================================================================
+//                        COHORT TESTS
+// ===================================================================
+
+void test_cohort_keeps_global_lock()
+{
+  // A writer waiting on the same node receives the lock directly: between
+  // the two writers the arbiter is never released, so a reader cannot slip in.
+  numa_mutex mtx;
+  std::atomic<bool> release = false;
+
+  mtx.lock();
+  std::thread writer([&]()
+                     {
+        sync_prim::unique_lock<numa_mutex> x_lock(mtx);
+        while (!release)
+            std::this_thread::yield(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  mtx.unlock();
+  assert(!mtx.try_lock_shared());
+  release = true;
+  writer.join();
+  assert(mtx.try_lock_shared());
+  mtx.unlock_shared();
+}
+
+void test_batch_limit_releases_global_lock()
+{
+  // With a batch limit of 1 every unlock frees the arbiter
+  numa_mutex mtx(1);
+  mtx.lock();
+  std::thread writer([&]()
+                     { sync_prim::unique_lock<numa_mutex> x_lock(mtx); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  mtx.unlock();
+  writer.join();
+  assert(mtx.try_lock_shared());
+  mtx.unlock_shared();
+}
+
+void test_timed_lock()
+{
+  numa_mutex mtx;
+  mtx.lock_shared();
+  std::thread writer([&]()
+                     { assert(!mtx.try_lock_for(std::chrono::milliseconds(20))); });
+  writer.join();
+  mtx.unlock_shared();
+
+  // A timed-out writer leaves neither its local lock nor the arbiter behind
+  assert(mtx.try_lock());
+  mtx.unlock();
+  assert(mtx.try_lock_shared_for(std::chrono::milliseconds(1)));
+  mtx.unlock_shared();
+}
+
+int main()
+{
+  std::cout << "--- Running NUMA Core Tests ---" << std::endl;
+  run_test(test_node_hint_is_stable, "Per-thread node hint is stable");
+  run_test(test_basic_modes, "Shared/upgrade/exclusive compatibility");
+  run_test(test_transitions, "Upgrades and downgrades through the arbiter");
+  run_test(test_contended_workload, "Contended mixed-mode workload");
+
+  std::cout << "\n--- Running Cohort Tests ---" << std::endl;
+  run_test(test_cohort_keeps_global_lock, "Same-node writer receives the global lock");
+  run_test(test_batch_limit_releases_global_lock, "Batch limit releases the global lock");
+  run_test(test_timed_lock, "Timed writers release everything on timeout");
+
+  return 0;
+}
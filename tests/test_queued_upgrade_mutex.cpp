@@ -0,0 +1,360 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sync_prim/queued_upgrade_mutex.hpp"
+#include "test_utils.hpp"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using queued_mutex = sync_prim::queued_upgrade_mutex<>;
+
+// Starts `body` on a new thread and gives it time to reach the wait queue.
+template <typename Body>
+std::thread start_waiter(Body body)
+{
+  std::thread t(body);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  return t;
+}
+
+// ===================================================================
+//                        CORE TESTS
+// ===================================================================
+
+void test_basic_modes()
+{
+  queued_mutex mtx;
+  {
+    sync_prim::unique_lock<queued_mutex> x_lock(mtx);
+    assert(!mtx.try_lock_shared());
+    assert(!mtx.try_lock_upgrade());
+  }
+  {
+    sync_prim::shared_lock<queued_mutex> s_lock(mtx);
+    assert(mtx.try_lock_shared());
+    assert(mtx.try_lock_upgrade());
+    assert(!mtx.try_lock());
+    mtx.unlock_upgrade();
+    mtx.unlock_shared();
+  }
+  {
+    sync_prim::upgrade_lock<queued_mutex> u_lock(mtx);
+    {
+      sync_prim::scoped_upgrade<queued_mutex> s_upgrade(u_lock);
+      assert(!mtx.try_lock_shared());
+    }
+    assert(mtx.try_lock_shared());
+    mtx.unlock_shared();
+  }
+  assert(mtx.try_lock());
+  mtx.unlock();
+}
+
+void test_contended_workload()
+{
+  contended_counter_workload<queued_mutex>();
+  contended_counter_workload<sync_prim::queued_upgrade_mutex<sync_prim::pure_spin>>();
+  contended_counter_workload<sync_prim::queued_upgrade_mutex<sync_prim::immediate_park>>();
+}
+
+// ===================================================================
+//                        QUEUE ORDER TESTS
+// ===================================================================
+
+void test_fifo_order()
+{
+  // Writers and readers queued behind a writer are served in arrival order,
+  // and a late reader cannot barge past the queued writer.
+  queued_mutex mtx;
+  std::atomic<int> next = 0;
+  int first_writer = -1, reader = -1, second_writer = -1;
+
+  mtx.lock();
+  std::thread w1 = start_waiter([&]()
+                                {
+        sync_prim::unique_lock<queued_mutex> x_lock(mtx);
+        first_writer = next++; });
+  std::thread r = start_waiter([&]()
+                               {
+        sync_prim::shared_lock<queued_mutex> s_lock(mtx);
+        reader = next++; });
+  std::thread w2 = start_waiter([&]()
+                                {
+        sync_prim::unique_lock<queued_mutex> x_lock(mtx);
+        second_writer = next++; });
+  assert(!mtx.try_lock_shared());
+
+  mtx.unlock();
+  w1.join();
+  r.join();
+  w2.join();
+  assert(first_writer == 0 && reader == 1 && second_writer == 2);
+}
+
+void test_reader_batch_handoff()
+{
+  // Consecutive queued readers are granted together: they all hold the lock
+  // at once, and the writer queued behind them waits for the whole batch.
+  queued_mutex mtx;
+  std::atomic<int> inside = 0, peak = 0;
+  std::atomic<bool> release = false, writer_done = false;
+  std::vector<std::thread> readers;
+
+  mtx.lock();
+  for (int i = 0; i < 3; ++i)
+    readers.push_back(start_waiter([&]()
+                                   {
+        sync_prim::shared_lock<queued_mutex> s_lock(mtx);
+        int now = ++inside;
+        int seen = peak.load();
+        while (now > seen && !peak.compare_exchange_weak(seen, now)) {}
+        while (!release)
+            std::this_thread::yield();
+        --inside; }));
+  std::thread writer = start_waiter([&]()
+                                    {
+        sync_prim::unique_lock<queued_mutex> x_lock(mtx);
+        assert(inside == 0);
+        writer_done = true; });
+
+  mtx.unlock();
+  while (peak < 3)
+    std::this_thread::yield();
+  assert(!writer_done);
+  release = true;
+  for (auto &t : readers)
+    t.join();
+  writer.join();
+  assert(writer_done);
+}
+
+void test_upgrader_priority()
+{
+  // A pending upgrade blocks new readers and is served before queued writers
+  // once the existing readers drain.
+  queued_mutex mtx;
+  std::atomic<int> next = 0;
+  int upgrader = -1, writer = -1;
+
+  mtx.lock_shared();
+  std::thread u = start_waiter([&]()
+                               {
+        sync_prim::upgrade_lock<queued_mutex> u_lock(mtx);
+        sync_prim::scoped_upgrade<queued_mutex> s_upgrade(u_lock);
+        upgrader = next++; });
+  std::thread w = start_waiter([&]()
+                               {
+        sync_prim::unique_lock<queued_mutex> x_lock(mtx);
+        writer = next++; });
+  assert(!mtx.try_lock_shared());
+
+  mtx.unlock_shared();
+  u.join();
+  w.join();
+  assert(upgrader == 0 && writer == 1);
+}
+
+void test_shared_transitions()
+{
+  queued_mutex mtx;
+  sync_prim::shared_lock<queued_mutex> s_lock(mtx);
+  mtx.lock_shared();
+  sync_prim::unique_lock<queued_mutex> x_fail(std::move(s_lock), std::try_to_lock);
+  assert(!x_fail.owns_lock() && s_lock.owns_lock());
+  mtx.unlock_shared();
+
+  sync_prim::upgrade_lock<queued_mutex> u_lock(std::move(s_lock), std::try_to_lock);
+  assert(u_lock.owns_lock());
+  assert(mtx.try_lock_shared());
+  mtx.unlock_shared();
+  assert(!mtx.try_lock_upgrade());
+  u_lock.unlock();
+
+  s_lock = sync_prim::shared_lock<queued_mutex>(mtx);
+  sync_prim::unique_lock<queued_mutex> x_lock(std::move(s_lock), std::try_to_lock);
+  assert(x_lock.owns_lock());
+  assert(!mtx.try_lock_shared());
+  x_lock.unlock();
+
+  // A queued writer keeps its place: neither escalation overtakes it
+  s_lock = sync_prim::shared_lock<queued_mutex>(mtx);
+  std::thread w = start_waiter([&]()
+                               { sync_prim::unique_lock<queued_mutex> x(mtx); });
+  sync_prim::upgrade_lock<queued_mutex> u_fail(std::move(s_lock), std::try_to_lock);
+  assert(!u_fail.owns_lock() && s_lock.owns_lock());
+  sync_prim::unique_lock<queued_mutex> x_queued(std::move(s_lock), std::try_to_lock);
+  assert(!x_queued.owns_lock() && s_lock.owns_lock());
+  s_lock.unlock();
+  w.join();
+}
+
+// ===================================================================
+//                        PRIORITY TESTS
+// ===================================================================
+
+void test_high_priority_goes_first()
+{
+  // A high-priority writer queued after a normal one is served first, and a
+  // high-priority reader batch goes before a normal reader.
+  queued_mutex mtx;
+  std::atomic<int> next = 0;
+  int normal_writer = -1, normal_reader = -1, high_writer = -1, high_reader = -1;
+
+  mtx.lock();
+  std::thread nw = start_waiter([&]()
+                                {
+        mtx.lock();
+        normal_writer = next++;
+        mtx.unlock(); });
+  std::thread nr = start_waiter([&]()
+                                {
+        mtx.lock_shared();
+        normal_reader = next++;
+        mtx.unlock_shared(); });
+  std::thread hw = start_waiter([&]()
+                                {
+        mtx.lock(sync_prim::lock_priority::high);
+        high_writer = next++;
+        mtx.unlock(); });
+  std::thread hr = start_waiter([&]()
+                                {
+        assert(mtx.try_lock_shared_for(std::chrono::seconds(5), sync_prim::lock_priority::high));
+        high_reader = next++;
+        mtx.unlock_shared(); });
+
+  mtx.unlock();
+  nw.join();
+  nr.join();
+  hw.join();
+  hr.join();
+  assert(high_writer == 0 && high_reader == 1 && normal_writer == 2 && normal_reader == 3);
+}
+
+void test_aging_serves_normal_lane()
+{
+  // With high-priority writers always queued, the normal writer is served
+  // after SYNC_PRIM_PRIORITY_AGING_LIMIT of them.
+  using stats_mutex = sync_prim::queued_upgrade_mutex<sync_prim::instrumented>;
+  stats_mutex mtx;
+  constexpr int high_count = SYNC_PRIM_PRIORITY_AGING_LIMIT + 2;
+  std::atomic<int> next = 0;
+  int normal_turn = -1;
+  std::vector<std::thread> threads;
+
+  mtx.lock();
+  threads.push_back(start_waiter([&]()
+                                 {
+        mtx.lock();
+        normal_turn = next++;
+        mtx.unlock(); }));
+  for (int i = 0; i < high_count; ++i)
+  {
+    threads.push_back(std::thread([&]()
+                                  {
+        mtx.lock(sync_prim::lock_priority::high);
+        ++next;
+        mtx.unlock(); }));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  mtx.unlock();
+  for (auto &t : threads)
+    t.join();
+  assert(normal_turn == SYNC_PRIM_PRIORITY_AGING_LIMIT);
+
+  sync_prim::queue_wait_stats stats = mtx.queue_stats();
+  assert(stats.normal.waits == 1 && stats.high.waits == high_count);
+  assert(stats.aged_grants == 1);
+  assert(stats.high.max_wait_ns >= stats.high.average_ns() && stats.high.average_ns() > 0);
+  assert(stats.normal.wait_ns >= stats.high.average_ns());
+
+  // Uncontended acquisitions never queue
+  mtx.reset_queue_stats();
+  mtx.lock(sync_prim::lock_priority::high);
+  mtx.unlock();
+  stats = mtx.queue_stats();
+  assert(stats.high.waits == 0 && stats.normal.waits == 0 && stats.aged_grants == 0);
+}
+
+// ===================================================================
+//                        TIMED TESTS
+// ===================================================================
+
+void test_timed_waiter_leaves_queue()
+{
+  // A timed-out writer unlinks itself, and the reader queued behind it is
+  // then granted alongside the current reader.
+  queued_mutex mtx;
+  std::atomic<bool> reader_in = false;
+
+  mtx.lock_shared();
+  mtx.lock_upgrade();
+  std::thread writer = start_waiter([&]()
+                                    { assert(!mtx.try_lock_for(std::chrono::milliseconds(300))); });
+  std::thread reader = start_waiter([&]()
+                                    {
+        assert(mtx.try_lock_shared_for(std::chrono::seconds(5)));
+        reader_in = true;
+        mtx.unlock_shared(); });
+  assert(!reader_in);
+  writer.join();
+  reader.join();
+  assert(reader_in);
+
+  // A timed upgrade gives up and lets readers in again
+  {
+    sync_prim::upgrade_lock<queued_mutex> u_lock(mtx, std::adopt_lock);
+    sync_prim::unique_lock<queued_mutex> x_lock(std::move(u_lock), std::chrono::milliseconds(20));
+    assert(!x_lock.owns_lock());
+    assert(mtx.try_lock_shared());
+    mtx.unlock_shared();
+  }
+  mtx.unlock_shared();
+  assert(mtx.try_lock());
+  mtx.unlock();
+}
+
+int main()
+{
+  std::cout << "--- Running Queued Core Tests ---" << std::endl;
+  run_test(test_basic_modes, "Shared/upgrade/exclusive compatibility");
+  run_test(test_contended_workload, "Contended workload under each wait policy");
+
+  std::cout << "\n--- Running Queue Order Tests ---" << std::endl;
+  run_test(test_fifo_order, "Waiters are served in arrival order");
+  run_test(test_reader_batch_handoff, "Queued readers are granted as one batch");
+  run_test(test_upgrader_priority, "Pending upgrader goes before queued writers");
+  run_test(test_shared_transitions, "Try transitions from shared respect the queue");
+
+  std::cout << "\n--- Running Priority Tests ---" << std::endl;
+  run_test(test_high_priority_goes_first, "High-priority waiters are served first");
+  run_test(test_aging_serves_normal_lane, "Aging bounds normal-lane starvation; per-lane wait stats");
+
+  std::cout << "\n--- Running Queued Timed Tests ---" << std::endl;
+  run_test(test_timed_waiter_leaves_queue, "Timed-out waiters leave the queue");
+
+  return 0;
+}
@@ -0,0 +1,257 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sync_prim/rcu_cell.hpp"
+#include "sync_prim/distributed_upgrade_mutex.hpp"
+#include "test_utils.hpp"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Counts live instances, to observe reclamation.
+struct tracked
+{
+  static std::atomic<int> live;
+
+  long a = 0;
+  long b = 0;
+
+  tracked() { ++live; }
+  tracked(long x, long y) : a(x), b(y) { ++live; }
+  tracked(const tracked &other) : a(other.a), b(other.b) { ++live; }
+  ~tracked() { --live; }
+};
+
+std::atomic<int> tracked::live{0};
+
+// ===================================================================
+//                        CORE TESTS
+// ===================================================================
+
+void test_read_update_store()
+{
+  sync_prim::rcu_cell<std::map<std::string, int>> routes(std::map<std::string, int>{{"a", 1}});
+  assert(routes.read()->at("a") == 1);
+
+  routes.update([](std::map<std::string, int> &m)
+                { m["b"] = 2; });
+  {
+    auto snap = routes.read();
+    assert(snap->size() == 2 && snap->at("b") == 2);
+  }
+
+  routes.store({{"c", 3}});
+  auto snap = routes.read();
+  assert(snap && snap->size() == 1 && snap->count("c") == 1);
+  snap.reset();
+  assert(!snap);
+}
+
+void test_snapshot_outlives_updates()
+{
+  sync_prim::rcu_cell<tracked> cell(tracked(1, 1), 100);
+  auto old = cell.read();
+  for (long i = 2; i <= 5; ++i)
+    cell.store(tracked(i, i));
+  assert(old->a == 1); // Unchanged and still alive
+  assert(cell.read()->a == 5);
+  assert(cell.retired() == 4);
+}
+
+void test_batched_reclamation()
+{
+  {
+    sync_prim::rcu_cell<tracked> cell(tracked(0, 0), 4);
+    assert(tracked::live == 1);
+    for (long i = 1; i <= 3; ++i)
+      cell.update([&](tracked &t)
+                  { t.a = i; });
+    assert(cell.retired() == 3);
+    assert(tracked::live == 4); // Nothing freed before the batch fills
+
+    cell.update([](tracked &t)
+                { t.a = 4; });
+    assert(cell.retired() == 0);
+    assert(tracked::live == 1);
+
+    cell.store(tracked(5, 5));
+    cell.reclaim();
+    assert(cell.retired() == 0);
+    assert(tracked::live == 1);
+  }
+  assert(tracked::live == 0);
+}
+
+void test_failed_update_publishes_nothing()
+{
+  sync_prim::rcu_cell<int> cell(7);
+  bool threw = false;
+  try
+  {
+    cell.update([](int &v)
+                { v = 8; throw std::runtime_error("no"); });
+  }
+  catch (const std::runtime_error &)
+  {
+    threw = true;
+  }
+  assert(threw);
+  assert(*cell.read() == 7);
+  assert(cell.retired() == 0);
+  assert(cell.mutex().try_lock()); // The upgrade lock was released
+  cell.mutex().unlock();
+}
+
+void test_reclaim_waits_for_readers()
+{
+  sync_prim::rcu_cell<tracked> cell(tracked(1, 1), 100);
+  std::atomic<bool> reading{false}, release{false}, reclaimed{false};
+  std::thread reader([&]()
+                     {
+    auto snap = cell.read();
+    reading = true;
+    while (!release)
+      std::this_thread::yield();
+    assert(snap->a == 1); // Not freed underneath us
+    });
+  while (!reading)
+    std::this_thread::yield();
+
+  cell.store(tracked(2, 2));
+  std::thread writer([&]()
+                     { cell.reclaim(); reclaimed = true; });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(!reclaimed);
+  assert(tracked::live == 2);
+
+  // Reads begun after the publish do not hold reclamation up
+  assert(cell.read()->a == 2);
+
+  release = true;
+  reader.join();
+  writer.join();
+  assert(reclaimed);
+  assert(tracked::live == 1);
+}
+
+void test_writer_holding_snapshot_defers_reclamation()
+{
+  {
+    sync_prim::rcu_cell<tracked> cell(tracked(0, 0), 1);
+    auto snap = cell.read();
+    // With a batch of one, each update would wait for our own snapshot
+    cell.update([](tracked &t)
+                { t.a = 1; });
+    cell.store(tracked(2, 2));
+    assert(cell.retired() == 2);
+    assert(!cell.reclaim());
+    assert(snap->a == 0);
+
+    snap.reset();
+    cell.store(tracked(3, 3)); // The next writer frees the whole batch
+    assert(cell.retired() == 0);
+    assert(tracked::live == 1);
+
+    auto again = cell.read();
+    cell.store(tracked(4, 4));
+    again.reset();
+    assert(cell.reclaim());
+    assert(tracked::live == 1);
+  }
+  assert(tracked::live == 0);
+}
+
+// ===================================================================
+//                        CONCURRENCY TESTS
+// ===================================================================
+
+// Writers keep a + b == 0; readers must never see a torn or freed version.
+template <typename Mutex>
+void concurrent_readers_and_writers()
+{
+  sync_prim::rcu_cell<tracked, Mutex, 4> cell(tracked(0, 0), 3);
+  std::atomic<bool> done{false};
+  std::atomic<long> reads{0};
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 3; ++r)
+  {
+    readers.emplace_back([&]()
+                         {
+      long last = 0;
+      while (!done)
+      {
+        auto snap = cell.read();
+        assert(snap->a + snap->b == 0);
+        assert(snap->a >= last); // Versions only move forward
+        last = snap->a;
+        ++reads;
+      } });
+  }
+  std::vector<std::thread> writers;
+  for (int w = 0; w < 2; ++w)
+  {
+    writers.emplace_back([&]()
+                         {
+      for (int i = 0; i < 500; ++i)
+        cell.update([](tracked &t)
+                    { ++t.a; --t.b; }); });
+  }
+  for (auto &t : writers)
+    t.join();
+  done = true;
+  for (auto &t : readers)
+    t.join();
+
+  assert(cell.read()->a == 1000);
+  assert(reads > 0);
+}
+
+void test_concurrent_readers_and_writers()
+{
+  concurrent_readers_and_writers<sync_prim::upgrade_mutex>();
+  concurrent_readers_and_writers<sync_prim::distributed_upgrade_mutex<>>();
+  assert(tracked::live == 0);
+}
+
+int main()
+{
+  std::cout << "--- Running RCU Cell Core Tests ---" << std::endl;
+  run_test(test_read_update_store, "Read, update and store");
+  run_test(test_snapshot_outlives_updates, "Snapshots outlive later updates");
+  run_test(test_batched_reclamation, "Retired versions are freed in batches");
+  run_test(test_failed_update_publishes_nothing, "A throwing update publishes nothing");
+  run_test(test_reclaim_waits_for_readers, "Reclamation waits for earlier readers only");
+  run_test(test_writer_holding_snapshot_defers_reclamation, "A writer holding a snapshot defers reclamation");
+
+  std::cout << "\n--- Running RCU Cell Concurrency Tests ---" << std::endl;
+  run_test(test_concurrent_readers_and_writers, "Concurrent readers and writers");
+
+  return 0;
+}
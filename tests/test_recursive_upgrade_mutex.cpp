@@ -0,0 +1,358 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sync_prim/recursive_upgrade_mutex.hpp"
+#include "sync_prim/distributed_upgrade_mutex.hpp"
+#include "test_utils.hpp"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using recursive_mutex = sync_prim::recursive_upgrade_mutex<>;
+
+// Whether another thread could take each mode right now.
+template <typename Mutex>
+bool other_can_lock(Mutex &mtx)
+{
+  bool ok = false;
+  std::thread([&]()
+              { ok = mtx.try_lock(); if (ok) mtx.unlock(); })
+      .join();
+  return ok;
+}
+
+template <typename Mutex>
+bool other_can_lock_shared(Mutex &mtx)
+{
+  bool ok = false;
+  std::thread([&]()
+              { ok = mtx.try_lock_shared(); if (ok) mtx.unlock_shared(); })
+      .join();
+  return ok;
+}
+
+template <typename Mutex>
+bool other_can_lock_upgrade(Mutex &mtx)
+{
+  bool ok = false;
+  std::thread([&]()
+              { ok = mtx.try_lock_upgrade(); if (ok) mtx.unlock_upgrade(); })
+      .join();
+  return ok;
+}
+
+// ===================================================================
+//                        REENTRANCY TESTS
+// ===================================================================
+
+void test_nested_same_mode()
+{
+  recursive_mutex mtx;
+  mtx.lock();
+  mtx.lock();
+  assert(mtx.try_lock());
+  assert(mtx.exclusive_count() == 3);
+  mtx.unlock();
+  mtx.unlock();
+  assert(!other_can_lock_shared(mtx));
+  mtx.unlock();
+  assert(mtx.exclusive_count() == 0);
+  assert(other_can_lock(mtx));
+
+  {
+    sync_prim::upgrade_lock<recursive_mutex> outer(mtx);
+    sync_prim::upgrade_lock<recursive_mutex> inner(mtx);
+    assert(mtx.upgrade_count() == 2);
+    assert(other_can_lock_shared(mtx));
+    assert(!other_can_lock_upgrade(mtx));
+  }
+  assert(other_can_lock_upgrade(mtx));
+}
+
+void test_nested_shared_ignores_pending_upgrade()
+{
+  recursive_mutex mtx;
+  std::atomic<bool> upgraded{false};
+
+  mtx.lock_shared();
+  std::thread upgrader([&]()
+                       {
+    sync_prim::upgrade_lock<recursive_mutex> u_lock(mtx);
+    sync_prim::unique_lock<recursive_mutex> x_lock(std::move(u_lock));
+    upgraded = true; });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(!upgraded); // The upgrade is pending on our shared lock
+
+  // A plain mutex would deadlock here
+  mtx.lock_shared();
+  assert(mtx.shared_count() == 2);
+  mtx.unlock_shared();
+  assert(!upgraded);
+  mtx.unlock_shared();
+  upgrader.join();
+  assert(upgraded);
+}
+
+void test_upgrade_with_extra_shared_references()
+{
+  recursive_mutex mtx;
+  sync_prim::upgrade_lock<recursive_mutex> u_lock(mtx);
+  sync_prim::shared_lock<recursive_mutex> s_lock(mtx); // Counted only
+  {
+    sync_prim::scoped_upgrade<recursive_mutex> x_scope(u_lock);
+    assert(!other_can_lock_shared(mtx));
+  }
+  sync_prim::unique_lock<recursive_mutex> x_lock(std::move(u_lock));
+  assert(!other_can_lock_shared(mtx));
+
+  // Dropping the exclusive reference leaves the shared one
+  x_lock.unlock();
+  assert(mtx.shared_count() == 1);
+  assert(other_can_lock_shared(mtx));
+  assert(other_can_lock_upgrade(mtx));
+  assert(!other_can_lock(mtx));
+  s_lock.unlock();
+  assert(other_can_lock(mtx));
+}
+
+void test_step_up_from_shared()
+{
+  recursive_mutex mtx;
+  mtx.lock_shared();
+  mtx.lock_upgrade(); // Trades the real shared lock for the upgrade lock
+  assert(!other_can_lock_upgrade(mtx));
+  mtx.lock();
+  assert(!other_can_lock_shared(mtx));
+
+  mtx.unlock_upgrade();
+  assert(!other_can_lock_shared(mtx));
+  mtx.unlock(); // Back down to shared
+  assert(other_can_lock_shared(mtx));
+  assert(other_can_lock_upgrade(mtx));
+  assert(!other_can_lock(mtx));
+  mtx.unlock_shared();
+  assert(other_can_lock(mtx));
+}
+
+void test_failed_step_up_keeps_shared()
+{
+  recursive_mutex mtx;
+  std::atomic<bool> reader_holds{false}, release{false};
+  std::thread reader([&]()
+                     {
+    mtx.lock_shared();
+    reader_holds = true;
+    while (!release)
+      std::this_thread::yield();
+    mtx.unlock_shared(); });
+  while (!reader_holds)
+    std::this_thread::yield();
+
+  mtx.lock_shared();
+  assert(!mtx.try_lock()); // The other reader blocks the conversion
+  assert(!mtx.try_lock_for(std::chrono::milliseconds(10)));
+  assert(mtx.exclusive_count() == 0 && mtx.shared_count() == 1);
+  release = true;
+  reader.join();
+
+  // Still a reader: writers stay out, other readers get in
+  assert(!other_can_lock(mtx));
+  assert(other_can_lock_shared(mtx));
+  assert(mtx.try_lock());
+  mtx.unlock();
+  mtx.unlock_shared();
+  assert(other_can_lock(mtx));
+}
+
+void test_step_up_past_converting_upgrader()
+{
+  // Another thread holds the upgrade lock and waits for our reader to leave.
+  // Stepping up from shared cannot wait without giving up the shared lock,
+  // so the blocking form throws and the timed one fails, both still shared.
+  recursive_mutex mtx;
+  std::atomic<bool> upgrader_holds{false}, converted{false};
+  mtx.lock_shared();
+  std::thread upgrader([&]()
+                       {
+    sync_prim::upgrade_lock<recursive_mutex> u_lock(mtx);
+    upgrader_holds = true;
+    sync_prim::scoped_upgrade<recursive_mutex> write(u_lock);
+    converted = true; });
+  while (!upgrader_holds)
+    std::this_thread::yield();
+
+  assert(!mtx.try_upgrade_from_shared()); // The upgrade lock is taken
+  assert(mtx.shared_count() == 1 && mtx.upgrade_count() == 0);
+  bool threw = false;
+  try
+  {
+    mtx.lock_upgrade();
+  }
+  catch (const std::system_error &e)
+  {
+    threw = e.code() == std::errc::resource_deadlock_would_occur;
+  }
+  assert(threw);
+  threw = false;
+  try
+  {
+    mtx.lock();
+  }
+  catch (const std::system_error &e)
+  {
+    threw = e.code() == std::errc::resource_deadlock_would_occur;
+  }
+  assert(threw);
+  assert(!mtx.try_lock_upgrade_for(std::chrono::milliseconds(10)));
+  assert(!mtx.try_lock_for(std::chrono::milliseconds(10)));
+  assert(mtx.shared_count() == 1 && mtx.upgrade_count() == 0 && mtx.exclusive_count() == 0);
+  assert(!converted); // Our real shared lock was never dropped
+
+  mtx.unlock_shared();
+  upgrader.join();
+  assert(converted);
+  assert(other_can_lock(mtx));
+}
+
+void test_conditional_transitions_from_shared()
+{
+  recursive_mutex mtx;
+  sync_prim::shared_lock<recursive_mutex> s_lock(mtx);
+  sync_prim::upgrade_lock<recursive_mutex> u_lock(std::move(s_lock), std::try_to_lock);
+  assert(u_lock.owns_lock());
+  assert(mtx.shared_count() == 0 && mtx.upgrade_count() == 1);
+  assert(other_can_lock_shared(mtx));
+  assert(!other_can_lock_upgrade(mtx));
+  u_lock.unlock();
+
+  s_lock = sync_prim::shared_lock<recursive_mutex>(mtx);
+  sync_prim::unique_lock<recursive_mutex> x_lock(std::move(s_lock), std::try_to_lock);
+  assert(x_lock.owns_lock());
+  assert(mtx.shared_count() == 0 && mtx.exclusive_count() == 1);
+  assert(!other_can_lock_shared(mtx));
+  x_lock.unlock();
+  assert(other_can_lock(mtx));
+}
+
+void test_holdings_are_per_mutex_and_bounded()
+{
+  recursive_mutex a, b;
+  a.lock();
+  assert(b.try_lock_shared());
+  assert(a.exclusive_count() == 1 && b.exclusive_count() == 0 && b.shared_count() == 1);
+  assert(other_can_lock_shared(a) == false);
+  assert(other_can_lock_shared(b));
+  b.unlock_shared();
+  a.unlock();
+
+  std::vector<std::unique_ptr<recursive_mutex>> many;
+  for (int i = 0; i < SYNC_PRIM_MAX_RECURSIVE_HOLDINGS + 1; ++i)
+    many.push_back(std::make_unique<recursive_mutex>());
+  for (int i = 0; i < SYNC_PRIM_MAX_RECURSIVE_HOLDINGS; ++i)
+    many[i]->lock_shared();
+  bool threw = false;
+  try
+  {
+    many.back()->lock_shared();
+  }
+  catch (const std::system_error &)
+  {
+    threw = true;
+  }
+  assert(threw);
+  for (int i = 0; i < SYNC_PRIM_MAX_RECURSIVE_HOLDINGS; ++i)
+    many[i]->unlock_shared();
+  many.back()->lock_shared(); // Entries are reused once released
+  many.back()->unlock_shared();
+}
+
+// ===================================================================
+//                        CONCURRENCY TESTS
+// ===================================================================
+
+template <typename Mutex>
+void nested_workload()
+{
+  sync_prim::recursive_upgrade_mutex<Mutex> mtx;
+  using lockable = sync_prim::recursive_upgrade_mutex<Mutex>;
+  long counter = 0;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&, t]()
+                         {
+      for (int i = 0; i < 2000; ++i)
+      {
+        if ((i + t) % 3 == 0)
+        {
+          sync_prim::upgrade_lock<lockable> u_lock(mtx);
+          sync_prim::shared_lock<lockable> nested(mtx);
+          sync_prim::unique_lock<lockable> x_lock(std::move(u_lock));
+          ++counter;
+        }
+        else
+        {
+          sync_prim::shared_lock<lockable> s_lock(mtx);
+          sync_prim::shared_lock<lockable> nested(mtx);
+          (void)counter;
+        }
+      } });
+  }
+  for (auto &t : threads)
+    t.join();
+  long expected = 0;
+  for (int t = 0; t < 4; ++t)
+    for (int i = 0; i < 2000; ++i)
+      expected += (i + t) % 3 == 0;
+  assert(counter == expected);
+}
+
+void test_contended_nested_workload()
+{
+  nested_workload<sync_prim::upgrade_mutex>();
+  nested_workload<sync_prim::basic_upgrade_mutex<sync_prim::writer_preferring>>();
+  nested_workload<sync_prim::distributed_upgrade_mutex<>>();
+}
+
+int main()
+{
+  std::cout << "--- Running Reentrancy Tests ---" << std::endl;
+  run_test(test_nested_same_mode, "Nested locks in the same mode");
+  run_test(test_nested_shared_ignores_pending_upgrade, "Nested shared lock while an upgrade is pending");
+  run_test(test_upgrade_with_extra_shared_references, "Upgrade while holding extra shared references");
+  run_test(test_step_up_from_shared, "Stepping up from shared and back down");
+  run_test(test_failed_step_up_keeps_shared, "A failed step up keeps the shared lock");
+  run_test(test_step_up_past_converting_upgrader, "Stepping up from shared refuses to wait for an upgrader");
+  run_test(test_conditional_transitions_from_shared, "Shared -> Upgrade and Shared -> Unique try transitions");
+  run_test(test_holdings_are_per_mutex_and_bounded, "Holdings are per mutex and bounded");
+
+  std::cout << "\n--- Running Concurrency Tests ---" << std::endl;
+  run_test(test_contended_nested_workload, "Contended nested workload");
+
+  return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sync_prim/striped_upgrade_mutex.hpp"
+#include "test_utils.hpp"
+#include <iostream>
+#include <cassert>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using striped_mutex = sync_prim::striped_upgrade_mutex<16>;
+
+// ===================================================================
+//                        MAPPING TESTS
+// ===================================================================
+
+void test_key_mapping()
+{
+  striped_mutex table;
+  static_assert(striped_mutex::stripe_count() == 16);
+
+  // The mapping is stable, and sequential keys spread over the stripes
+  std::set<std::size_t> used;
+  for (int key = 0; key < 64; ++key)
+  {
+    assert(table.index_of(key) == table.index_of(key));
+    assert(table.index_of(key) < 16);
+    used.insert(table.index_of(key));
+  }
+  assert(used.size() > 8);
+  assert(&table.mutex_for(std::string("a")) == &table.stripe(table.index_of(std::string("a"))));
+}
+
+void test_pool_layout()
+{
+  sync_prim::upgrade_mutex_pool<> pool(100);
+  assert(pool.stripe_count() == 100);
+
+  // One contiguous block, one or more cache lines per stripe
+  auto *first = reinterpret_cast<const char *>(&pool.stripe(0));
+  auto *last = reinterpret_cast<const char *>(&pool.stripe(99));
+  assert(static_cast<std::size_t>(last - first) == 99 * sizeof(sync_prim::padded_upgrade_mutex<>));
+  assert(reinterpret_cast<std::uintptr_t>(first) % sync_prim::cache_line_size == 0);
+
+  assert(sync_prim::upgrade_mutex_pool<>(0).stripe_count() == 1);
+}
+
+// ===================================================================
+//                        LOCKING TESTS
+// ===================================================================
+
+void test_single_key_locks()
+{
+  striped_mutex table;
+  {
+    auto s_lock = table.lock_shared(7);
+    auto u_lock = table.lock_upgrade(7); // Shared and upgrade coexist
+    assert(s_lock.owns_lock() && u_lock.owns_lock());
+    assert(!table.mutex_for(7).try_lock());
+  }
+  auto x_lock = table.lock(7);
+  assert(!table.mutex_for(7).try_lock_shared());
+}
+
+void test_multi_key_dedups_stripes()
+{
+  striped_mutex table;
+  // 64 keys on 16 stripes must share stripes; each stripe is locked once
+  std::vector<int> keys;
+  for (int key = 0; key < 64; ++key)
+    keys.push_back(key);
+
+  auto locks = table.lock(keys.begin(), keys.end());
+  assert(locks.size() <= 16);
+  for (std::size_t i = 0; i + 1 < locks.size(); ++i)
+    assert(locks[i].mutex() != locks[i + 1].mutex());
+  for (int key : keys)
+    assert(!table.mutex_for(key).try_lock_shared());
+
+  locks.clear();
+  for (int key : keys)
+  {
+    assert(table.mutex_for(key).try_lock());
+    table.mutex_for(key).unlock();
+  }
+}
+
+void test_multi_key_no_deadlock()
+{
+  // Two threads lock the same keys given in opposite orders
+  striped_mutex table;
+  long long counter = 0;
+  auto worker = [&](std::initializer_list<int> keys)
+  {
+    for (int op = 0; op < 2000; ++op)
+    {
+      auto locks = table.lock(keys);
+      ++counter;
+    }
+  };
+  std::thread t1([&]()
+                 { worker({1, 2, 3, 4}); });
+  std::thread t2([&]()
+                 { worker({4, 3, 2, 1}); });
+  t1.join();
+  t2.join();
+  assert(counter == 4000);
+
+  auto shared = table.lock_shared({1, 2});
+  auto upgrades = table.lock_upgrade({3, 4});
+  assert(!shared.empty() && !upgrades.empty());
+}
+
+int main()
+{
+  std::cout << "--- Running Striped Mapping Tests ---" << std::endl;
+  run_test(test_key_mapping, "Keys map to stable, spread-out stripes");
+  run_test(test_pool_layout, "Pool stripes are contiguous and padded");
+
+  std::cout << "\n--- Running Striped Locking Tests ---" << std::endl;
+  run_test(test_single_key_locks, "Per-key shared/upgrade/exclusive locks");
+  run_test(test_multi_key_dedups_stripes, "Multi-key lock takes each stripe once");
+  run_test(test_multi_key_no_deadlock, "Multi-key lock is deadlock-free");
+
+  return 0;
+}
@@ -0,0 +1,242 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sync_prim/synchronized.hpp"
+#include "sync_prim/distributed_upgrade_mutex.hpp"
+#include "test_utils.hpp"
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using futex_mutex = sync_prim::basic_upgrade_mutex<sync_prim::futex_backend>;
+
+// Address of a cache line, used to check which objects share one
+inline std::uintptr_t line_of(const void *p)
+{
+  return reinterpret_cast<std::uintptr_t>(p) / sync_prim::cache_line_size;
+}
+
+// ===================================================================
+//                        LAYOUT TESTS
+// ===================================================================
+
+void test_mutex_layout()
+{
+  // A condvar-backed mutex keeps its state word on a line of its own
+  static_assert(alignof(sync_prim::upgrade_mutex) == sync_prim::cache_line_size);
+  static_assert(sizeof(sync_prim::upgrade_mutex) % sync_prim::cache_line_size == 0);
+
+  // A futex-backed mutex stays a single word, and padding it is opt-in
+  static_assert(sizeof(futex_mutex) == sizeof(uint32_t));
+  static_assert(sizeof(sync_prim::padded_upgrade_mutex<futex_mutex>) == sync_prim::cache_line_size);
+  static_assert(alignof(sync_prim::distributed_upgrade_mutex<4>) == sync_prim::cache_line_size);
+
+  sync_prim::padded_upgrade_mutex<futex_mutex> mutexes[2];
+  assert(line_of(&mutexes[0]) != line_of(&mutexes[1]));
+}
+
+void test_cache_padded()
+{
+  sync_prim::cache_padded<std::atomic<int>> counters[4];
+  for (int i = 0; i < 3; ++i)
+    assert(line_of(&counters[i]) != line_of(&counters[i + 1]));
+
+  sync_prim::cache_padded<int> value(42);
+  assert(*value == 42);
+}
+
+void test_synchronized_layout()
+{
+  static_assert(alignof(sync_prim::synchronized<long long>) == sync_prim::cache_line_size);
+  static_assert(sizeof(sync_prim::synchronized<long long, futex_mutex>) == 2 * sync_prim::cache_line_size);
+
+  sync_prim::synchronized<long long, futex_mutex> values[2];
+  assert(line_of(&values[0]) != line_of(&values[1]));
+  assert(line_of(&values[0]) != line_of(&*values[0].rlock()));
+}
+
+// ===================================================================
+//                        ACCESS TESTS
+// ===================================================================
+
+void test_synchronized_access()
+{
+  sync_prim::synchronized<std::vector<int>> data(3, 7);
+  assert(data.rlock()->size() == 3);
+
+  data.wlock()->push_back(1);
+  assert(data.rlock()->back() == 1);
+
+  // rlock() is available on a const object
+  const auto &cdata = data;
+  assert((*cdata.rlock())[0] == 7);
+}
+
+void test_synchronized_excludes_writers()
+{
+  sync_prim::synchronized<long long> counter;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([&]()
+                         {
+            for (int op = 0; op < 1000; ++op)
+            {
+                auto value = counter.wlock();
+                ++*value;
+            } });
+  }
+  for (auto &t : threads)
+    t.join();
+  assert(*counter.rlock() == 4000);
+}
+
+// Whether another thread can take each mode on the synchronized's mutex now.
+template <typename Sync>
+bool other_can(Sync &sync, int mode)
+{
+  bool ok = false;
+  std::thread([&]()
+              {
+    auto &mtx = sync.mutex();
+    if (mode == 0 && (ok = mtx.try_lock_shared()))
+      mtx.unlock_shared();
+    if (mode == 1 && (ok = mtx.try_lock_upgrade()))
+      mtx.unlock_upgrade();
+    if (mode == 2 && (ok = mtx.try_lock()))
+      mtx.unlock(); })
+      .join();
+  return ok;
+}
+
+void test_synchronized_callbacks()
+{
+  sync_prim::synchronized<std::vector<int>> data(2, 5);
+  std::size_t size = data.read([&](const std::vector<int> &v)
+                               {
+    assert(other_can(data, 0) && other_can(data, 1) && !other_can(data, 2));
+    return v.size(); });
+  assert(size == 2);
+
+  // A reference returned by the callback is copied out under the lock, so
+  // nothing escapes the lock's scope.
+  auto push_and_peek = [&](std::vector<int> &v) -> int &
+  {
+    assert(!other_can(data, 0));
+    v.push_back(9);
+    return v.front();
+  };
+  auto peek = [](const std::vector<int> &v) -> const int & { return v.front(); };
+  static_assert(std::is_same_v<decltype(data.write(push_and_peek)), int>);
+  static_assert(std::is_same_v<decltype(data.read(peek)), int>);
+  auto peek_all = [](auto &u) -> const std::vector<int> & { return *u; };
+  auto peek_while_writing = [&](auto &u)
+  {
+    static_assert(std::is_same_v<decltype(u.write(push_and_peek)), int>);
+    return 0;
+  };
+  static_assert(std::is_same_v<decltype(data.upgrade(peek_all)), std::vector<int>>);
+  static_assert(std::is_same_v<decltype(data.upgrade(peek_while_writing)), int>);
+  int first = data.write(push_and_peek);
+  assert(first == data.read(peek));
+
+  // upgrade() reads under the upgrade lock, escalating only when needed
+  auto append_once = [&](int value)
+  {
+    return data.upgrade([&](auto &u)
+                        {
+      assert(other_can(data, 0) && !other_can(data, 1));
+      if (u->back() == value)
+        return false;
+      return u.write([&](std::vector<int> &v)
+                     {
+        assert(!other_can(data, 0));
+        v.push_back(value);
+        return true; }); });
+  };
+  assert(!append_once(9));
+  assert(append_once(10));
+  assert(data.rlock()->back() == 10);
+  assert(other_can(data, 2));
+}
+
+void test_synchronized_upgrade_proxy()
+{
+  sync_prim::synchronized<int> value(1);
+  {
+    auto u = value.ulock();
+    assert(*u == 1);
+    assert(other_can(value, 0) && !other_can(value, 1));
+    assert(u.write([](int &v)
+                   { return ++v; }) == 2);
+    assert(other_can(value, 0)); // Back to upgradeable
+
+    auto x = std::move(u).upgrade();
+    assert(!other_can(value, 0));
+    *x = 3;
+  }
+  assert(*value.rlock() == 3);
+
+  // The instrumented policy attributes holds through mutex()
+  sync_prim::synchronized<int, sync_prim::basic_upgrade_mutex<sync_prim::instrumented>> counted;
+  counted.write([](int &v)
+                { v = 1; });
+  counted.upgrade([](auto &u)
+                  { u.write([](int &v)
+                            { ++v; }); });
+  assert(counted.mutex().stats().exclusive_hold.holds == 2);
+  assert(counted.mutex().stats().upgrade_hold.holds == 2); // Split by the escalation
+}
+
+void test_padded_mutex_guards()
+{
+  using padded = sync_prim::padded_upgrade_mutex<>;
+  padded mtx;
+  sync_prim::upgrade_lock<padded> u_lock(mtx);
+  {
+    sync_prim::scoped_upgrade<padded> s_upgrade(u_lock);
+    assert(!mtx.try_lock_shared());
+  }
+  assert(mtx.try_lock_shared());
+  mtx.unlock_shared();
+}
+
+int main()
+{
+  std::cout << "--- Running Layout Tests ---" << std::endl;
+  run_test(test_mutex_layout, "Mutex state word placement");
+  run_test(test_cache_padded, "cache_padded spacing");
+  run_test(test_synchronized_layout, "synchronized places lock and value on separate lines");
+
+  std::cout << "\n--- Running Access Tests ---" << std::endl;
+  run_test(test_synchronized_access, "synchronized rlock/wlock access");
+  run_test(test_synchronized_excludes_writers, "synchronized wlock is exclusive");
+  run_test(test_synchronized_callbacks, "synchronized read/upgrade/write callbacks");
+  run_test(test_synchronized_upgrade_proxy, "synchronized ulock proxy escalation");
+  run_test(test_padded_mutex_guards, "padded_upgrade_mutex works with all guards");
+
+  return 0;
+}
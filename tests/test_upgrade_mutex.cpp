@@ -22,27 +22,12 @@
  */
 
 #include "sync_prim/upgrade_mutex.hpp"
+#include "test_utils.hpp"
 #include <iostream>
 #include <cassert>
 #include <thread>
-
-// --- Test Runner Helper ---
-void run_test(void (*test_func)(), const std::string &test_name)
-{
-  try
-  {
-    test_func();
-    std::cout << "[PASS] " << test_name << std::endl;
-  }
-  catch (const std::exception &e)
-  {
-    std::cerr << "[FAIL] " << test_name << " - Exception: " << e.what() << std::endl;
-  }
-  catch (...)
-  {
-    std::cerr << "[FAIL] " << test_name << " - Unknown exception" << std::endl;
-  }
-}
+#include <vector>
+#include <shared_mutex>
 
 // ===================================================================
 //                        CORE LOGIC TESTS
@@ -103,6 +88,635 @@ void test_upgrade_allows_readers()
   assert(s_lock.owns_lock());
 }
 
+void test_concurrent_readers()
+{
+  sync_prim::upgrade_mutex mtx;
+  std::atomic<int> inside = 0;
+  std::vector<std::thread> threads;
+
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([&]()
+                         {
+        for (int op = 0; op < 1000; ++op) {
+            sync_prim::shared_lock<sync_prim::upgrade_mutex> s_lock(mtx);
+            ++inside;
+            --inside;
+        } });
+  }
+  for (auto &t : threads)
+    t.join();
+
+  // The mutex must be completely free again
+  sync_prim::unique_lock<sync_prim::upgrade_mutex> x_lock(mtx);
+  assert(x_lock.owns_lock());
+  assert(inside == 0);
+}
+
+void test_last_reader_wakes_writer()
+{
+  sync_prim::upgrade_mutex mtx;
+  sync_prim::shared_lock<sync_prim::upgrade_mutex> s_lock(mtx);
+
+  std::atomic<bool> thread_finished = false;
+  std::thread t([&]()
+                {
+        sync_prim::unique_lock<sync_prim::upgrade_mutex> x_lock(mtx);
+        thread_finished = true; });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(!thread_finished);
+
+  s_lock.release(); // Manually release the lock
+  mtx.unlock_shared();
+
+  t.join();
+  assert(thread_finished);
+}
+
+void test_unlock_wakes_parked_waiters()
+{
+  sync_prim::upgrade_mutex mtx;
+  sync_prim::unique_lock<sync_prim::upgrade_mutex> x_lock(mtx);
+
+  std::atomic<int> finished = 0;
+  std::thread writer([&]()
+                     {
+        sync_prim::unique_lock<sync_prim::upgrade_mutex> lock(mtx);
+        ++finished; });
+  std::thread upgrader([&]()
+                       {
+        sync_prim::upgrade_lock<sync_prim::upgrade_mutex> lock(mtx);
+        ++finished; });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(finished == 0);
+
+  x_lock.release();
+  mtx.unlock();
+
+  writer.join();
+  upgrader.join();
+  assert(finished == 2);
+}
+
+void test_wait_policies()
+{
+  contended_counter_workload<sync_prim::basic_upgrade_mutex<sync_prim::pure_spin>>();
+  contended_counter_workload<sync_prim::basic_upgrade_mutex<sync_prim::spin_then_park>>();
+  contended_counter_workload<sync_prim::basic_upgrade_mutex<sync_prim::immediate_park>>();
+}
+
+void test_futex_backend()
+{
+  using futex_mutex = sync_prim::basic_upgrade_mutex<sync_prim::futex_backend>;
+  static_assert(sizeof(futex_mutex) == sizeof(uint32_t), "futex_backend must not add any storage");
+
+  contended_counter_workload<futex_mutex>();
+  contended_counter_workload<sync_prim::basic_upgrade_mutex<sync_prim::immediate_park, sync_prim::futex_backend>>();
+
+  // A parked upgrader must be woken by the last reader
+  futex_mutex mtx;
+  sync_prim::shared_lock<futex_mutex> s_lock(mtx);
+  std::atomic<bool> upgraded = false;
+  std::thread t([&]()
+                {
+        sync_prim::upgrade_lock<futex_mutex> u_lock(mtx);
+        sync_prim::scoped_upgrade<futex_mutex> s_upgrade(u_lock);
+        upgraded = true; });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(!upgraded);
+  s_lock.release();
+  mtx.unlock_shared();
+  t.join();
+  assert(upgraded);
+
+  // A deadline of time_point::max() parks until the lock is released
+  using park_mutex = sync_prim::basic_upgrade_mutex<sync_prim::immediate_park, sync_prim::futex_backend>;
+  park_mutex parked;
+  parked.lock();
+  std::atomic<bool> acquired = false;
+  std::thread waiter([&]()
+                     {
+        assert(parked.try_lock_until(std::chrono::steady_clock::time_point::max()));
+        acquired = true;
+        parked.unlock(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(!acquired);
+  parked.unlock();
+  waiter.join();
+  assert(acquired);
+}
+
+// ===================================================================
+//                        NON-BLOCKING TESTS
+// ===================================================================
+
+void test_try_lock()
+{
+  sync_prim::upgrade_mutex mtx;
+  assert(mtx.try_lock());
+  assert(!mtx.try_lock());
+  assert(!mtx.try_lock_shared());
+  assert(!mtx.try_lock_upgrade());
+  mtx.unlock();
+
+  assert(mtx.try_lock_shared());
+  assert(mtx.try_lock_upgrade()); // Upgrader coexists with readers
+  assert(!mtx.try_lock_upgrade()); // But there is only one
+  assert(!mtx.try_lock());
+  mtx.unlock_upgrade();
+  mtx.unlock_shared();
+  assert(mtx.try_lock());
+  mtx.unlock();
+}
+
+void test_guard_lock_tags()
+{
+  sync_prim::upgrade_mutex mtx;
+  {
+    sync_prim::shared_lock<sync_prim::upgrade_mutex> s_lock(mtx, std::try_to_lock);
+    assert(s_lock.owns_lock());
+
+    sync_prim::unique_lock<sync_prim::upgrade_mutex> x_lock(mtx, std::try_to_lock);
+    assert(!x_lock.owns_lock());
+    assert(x_lock.mutex() == &mtx);
+  }
+  {
+    sync_prim::unique_lock<sync_prim::upgrade_mutex> x_lock(mtx, std::defer_lock);
+    assert(!x_lock.owns_lock());
+    x_lock.lock();
+    assert(x_lock.owns_lock());
+    x_lock.unlock();
+    assert(x_lock.try_lock());
+  }
+  {
+    mtx.lock_upgrade();
+    sync_prim::upgrade_lock<sync_prim::upgrade_mutex> u_lock(mtx, std::adopt_lock);
+    assert(u_lock.owns_lock());
+  }
+  // Everything above must have been released
+  assert(mtx.try_lock());
+  mtx.unlock();
+}
+
+void test_try_upgrade()
+{
+  sync_prim::upgrade_mutex mtx;
+  sync_prim::upgrade_lock<sync_prim::upgrade_mutex> u_lock(mtx);
+  {
+    sync_prim::shared_lock<sync_prim::upgrade_mutex> s_lock(mtx);
+
+    // A reader is present, so the upgrade must fail and leave u_lock intact
+    sync_prim::unique_lock<sync_prim::upgrade_mutex> x_lock(std::move(u_lock), std::try_to_lock);
+    assert(!x_lock.owns_lock());
+    assert(u_lock.owns_lock());
+
+    sync_prim::scoped_upgrade<sync_prim::upgrade_mutex> s_upgrade(u_lock, std::try_to_lock);
+    assert(!s_upgrade.owns_lock());
+
+    // A failed attempt must not block new readers
+    assert(mtx.try_lock_shared());
+    mtx.unlock_shared();
+  }
+  {
+    sync_prim::scoped_upgrade<sync_prim::upgrade_mutex> s_upgrade(u_lock, std::try_to_lock);
+    assert(s_upgrade.owns_lock());
+    assert(!mtx.try_lock_shared());
+  }
+  sync_prim::unique_lock<sync_prim::upgrade_mutex> x_lock(std::move(u_lock), std::try_to_lock);
+  assert(x_lock.owns_lock());
+  assert(!u_lock.owns_lock());
+}
+
+void test_move_assign_releases_old_lock()
+{
+  sync_prim::upgrade_mutex mtx1, mtx2;
+  sync_prim::unique_lock<sync_prim::upgrade_mutex> lock(mtx1);
+  lock = sync_prim::unique_lock<sync_prim::upgrade_mutex>(mtx2);
+  assert(lock.mutex() == &mtx2);
+  assert(mtx1.try_lock()); // mtx1 was released by the assignment
+  mtx1.unlock();
+}
+
+// ===================================================================
+//                        TIMED TESTS
+// ===================================================================
+
+void test_timed_lock()
+{
+  using namespace std::chrono_literals;
+  sync_prim::upgrade_mutex mtx;
+  sync_prim::unique_lock<sync_prim::upgrade_mutex> x_lock(mtx);
+
+  std::thread t([&]()
+                {
+        // Every mode must give up while the writer holds the lock
+        assert(!mtx.try_lock_for(10ms));
+        assert(!mtx.try_lock_shared_for(10ms));
+        assert(!mtx.try_lock_upgrade_until(std::chrono::steady_clock::now() + 10ms));
+
+        sync_prim::shared_lock<sync_prim::upgrade_mutex> s_lock(mtx, 10ms);
+        assert(!s_lock.owns_lock());
+
+        // ...and succeed once it is released within the timeout
+        assert(s_lock.try_lock_for(2s)); });
+
+  std::this_thread::sleep_for(100ms);
+  x_lock.unlock();
+  t.join();
+
+  // The futex backend parks with an OS-level timeout
+  using futex_mutex = sync_prim::basic_upgrade_mutex<sync_prim::immediate_park, sync_prim::futex_backend>;
+  futex_mutex f_mtx;
+  f_mtx.lock();
+  std::thread f([&]()
+                { assert(!f_mtx.try_lock_shared_for(20ms)); });
+  f.join();
+  f_mtx.unlock();
+  assert(f_mtx.try_lock_for(20ms));
+  f_mtx.unlock();
+}
+
+void test_shared_timed_mutex_interop()
+{
+  using namespace std::chrono_literals;
+  sync_prim::upgrade_mutex mtx;
+  std::shared_lock<sync_prim::upgrade_mutex> s_lock(mtx, 10ms);
+  assert(s_lock.owns_lock());
+
+  std::unique_lock<sync_prim::upgrade_mutex> x_lock(mtx, std::defer_lock);
+  assert(!x_lock.try_lock_for(10ms));
+}
+
+void test_timed_upgrade_releases_readers()
+{
+  using namespace std::chrono_literals;
+  sync_prim::upgrade_mutex mtx;
+  sync_prim::upgrade_lock<sync_prim::upgrade_mutex> u_lock(mtx);
+  sync_prim::shared_lock<sync_prim::upgrade_mutex> old_reader(mtx);
+
+  std::atomic<bool> new_reader_done = false;
+  std::thread upgrader([&]()
+                       {
+        sync_prim::unique_lock<sync_prim::upgrade_mutex> x_lock(std::move(u_lock), 200ms);
+        assert(!x_lock.owns_lock()); // old_reader never leaves
+        assert(u_lock.owns_lock()); });
+
+  // Give the upgrader time to set the pending flag, then start a new reader
+  // that blocks behind it.
+  std::this_thread::sleep_for(50ms);
+  std::thread new_reader([&]()
+                         {
+        sync_prim::shared_lock<sync_prim::upgrade_mutex> s_lock(mtx);
+        new_reader_done = true; });
+
+  upgrader.join();
+  new_reader.join(); // Must be released by the abandoned upgrade
+  assert(new_reader_done);
+
+  // With old_reader gone, a timed scoped upgrade succeeds
+  old_reader.unlock();
+  sync_prim::scoped_upgrade<sync_prim::upgrade_mutex> s_upgrade(u_lock, 1s);
+  assert(s_upgrade.owns_lock());
+}
+
+// ===================================================================
+//                        FAIRNESS TESTS
+// ===================================================================
+
+// Returns whether a new reader gets in while a writer waits for an old one
+template <typename Mutex>
+bool new_reader_passes_waiting_writer()
+{
+  Mutex mtx;
+  mtx.lock_shared();
+  std::thread writer([&]()
+                     { sync_prim::unique_lock<Mutex> x_lock(mtx); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  bool passed = mtx.try_lock_shared();
+  if (passed)
+    mtx.unlock_shared();
+  mtx.unlock_shared();
+  writer.join();
+  return passed;
+}
+
+void test_writer_preference()
+{
+  assert(new_reader_passes_waiting_writer<sync_prim::upgrade_mutex>());
+  assert(!new_reader_passes_waiting_writer<sync_prim::basic_upgrade_mutex<sync_prim::writer_preferring>>());
+  assert(!new_reader_passes_waiting_writer<sync_prim::basic_upgrade_mutex<sync_prim::phase_fair>>());
+
+  // A timed-out writer withdraws its claim, so readers are admitted again
+  using wp_mutex = sync_prim::basic_upgrade_mutex<sync_prim::writer_preferring>;
+  wp_mutex mtx;
+  mtx.lock_shared();
+  std::thread writer([&]()
+                     { assert(!mtx.try_lock_for(std::chrono::milliseconds(20))); });
+  writer.join();
+  assert(mtx.try_lock_shared());
+  mtx.unlock_shared();
+  mtx.unlock_shared();
+}
+
+void test_phase_fair_alternates()
+{
+  // A reader and a second writer both queue behind a writer. When the first
+  // writer releases, the reader's batch must go before the second writer.
+  using pf_mutex = sync_prim::basic_upgrade_mutex<sync_prim::phase_fair>;
+  pf_mutex mtx;
+  std::atomic<int> next = 0;
+  int reader_pos = -1, writer_pos = -1;
+
+  sync_prim::unique_lock<pf_mutex> x_lock(mtx);
+  std::thread reader([&]()
+                     {
+        sync_prim::shared_lock<pf_mutex> s_lock(mtx);
+        reader_pos = next++; });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  std::thread writer([&]()
+                     {
+        sync_prim::unique_lock<pf_mutex> w_lock(mtx);
+        writer_pos = next++; });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  x_lock.unlock();
+  reader.join();
+  writer.join();
+  assert(reader_pos == 0 && writer_pos == 1);
+}
+
+void test_fairness_policies()
+{
+  contended_counter_workload<sync_prim::basic_upgrade_mutex<sync_prim::writer_preferring>>();
+  contended_counter_workload<sync_prim::basic_upgrade_mutex<sync_prim::writer_preferring, sync_prim::futex_backend>>();
+  contended_counter_workload<sync_prim::basic_upgrade_mutex<sync_prim::phase_fair>>();
+  contended_counter_workload<sync_prim::basic_upgrade_mutex<sync_prim::phase_fair, sync_prim::immediate_park>>();
+  contended_counter_workload<sync_prim::basic_upgrade_mutex<sync_prim::phase_fair, sync_prim::pure_spin, sync_prim::futex_backend>>();
+}
+
+// ===================================================================
+//                        HANDOFF TESTS
+// ===================================================================
+
+using handoff_mutex = sync_prim::basic_upgrade_mutex<sync_prim::direct_handoff, sync_prim::immediate_park>;
+
+void test_unlock_hands_off_to_parked_writer()
+{
+  // Once a writer is parked, unlock() passes the lock on instead of freeing
+  // it, so a thread arriving right after cannot barge in.
+  handoff_mutex mtx;
+  std::atomic<bool> writer_done = false;
+
+  mtx.lock();
+  std::thread writer([&]()
+                     {
+        mtx.lock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        writer_done = true;
+        mtx.unlock(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  mtx.unlock();
+  assert(!mtx.try_lock());
+  assert(!mtx.try_lock_shared());
+  mtx.lock_shared();
+  assert(writer_done);
+  mtx.unlock_shared();
+  writer.join();
+}
+
+void test_last_reader_hands_off_to_parked_writer()
+{
+  handoff_mutex mtx;
+  std::atomic<bool> writer_done = false;
+
+  mtx.lock_shared();
+  std::thread writer([&]()
+                     {
+        sync_prim::unique_lock<handoff_mutex> x_lock(mtx);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        writer_done = true; });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  mtx.unlock_shared();
+  assert(!mtx.try_lock_shared());
+  sync_prim::shared_lock<handoff_mutex> s_lock(mtx);
+  assert(writer_done);
+  writer.join();
+}
+
+void test_handoff_policies()
+{
+  contended_counter_workload<handoff_mutex>();
+  contended_counter_workload<sync_prim::basic_upgrade_mutex<sync_prim::direct_handoff>>();
+  contended_counter_workload<sync_prim::basic_upgrade_mutex<sync_prim::direct_handoff, sync_prim::writer_preferring>>();
+  contended_counter_workload<sync_prim::basic_upgrade_mutex<sync_prim::direct_handoff, sync_prim::phase_fair>>();
+
+  // A timed writer can receive the lock too
+  handoff_mutex mtx;
+  mtx.lock();
+  std::thread writer([&]()
+                     {
+        assert(mtx.try_lock_for(std::chrono::seconds(5)));
+        mtx.unlock(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  mtx.unlock();
+  writer.join();
+}
+
+// ===================================================================
+//                        INSTRUMENTATION TESTS
+// ===================================================================
+
+using stats_mutex = sync_prim::basic_upgrade_mutex<sync_prim::instrumented, sync_prim::immediate_park>;
+
+void test_stats_counts_acquisitions()
+{
+  static_assert(sizeof(sync_prim::basic_upgrade_mutex<sync_prim::futex_backend, sync_prim::no_instrumentation>) == sizeof(uint32_t),
+                "instrumentation must cost nothing when disabled");
+
+  stats_mutex mtx;
+  mtx.lock();
+  mtx.unlock();
+  mtx.lock_shared();
+  assert(mtx.try_lock_shared());
+  assert(!mtx.try_lock());
+  {
+    sync_prim::upgrade_lock<stats_mutex> u_lock(mtx);
+    sync_prim::unique_lock<stats_mutex> x_lock(std::move(u_lock), std::try_to_lock);
+    assert(!x_lock.owns_lock());
+  }
+  mtx.unlock_shared();
+  mtx.unlock_shared();
+  {
+    sync_prim::upgrade_lock<stats_mutex> u_lock(mtx);
+    sync_prim::scoped_upgrade<stats_mutex> s_upgrade(u_lock);
+  }
+
+  sync_prim::lock_stats stats = mtx.stats();
+  assert(stats.exclusive.fast_acquisitions == 1 && stats.exclusive.slow_acquisitions == 0);
+  assert(stats.shared.fast_acquisitions == 2);
+  assert(stats.upgrade.acquisitions() == 2);
+  assert(stats.max_concurrent_readers == 2);
+  assert(stats.upgrade_attempts == 2 && stats.upgrade_failures == 1);
+  assert(stats.upgrade_pending.holds == 1);
+  assert(stats.exclusive_hold.holds == 2); // lock() and the scoped upgrade
+  assert(stats.upgrade_hold.holds == 3);   // ended by unlock, by upgrading, and after the downgrade
+  assert(stats.gate1.parks == 0 && stats.gate2.parks == 0);
+
+  mtx.reset_stats();
+  stats = mtx.stats();
+  assert(stats.shared.acquisitions() == 0 && stats.max_concurrent_readers == 0);
+}
+
+void test_stats_time_slow_paths()
+{
+  stats_mutex mtx;
+  mtx.lock_shared();
+  std::thread writer([&]()
+                     { sync_prim::unique_lock<stats_mutex> x_lock(mtx); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  mtx.unlock_shared();
+  writer.join();
+
+  sync_prim::lock_stats stats = mtx.stats();
+  assert(stats.exclusive.slow_acquisitions == 1);
+  assert(stats.gate2.parks >= 1);
+  assert(stats.gate2.wait_ns >= 10'000'000);
+  assert(stats.exclusive_hold.holds == 1);
+}
+
+// ===================================================================
+//                        OPTIMISTIC READ TESTS
+// ===================================================================
+
+using seq_mutex = sync_prim::basic_upgrade_mutex<sync_prim::optimistic_reads>;
+
+void test_read_validate()
+{
+  static_assert(sizeof(sync_prim::basic_upgrade_mutex<sync_prim::futex_backend, sync_prim::optimistic_reads>) == 2 * sizeof(uint32_t),
+                "optimistic_reads adds exactly one version word");
+
+  seq_mutex mtx;
+  uint32_t token = mtx.read_begin();
+  {
+    // Shared and upgrade holders do not disturb optimistic readers
+    sync_prim::shared_lock<seq_mutex> s_lock(mtx);
+    sync_prim::upgrade_lock<seq_mutex> u_lock(mtx);
+  }
+  assert(mtx.read_validate(token));
+
+  // Every exit from exclusive mode invalidates the token
+  {
+    sync_prim::unique_lock<seq_mutex> x_lock(mtx);
+    assert(!mtx.read_validate(token)); // ...and so does an active writer
+  }
+  assert(!mtx.read_validate(token));
+
+  token = mtx.read_begin();
+  sync_prim::upgrade_lock<seq_mutex> u_lock(mtx);
+  {
+    sync_prim::scoped_upgrade<seq_mutex> s_upgrade(u_lock);
+  }
+  assert(!mtx.read_validate(token));
+
+  token = mtx.read_begin();
+  sync_prim::unique_lock<seq_mutex> x_lock(std::move(u_lock));
+  sync_prim::shared_lock<seq_mutex> s_lock(std::move(x_lock));
+  assert(!mtx.read_validate(token));
+  assert(mtx.read_validate(mtx.read_begin())); // The downgraded reader does not block read_begin()
+}
+
+void test_read_begin_is_not_an_acquisition()
+{
+  using counted_mutex = sync_prim::basic_upgrade_mutex<sync_prim::optimistic_reads, sync_prim::instrumented, sync_prim::immediate_park>;
+  counted_mutex mtx;
+  std::atomic<bool> writing = false;
+  std::thread writer([&]()
+                     {
+        sync_prim::unique_lock<counted_mutex> x_lock(mtx);
+        writing = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50)); });
+  while (!writing)
+    std::this_thread::yield();
+  uint32_t token = mtx.read_begin(); // Parks until the writer leaves
+  writer.join();
+  assert(mtx.read_validate(token));
+
+  sync_prim::lock_stats stats = mtx.stats();
+  assert(stats.shared.acquisitions() == 0);
+  assert(stats.max_concurrent_readers == 0);
+  assert(stats.gate1.parks == 0);
+  assert(stats.exclusive.acquisitions() == 1);
+}
+
+template <typename Mutex>
+void optimistic_reads_workload()
+{
+  // The writers keep a == b. A validated read must never see them differ.
+  // Two writers, one of them timed, so that with direct_handoff the lock is
+  // also granted to parked writers of both kinds.
+  Mutex mtx;
+  std::atomic<long long> a = 0, b = 0;
+  std::atomic<int> writers_left = 2;
+  std::atomic<int> validated = 0;
+
+  std::vector<std::thread> writers;
+  for (int w = 0; w < 2; ++w)
+  {
+    writers.emplace_back([&, w]()
+                         {
+        for (int i = 0; i < 10000; ++i)
+        {
+            sync_prim::unique_lock<Mutex> x_lock(mtx, std::defer_lock);
+            if (w == 0)
+                x_lock.lock();
+            else
+                while (!x_lock.try_lock_for(std::chrono::seconds(1)))
+                    ;
+            a.store(a.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            b.store(b.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        writers_left--; });
+  }
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 2; ++r)
+  {
+    readers.emplace_back([&]()
+                         {
+            // Keep reading past the writers' end, so some reads always validate
+            for (int i = 0; writers_left > 0 || i < 100; ++i)
+            {
+                uint32_t token = mtx.read_begin();
+                long long seen_a = a.load(std::memory_order_relaxed);
+                long long seen_b = b.load(std::memory_order_relaxed);
+                if (mtx.read_validate(token))
+                {
+                    assert(seen_a == seen_b);
+                    validated++;
+                }
+            } });
+  }
+
+  for (auto &t : writers)
+    t.join();
+  for (auto &t : readers)
+    t.join();
+  assert(validated > 0);
+  assert(a == 20000 && b == 20000);
+}
+
+void test_optimistic_reads_see_consistent_data()
+{
+  optimistic_reads_workload<seq_mutex>();
+  optimistic_reads_workload<sync_prim::basic_upgrade_mutex<sync_prim::optimistic_reads, sync_prim::direct_handoff, sync_prim::immediate_park>>();
+}
+
 // ===================================================================
 //                        TRANSITION TESTS
 // ===================================================================
@@ -170,6 +784,264 @@ void test_scoped_upgrade()
   assert(data == 2);
 }
 
+void test_last_reader_wakes_upgrader()
+{
+  sync_prim::upgrade_mutex mtx;
+  sync_prim::shared_lock<sync_prim::upgrade_mutex> s_lock(mtx);
+
+  std::atomic<bool> upgraded = false;
+  std::thread t([&]()
+                {
+        sync_prim::upgrade_lock<sync_prim::upgrade_mutex> u_lock(mtx);
+        sync_prim::scoped_upgrade<sync_prim::upgrade_mutex> s_upgrade(u_lock);
+        upgraded = true; });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(!upgraded); // The upgrade must wait for the reader
+
+  s_lock.release();
+  mtx.unlock_shared();
+
+  t.join();
+  assert(upgraded);
+}
+
+template <typename Mutex>
+void check_shared_transitions()
+{
+  Mutex mtx;
+  sync_prim::shared_lock<Mutex> s_lock(mtx);
+
+  // Another reader is present: exclusive fails and leaves s_lock intact
+  mtx.lock_shared();
+  sync_prim::unique_lock<Mutex> x_fail(std::move(s_lock), std::try_to_lock);
+  assert(!x_fail.owns_lock());
+  assert(s_lock.owns_lock());
+
+  // Another upgrader is present: upgrade fails and leaves s_lock intact
+  mtx.unlock_shared();
+  mtx.lock_upgrade();
+  sync_prim::upgrade_lock<Mutex> u_fail(std::move(s_lock), std::try_to_lock);
+  assert(!u_fail.owns_lock());
+  assert(s_lock.owns_lock());
+  mtx.unlock_upgrade();
+
+  // Readers do not stop the upgrade lock, which replaces our reader
+  mtx.lock_shared();
+  sync_prim::upgrade_lock<Mutex> u_lock(std::move(s_lock), std::try_to_lock);
+  assert(u_lock.owns_lock());
+  assert(!s_lock.owns_lock());
+  assert(!mtx.try_lock_upgrade());
+  mtx.unlock_shared();
+
+  // Our reader is gone, so the upgrade converts without waiting
+  sync_prim::unique_lock<Mutex> x_lock(std::move(u_lock), std::try_to_lock);
+  assert(x_lock.owns_lock());
+  x_lock.unlock();
+
+  // The sole reader goes straight to exclusive
+  sync_prim::shared_lock<Mutex> sole(mtx);
+  sync_prim::unique_lock<Mutex> x_sole(std::move(sole), std::try_to_lock);
+  assert(x_sole.owns_lock());
+  assert(!sole.owns_lock());
+  assert(!mtx.try_lock_shared());
+  x_sole.unlock();
+  assert(mtx.try_lock());
+  mtx.unlock();
+}
+
+void test_shared_transitions()
+{
+  check_shared_transitions<sync_prim::upgrade_mutex>();
+  check_shared_transitions<sync_prim::basic_upgrade_mutex<sync_prim::writer_preferring>>();
+  check_shared_transitions<sync_prim::basic_upgrade_mutex<sync_prim::phase_fair>>();
+
+  // A waiting writer stops the escalation, as it stops try_lock_upgrade()
+  using wp_mutex = sync_prim::basic_upgrade_mutex<sync_prim::writer_preferring>;
+  wp_mutex mtx;
+  sync_prim::shared_lock<wp_mutex> s_lock(mtx);
+  std::atomic<bool> writer_done = false;
+  std::thread writer([&]()
+                     { sync_prim::unique_lock<wp_mutex> x_lock(mtx); writer_done = true; });
+  while (mtx.try_lock_upgrade())
+  {
+    mtx.unlock_upgrade();
+    std::this_thread::yield();
+  }
+  assert(!mtx.try_upgrade_from_shared());
+  assert(s_lock.owns_lock());
+  s_lock.unlock();
+  writer.join();
+  assert(writer_done);
+}
+
+void test_conditional_escalation_workload()
+{
+  // Readers that find the counter even escalate to bump it. Each bump must
+  // see the value it checked as a reader, since the lock is never released.
+  sync_prim::upgrade_mutex mtx;
+  int counter = 0;
+  std::atomic<int> escalations = 0;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&]()
+                         {
+      for (int i = 0; i < 2000; ++i)
+      {
+        sync_prim::shared_lock<sync_prim::upgrade_mutex> s_lock(mtx);
+        int seen = counter;
+        if (seen % 2 != 0)
+          continue;
+        sync_prim::upgrade_lock<sync_prim::upgrade_mutex> u_lock(std::move(s_lock), std::try_to_lock);
+        if (!u_lock.owns_lock())
+          continue;
+        sync_prim::scoped_upgrade<sync_prim::upgrade_mutex> write(u_lock);
+        assert(counter == seen);
+        counter += 2;
+        ++escalations;
+      } });
+  }
+  for (auto &t : threads)
+    t.join();
+  assert(counter == 2 * escalations);
+}
+
+// ===================================================================
+//                        FEATURE POLICY TESTS
+// ===================================================================
+
+template <typename Mutex>
+void contended_reader_writer_workload()
+{
+  Mutex mtx;
+  long long counter = 0;
+  std::vector<std::thread> threads;
+
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([&, i]()
+                         {
+        for (int op = 0; op < 500; ++op) {
+            if (i % 2 == 0) {
+                sync_prim::unique_lock<Mutex> x_lock(mtx);
+                ++counter;
+            } else {
+                sync_prim::unique_lock<Mutex> x_lock(mtx);
+                ++counter;
+                sync_prim::shared_lock<Mutex> s_lock(std::move(x_lock));
+            }
+            sync_prim::shared_lock<Mutex> s_lock(mtx);
+            volatile long long val = counter; (void)val;
+        } });
+  }
+  for (auto &t : threads)
+    t.join();
+
+  assert(counter == 4 * 500);
+}
+
+void test_no_upgrade()
+{
+  using rw_mutex = sync_prim::basic_upgrade_mutex<sync_prim::no_upgrade, sync_prim::futex_backend>;
+  static_assert(sizeof(rw_mutex) == sizeof(uint32_t), "no_upgrade must not add any storage");
+
+  contended_reader_writer_workload<sync_prim::basic_upgrade_mutex<sync_prim::no_upgrade>>();
+  contended_reader_writer_workload<rw_mutex>();
+
+  // The last reader out wakes a parked writer
+  using park_mutex = sync_prim::basic_upgrade_mutex<sync_prim::no_upgrade, sync_prim::immediate_park>;
+  park_mutex mtx;
+  sync_prim::shared_lock<park_mutex> s_lock(mtx);
+  std::atomic<bool> acquired = false;
+  std::thread writer([&]()
+                     {
+        sync_prim::unique_lock<park_mutex> x_lock(mtx);
+        acquired = true; });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(!acquired);
+
+  // The remaining transitions still work
+  assert(!mtx.try_lock());
+  sync_prim::unique_lock<park_mutex> x_lock(std::move(s_lock), std::try_to_lock);
+  assert(x_lock.owns_lock());
+  sync_prim::shared_lock<park_mutex> again(std::move(x_lock));
+  again.unlock();
+  writer.join();
+  assert(acquired);
+}
+
+void test_wide_state()
+{
+  using wide_mutex = sync_prim::basic_upgrade_mutex<sync_prim::wide_state>;
+  static_assert(sizeof(wide_mutex::state_type) == sizeof(uint64_t), "wide_state must use a 64-bit word");
+
+  // The fairness flags only take reader bits when the policy uses them
+  static_assert(sync_prim::upgrade_mutex::max_readers() == (1u << 27) - 1, "default reader count is 27 bits");
+  static_assert(sync_prim::basic_upgrade_mutex<sync_prim::phase_fair>::max_readers() == (1u << 24) - 1, "phase_fair reader count is 24 bits");
+  static_assert(wide_mutex::max_readers() == (uint64_t(1) << 59) - 1, "wide reader count is 59 bits");
+  static_assert(sync_prim::basic_upgrade_mutex<sync_prim::bounded_readers<3>>::max_readers() == 3, "bounded readers report their limit");
+
+  contended_counter_workload<wide_mutex>();
+  contended_counter_workload<sync_prim::basic_upgrade_mutex<sync_prim::wide_state, sync_prim::phase_fair>>();
+
+  // The default state holds more readers than a phase_fair one
+  sync_prim::upgrade_mutex narrow;
+  for (uint64_t i = 0; i < (uint64_t(1) << 24) + 1; ++i)
+    narrow.lock_shared();
+  assert(!narrow.try_lock());
+  for (uint64_t i = 0; i < (uint64_t(1) << 24) + 1; ++i)
+    narrow.unlock_shared();
+  assert(narrow.try_lock());
+  narrow.unlock();
+
+  // More readers than a 32-bit phase_fair state can count
+  using wide_pf_mutex = sync_prim::basic_upgrade_mutex<sync_prim::wide_state, sync_prim::phase_fair>;
+  const uint64_t readers = (uint64_t(1) << 24) + 1;
+  wide_pf_mutex mtx;
+  for (uint64_t i = 0; i < readers; ++i)
+    mtx.lock_shared();
+  assert(!mtx.try_lock());
+  assert(mtx.try_lock_upgrade());
+  for (uint64_t i = 0; i < readers; ++i)
+    mtx.unlock_shared();
+  sync_prim::upgrade_lock<wide_pf_mutex> u_lock(mtx, std::adopt_lock);
+  sync_prim::unique_lock<wide_pf_mutex> x_lock(std::move(u_lock), std::try_to_lock);
+  assert(x_lock.owns_lock());
+}
+
+void test_bounded_readers()
+{
+  using bounded_mutex = sync_prim::basic_upgrade_mutex<sync_prim::bounded_readers<2>, sync_prim::immediate_park>;
+  bounded_mutex mtx;
+  sync_prim::shared_lock<bounded_mutex> first(mtx);
+  sync_prim::shared_lock<bounded_mutex> second(mtx);
+  assert(!mtx.try_lock_shared());
+  assert(!mtx.try_lock_shared_for(std::chrono::milliseconds(10)));
+
+  // A reader over the limit waits for one to leave
+  std::atomic<bool> admitted = false;
+  std::thread third([&]()
+                    {
+        sync_prim::shared_lock<bounded_mutex> s_lock(mtx);
+        admitted = true; });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  assert(!admitted);
+  first.unlock();
+  third.join();
+  assert(admitted);
+
+  // Stepping up to the upgrade lock frees a reader slot too
+  first.lock();
+  sync_prim::upgrade_lock<bounded_mutex> u_lock(std::move(first), std::try_to_lock);
+  assert(u_lock.owns_lock());
+  assert(mtx.try_lock_shared());
+  mtx.unlock_shared();
+
+  contended_counter_workload<sync_prim::basic_upgrade_mutex<sync_prim::bounded_readers<1>>>();
+  contended_counter_workload<sync_prim::basic_upgrade_mutex<sync_prim::bounded_readers<1>, sync_prim::futex_backend>>();
+}
+
 int main()
 {
   std::cout << "--- Running Core Logic Tests ---" << std::endl;
@@ -178,11 +1050,54 @@ int main()
   run_test(test_upgrade_lock, "Upgrade lock acquisition");
   run_test(test_exclusive_blocks_others, "Exclusive lock blocks others");
   run_test(test_upgrade_allows_readers, "Upgrade lock allows readers");
+  run_test(test_concurrent_readers, "Concurrent readers on the fast path");
+  run_test(test_last_reader_wakes_writer, "Last reader wakes a waiting writer");
+  run_test(test_unlock_wakes_parked_waiters, "Unlock wakes parked writer and upgrader");
+  run_test(test_wait_policies, "Contended workload under every wait policy");
+  run_test(test_futex_backend, "Futex backend parking and size");
+
+  std::cout << "\n--- Running Non-Blocking Tests ---" << std::endl;
+  run_test(test_try_lock, "try_lock / try_lock_shared / try_lock_upgrade");
+  run_test(test_guard_lock_tags, "try_to_lock / defer_lock / adopt_lock guards");
+  run_test(test_try_upgrade, "Non-blocking upgrade keeps upgrade lock on failure");
+  run_test(test_move_assign_releases_old_lock, "Move assignment releases the old lock");
+
+  std::cout << "\n--- Running Timed Tests ---" << std::endl;
+  run_test(test_timed_lock, "Timed acquisition in every mode");
+  run_test(test_shared_timed_mutex_interop, "std guards use the SharedTimedMutex interface");
+  run_test(test_timed_upgrade_releases_readers, "Timed-out upgrade releases blocked readers");
+
+  std::cout << "\n--- Running Fairness Tests ---" << std::endl;
+  run_test(test_writer_preference, "Waiting writer stops new readers");
+  run_test(test_phase_fair_alternates, "Phase-fair readers go before the next writer");
+  run_test(test_fairness_policies, "Contended workload under each fairness policy");
+
+  std::cout << "\n--- Running Handoff Tests ---" << std::endl;
+  run_test(test_unlock_hands_off_to_parked_writer, "unlock() hands the lock to a parked writer");
+  run_test(test_last_reader_hands_off_to_parked_writer, "Last reader hands the lock to a parked writer");
+  run_test(test_handoff_policies, "Contended workload with direct handoff");
+
+  std::cout << "\n--- Running Instrumentation Tests ---" << std::endl;
+  run_test(test_stats_counts_acquisitions, "stats() counts acquisitions, upgrades and readers");
+  run_test(test_stats_time_slow_paths, "stats() times parked waiters");
+
+  std::cout << "\n--- Running Optimistic Read Tests ---" << std::endl;
+  run_test(test_read_validate, "Exclusive exits invalidate optimistic readers");
+  run_test(test_read_begin_is_not_an_acquisition, "read_begin() waits for a writer without acquiring");
+  run_test(test_optimistic_reads_see_consistent_data, "Validated optimistic reads are consistent");
 
   std::cout << "\n--- Running Transition Tests ---" << std::endl;
   run_test(test_upgrade_downgrade_cycle, "Upgrade -> Unique -> Upgrade cycle");
   run_test(test_downgrade_to_shared, "Unique -> Shared downgrade");
   run_test(test_scoped_upgrade, "Scoped upgrade and automatic downgrade");
+  run_test(test_last_reader_wakes_upgrader, "Last reader wakes a pending upgrader");
+  run_test(test_shared_transitions, "Shared -> Upgrade and Shared -> Unique try transitions");
+  run_test(test_conditional_escalation_workload, "Readers escalate without releasing");
+
+  std::cout << "\n--- Running Feature Policy Tests ---" << std::endl;
+  run_test(test_no_upgrade, "no_upgrade reader-writer mutex");
+  run_test(test_wide_state, "Reader capacity and wide_state beyond 32 bits");
+  run_test(test_bounded_readers, "bounded_readers admits at most N readers");
 
   return 0;
 }
@@ -0,0 +1,89 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "sync_prim/upgrade_mutex.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// --- Test Runner Helper ---
+inline void run_test(void (*test_func)(), const std::string &test_name)
+{
+  try
+  {
+    test_func();
+    std::cout << "[PASS] " << test_name << std::endl;
+  }
+  catch (const std::exception &e)
+  {
+    std::cerr << "[FAIL] " << test_name << " - Exception: " << e.what() << std::endl;
+  }
+  catch (...)
+  {
+    std::cerr << "[FAIL] " << test_name << " - Unknown exception" << std::endl;
+  }
+}
+
+// --- Shared Workloads ---
+// Mixes writers, upgraders and readers on a single mutex; the plain counter
+// is only consistent if exclusive sections really are exclusive.
+template <typename Mutex>
+void contended_counter_workload(Mutex &mtx)
+{
+  long long counter = 0;
+  std::vector<std::thread> threads;
+
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([&, i]()
+                         {
+        for (int op = 0; op < 500; ++op) {
+            if (i % 2 == 0) {
+                sync_prim::unique_lock<Mutex> x_lock(mtx);
+                ++counter;
+            } else {
+                sync_prim::upgrade_lock<Mutex> u_lock(mtx);
+                sync_prim::scoped_upgrade<Mutex> s_upgrade(u_lock);
+                ++counter;
+            }
+            sync_prim::shared_lock<Mutex> s_lock(mtx);
+            volatile long long val = counter; (void)val;
+        } });
+  }
+  for (auto &t : threads)
+    t.join();
+
+  assert(counter == 4 * 500);
+}
+
+// Same workload on a default-constructed mutex.
+template <typename Mutex>
+void contended_counter_workload()
+{
+  Mutex mtx;
+  contended_counter_workload(mtx);
+}
@@ -0,0 +1,188 @@
+/*
+ * MIT License
+ * Copyright (c) 2024 Arihant Lunawat <arihantb2@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sync_prim/write_combiner.hpp"
+#include "sync_prim/distributed_upgrade_mutex.hpp"
+#include "sync_prim/queued_upgrade_mutex.hpp"
+#include "test_utils.hpp"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ===================================================================
+//                        CORE TESTS
+// ===================================================================
+
+void test_submit_write_returns_result()
+{
+  sync_prim::upgrade_mutex mtx;
+  sync_prim::write_combiner<> combiner(mtx);
+  int value = 1;
+
+  int doubled = combiner.submit_write([&]
+                                      { return value *= 2; });
+  assert(doubled == 2);
+  combiner.submit_write([&]
+                        { value += 1; });
+  assert(value == 3);
+
+  std::string moved = combiner.submit_write([]
+                                            { return std::string("result"); });
+  assert(moved == "result");
+
+  // Nothing stays locked
+  assert(mtx.try_lock());
+  mtx.unlock();
+}
+
+void test_exceptions_reach_the_submitter()
+{
+  sync_prim::upgrade_mutex mtx;
+  sync_prim::write_combiner<> combiner(mtx);
+  bool caught = false;
+  try
+  {
+    combiner.submit_write([]() -> int
+                          { throw std::runtime_error("write failed"); });
+  }
+  catch (const std::runtime_error &e)
+  {
+    caught = std::string(e.what()) == "write failed";
+  }
+  assert(caught);
+  assert(mtx.try_lock_upgrade());
+  mtx.unlock_upgrade();
+}
+
+void test_combine_without_pending_keeps_upgrade()
+{
+  sync_prim::upgrade_mutex mtx;
+  sync_prim::write_combiner<> combiner(mtx);
+  sync_prim::upgrade_lock<sync_prim::upgrade_mutex> u_lock(mtx);
+  assert(combiner.combine(u_lock) == 0);
+  assert(u_lock.owns_lock());
+  assert(mtx.try_lock_shared()); // Never converted
+  mtx.unlock_shared();
+}
+
+// ===================================================================
+//                        COMBINING TESTS
+// ===================================================================
+
+void test_one_exclusive_section_for_many_writes()
+{
+  using mutex_type = sync_prim::basic_upgrade_mutex<sync_prim::instrumented>;
+  mutex_type mtx;
+  sync_prim::write_combiner<mutex_type> combiner(mtx);
+  std::vector<int> order;
+  const int num_writers = 6;
+
+  // Writers queue behind the upgrade lock held here
+  sync_prim::upgrade_lock<mutex_type> u_lock(mtx);
+  std::vector<std::thread> writers;
+  std::vector<int> results(num_writers);
+  for (int i = 0; i < num_writers; ++i)
+  {
+    writers.emplace_back([&, i]()
+                         { results[i] = combiner.submit_write([&, i]
+                                                               { order.push_back(i); return i * 10; }); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  mtx.reset_stats();
+
+  assert(combiner.combine(u_lock) == static_cast<std::size_t>(num_writers));
+  assert(mtx.stats().exclusive_hold.holds == 1);
+  u_lock.unlock();
+  for (auto &t : writers)
+    t.join();
+
+  // In arrival order, each submitter getting its own result
+  for (int i = 0; i < num_writers; ++i)
+  {
+    assert(order[i] == i);
+    assert(results[i] == i * 10);
+  }
+  // The woken submitters found their writes done
+  assert(mtx.stats().exclusive_hold.holds == 1);
+}
+
+template <typename Mutex>
+void contended_submits()
+{
+  Mutex mtx;
+  sync_prim::write_combiner<Mutex> combiner(mtx);
+  long counter = 0;
+  std::atomic<long> sum_of_results{0};
+  const int num_threads = 4;
+  const int writes_per_thread = 2000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t)
+  {
+    threads.emplace_back([&]()
+                         {
+      for (int i = 0; i < writes_per_thread; ++i)
+      {
+        if (i % 2)
+        {
+          sync_prim::shared_lock<Mutex> s_lock(mtx);
+          (void)counter;
+        }
+        sum_of_results += combiner.submit_write([&]
+                                                { return ++counter; });
+      } });
+  }
+  for (auto &t : threads)
+    t.join();
+
+  const long n = num_threads * writes_per_thread;
+  assert(counter == n);
+  assert(sum_of_results == n * (n + 1) / 2); // Every value handed out once
+}
+
+void test_contended_submits()
+{
+  contended_submits<sync_prim::upgrade_mutex>();
+  contended_submits<sync_prim::distributed_upgrade_mutex<>>();
+  contended_submits<sync_prim::queued_upgrade_mutex<>>();
+}
+
+int main()
+{
+  std::cout << "--- Running Write Combiner Core Tests ---" << std::endl;
+  run_test(test_submit_write_returns_result, "submit_write returns the write's result");
+  run_test(test_exceptions_reach_the_submitter, "Exceptions are rethrown in the submitter");
+  run_test(test_combine_without_pending_keeps_upgrade, "combine() with nothing queued does not convert");
+
+  std::cout << "\n--- Running Combining Tests ---" << std::endl;
+  run_test(test_one_exclusive_section_for_many_writes, "Queued writes share one exclusive section");
+  run_test(test_contended_submits, "Contended submits on several variants");
+
+  return 0;
+}